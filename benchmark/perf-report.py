@@ -15,6 +15,9 @@ BENCH_PREFIX_TO_GROUP = {
     "error-bench": "error",
 }
 
+# `styio --time-report` writes JSONL records in the diagnostic envelope.
+TIME_REPORT_CATEGORY = "TimeReport"
+
 
 def parse_args() -> argparse.Namespace:
     parser = argparse.ArgumentParser(description="Summarize a Styio perf-route artifact directory.")
@@ -49,8 +52,30 @@ def coerce_value(raw: str) -> Any:
             return raw
 
 
+def parse_time_report_line(line: str) -> dict[str, Any] | None:
+    try:
+        payload = json.loads(line)
+    except json.JSONDecodeError:
+        return None
+    if not isinstance(payload, dict) or payload.get("category") != TIME_REPORT_CATEGORY:
+        return None
+
+    record: dict[str, Any] = {"group": "time_report"}
+    record.update(payload)
+    if record.get("kind") == "phase":
+        record["name"] = record.get("operation", "")
+    elif record.get("kind") in {"llvm_pass", "llvm_analysis"}:
+        record["name"] = record.get("pass", "")
+    else:
+        record["name"] = record.get("kind", "")
+    record["module"] = Path(str(record.get("file", ""))).name
+    return record
+
+
 def parse_bench_line(line: str) -> dict[str, Any] | None:
     line = line.strip()
+    if line.startswith("{"):
+        return parse_time_report_line(line)
     if not line.startswith("[") or "] " not in line:
         return None
 
@@ -74,6 +99,7 @@ def collect_benchmarks(run_dir: Path, sections: list[dict[str, str]]) -> dict[st
         "micro": [],
         "full_stack": [],
         "error": [],
+        "time_report": [],
     }
     for section in sections:
         log_path = section.get("log_path", "")
@@ -130,6 +156,13 @@ def iter_flat_metrics(grouped: dict[str, list[dict[str, Any]]]) -> list[dict[str
             "exit_code",
             "avg_diag_bytes",
         ],
+        "time_report": [
+            "wall_us",
+            "cpu_us",
+            "token_arena_bytes",
+            "ast_arena_bytes",
+            "runs",
+        ],
     }
 
     for group, records in grouped.items():
@@ -248,6 +281,46 @@ def write_summary_md(
             ]
         )
 
+    time_report_phase_rows = []
+    time_report_pass_rows = []
+    time_report_jit_rows = []
+    for record in grouped["time_report"]:
+        kind = record.get("kind", "")
+        if kind == "phase":
+            time_report_phase_rows.append(
+                [
+                    record.get("module", ""),
+                    record.get("operation", ""),
+                    record.get("to", ""),
+                    fmt_num(record.get("wall_us", 0)),
+                    fmt_num(record.get("cpu_us", 0)),
+                    fmt_num(record.get("token_arena_bytes", 0)),
+                    fmt_num(record.get("ast_arena_bytes", 0)),
+                ]
+            )
+        elif kind in {"llvm_pass", "llvm_analysis"}:
+            time_report_pass_rows.append(record)
+        elif kind == "jit_materialize":
+            time_report_jit_rows.append(
+                [
+                    record.get("module", ""),
+                    record.get("jit_mode", ""),
+                    record.get("jit_threads", ""),
+                    record.get("opt_level", ""),
+                    fmt_num(record.get("wall_us", 0)),
+                ]
+            )
+    time_report_pass_rows = [
+        [
+            record.get("module", ""),
+            record.get("pass", ""),
+            record.get("kind", ""),
+            record.get("runs", ""),
+            fmt_num(record.get("wall_us", 0)),
+        ]
+        for record in sorted(time_report_pass_rows, key=lambda item: float(item.get("wall_us", 0)), reverse=True)[:20]
+    ]
+
     lines: list[str] = []
     lines.append("# Styio Benchmark Summary")
     lines.append("")
@@ -307,6 +380,26 @@ def write_summary_md(
         lines.append("_No error-path benchmark records found._")
     lines.append("")
 
+    lines.append("## Compiler Time Report")
+    lines.append("")
+    if time_report_phase_rows:
+        lines.append(markdown_table(
+            ["Module", "Operation", "Phase", "Wall us", "CPU us", "Token Arena Bytes", "AST Arena Bytes"],
+            time_report_phase_rows,
+        ))
+        lines.append("")
+        if time_report_pass_rows:
+            lines.append(markdown_table(["Module", "Pass", "Kind", "Runs", "Wall us"], time_report_pass_rows))
+            lines.append("")
+        if time_report_jit_rows:
+            lines.append(markdown_table(
+                ["Module", "JIT Mode", "JIT Threads", "Opt Level", "Materialize us"],
+                time_report_jit_rows,
+            ))
+    else:
+        lines.append("_No --time-report records found._")
+    lines.append("")
+
     with path.open("w", encoding="utf-8") as handle:
         handle.write("\n".join(lines).rstrip() + "\n")
 
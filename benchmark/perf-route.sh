@@ -23,12 +23,13 @@ This script runs the current parser/compiler performance route:
   2. Compiler stage benchmark matrix
   3. Compiler micro benchmark matrix
   4. Full-stack workload matrix
-  5. Compiler error-path benchmark matrix
-  6. Parser engine regression suite
-  7. Pipeline guard rail
-  8. Parser/security guard rail
-  9. Parser shadow gates
-  10. Soak smoke, and optionally soak_deep
+  5. Compiler time report (styio --time-report, phase/LLVM pass/JIT records)
+  6. Compiler error-path benchmark matrix
+  7. Parser engine regression suite
+  8. Pipeline guard rail
+  9. Parser/security guard rail
+  10. Parser shadow gates
+  11. Soak smoke, and optionally soak_deep
 
 Artifacts:
   - metadata.tsv        Run metadata and environment snapshot
@@ -379,6 +380,12 @@ else
   record_skip_section "full_stack_workload_matrix" "full-stack workload matrix" "EXECUTE_ITERS=0"
 fi
 
+run_logged_section \
+  "compiler_time_report" \
+  "compiler time report" \
+  "${BUILD_DIR_ABS}/bin/styio" --time-report --opt-level=2 --no-jit-cache \
+    --file "${ROOT}/tests/pipeline_cases/p02_simple_func/input.styio"
+
 if [[ "$ERROR_ITERS" -gt 0 ]]; then
   run_logged_section \
     "compiler_error_path_benchmark" \
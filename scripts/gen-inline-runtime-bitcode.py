@@ -0,0 +1,43 @@
+#!/usr/bin/env python3
+
+import argparse
+import pathlib
+import sys
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--input", help="bitcode file to embed; omit to emit an empty blob")
+    parser.add_argument("--cpp-out", required=True)
+    args = parser.parse_args()
+
+    data = b""
+    if args.input:
+        data = pathlib.Path(args.input).read_bytes()
+
+    lines = [
+        "// Generated by scripts/gen-inline-runtime-bitcode.py. Do not edit.",
+        "#include \"StyioRuntime/InlineRuntimeBitcode.hpp\"",
+        "",
+        # One trailing byte keeps the array non-empty when no bitcode is available.
+        "alignas(4) const unsigned char styio_inline_runtime_bitcode[] = {",
+    ]
+    for offset in range(0, len(data), 16):
+        chunk = data[offset : offset + 16]
+        lines.append("  " + ", ".join(f"0x{b:02x}" for b in chunk) + ",")
+    lines.append("  0x00,")
+    lines.append("};")
+    lines.append(f"const size_t styio_inline_runtime_bitcode_size = {len(data)};")
+    lines.append("")
+
+    out = pathlib.Path(args.cpp_out)
+    out.parent.mkdir(parents=True, exist_ok=True)
+    text = "\n".join(lines)
+    if out.exists() and out.read_text(encoding="utf-8") == text:
+        return 0
+    out.write_text(text, encoding="utf-8")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
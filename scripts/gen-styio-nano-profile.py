@@ -6,7 +6,7 @@ import sys
 import tomllib
 
 
-ALLOWED_DICT_BACKENDS = ("ordered-hash", "linear")
+ALLOWED_DICT_BACKENDS = ("ordered-hash", "linear", "flat-hash")
 
 
 def read_bool(table, key, default):
@@ -84,6 +84,7 @@ def main():
         make_definition("STYIO_NANO_INCLUDE_PIPELINE_CHECK", read_bool(build, "include_pipeline_check", False)),
         make_definition("STYIO_NANO_ENABLE_DICT_BACKEND_ORDERED_HASH", "ordered-hash" in normalized_backends),
         make_definition("STYIO_NANO_ENABLE_DICT_BACKEND_LINEAR", "linear" in normalized_backends),
+        make_definition("STYIO_NANO_ENABLE_DICT_BACKEND_FLAT_HASH", "flat-hash" in normalized_backends),
     ]
 
     cmake_lines = [
@@ -20,6 +20,16 @@ LIST_SUFFIX_BLOCK_RE = re.compile(
     re.S,
 )
 LIST_SUFFIX_RE = re.compile(r'suffix\s*==\s*"([^"]+)"')
+# Dict helpers are named prefix + value suffix in CodeGenG.cpp (string- and i64-keyed alike).
+DICT_HELPER_PREFIXES = (
+    "styio_dict_new_",
+    "styio_dict_get_",
+    "styio_dict_set_",
+    "styio_idict_new_",
+    "styio_idict_get_",
+    "styio_idict_set_",
+)
+DICT_VALUE_SUFFIXES = ("bool", "i64", "f64", "cstr", "list", "dict")
 
 
 def read_text(path: Path) -> str:
@@ -61,6 +71,9 @@ def parse_codegen_required_helpers(exports: set[str]) -> set[str]:
         required.update(f"styio_list_push_{suffix}" for suffix in list_suffixes)
     if '"styio_list_insert_"' in codegen_g:
         required.update(f"styio_list_insert_{suffix}" for suffix in list_suffixes)
+    for prefix in DICT_HELPER_PREFIXES:
+        if f'"{prefix}"' in codegen_g:
+            required.update(f"{prefix}{suffix}" for suffix in DICT_VALUE_SUFFIXES)
 
     return required
 
@@ -2480,16 +2480,18 @@ class FileResourceAST : public StyioASTTraits<FileResourceAST>
   std::unique_ptr<StyioAST> path_owner_;
   StyioAST* path_expr_ = nullptr;
   bool auto_detect_ = false;
+  bool columnar_ = false;
 
-  FileResourceAST(StyioAST* path, bool auto_det) :
+  FileResourceAST(StyioAST* path, bool auto_det, bool columnar) :
       path_owner_(path),
       path_expr_(path_owner_.get()),
-      auto_detect_(auto_det) {
+      auto_detect_(auto_det),
+      columnar_(columnar) {
   }
 
 public:
-  static FileResourceAST* Create(StyioAST* path, bool auto_detect) {
-    return new FileResourceAST(path, auto_detect);
+  static FileResourceAST* Create(StyioAST* path, bool auto_detect, bool columnar = false) {
+    return new FileResourceAST(path, auto_detect, columnar);
   }
 
   StyioAST* getPath() {
@@ -2500,6 +2502,11 @@ public:
     return auto_detect_;
   }
 
+  /* `@col{...}`: a typed columnar file (StyioRuntime/ColumnarFile.hpp), not lines of text. */
+  bool isColumnar() const {
+    return columnar_;
+  }
+
   const StyioNodeType getNodeType() const {
     return StyioNodeType::FileResource;
   }
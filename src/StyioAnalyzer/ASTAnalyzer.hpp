@@ -8,6 +8,8 @@
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 using std::string;
 using std::unordered_map;
@@ -191,6 +193,37 @@ public:
     return snapshot_var_names_.find(s) != snapshot_var_names_.end();
   }
 
+  /* A column read by a `#(row: csv)` loop body, in first-use order. */
+  struct CsvColumnUse
+  {
+    std::string name;
+    /* How the runtime parses it: "str" until a numeric use, then "i64" or "f64". */
+    std::string type = "str";
+    /* Columns compared or added to this one: when one turns numeric, so do the others. */
+    std::vector<std::pair<IteratorAST*, std::string>> linked;
+
+    bool numeric() const {
+      return type != "str";
+    }
+  };
+
+  /*
+    For `row["name"]` on the row of an enclosing csv loop: the column, added to that
+    loop's projection on first use, and its index there (and the loop, if `loop` is set).
+    nullptr for anything else.
+  */
+  CsvColumnUse* find_csv_column(StyioAST* expr, int* index = nullptr, IteratorAST** loop = nullptr);
+
+  /* A column of an `@col{...}` loop (one per parameter) or of a row written to one. */
+  struct ColumnarColumn
+  {
+    std::string name;
+    /* "i64", "f64", "bool" or "str". */
+    std::string type;
+    /* The written value; null for loop parameters. */
+    StyioAST* value = nullptr;
+  };
+
   StyioAnalyzer() {}
 
   ~StyioAnalyzer() {}
@@ -403,6 +436,20 @@ private:
   std::unordered_set<HandleAcquireAST*> collect_bind_handle_acquires_;
   std::unordered_map<ResourceWriteAST*, StyioDataType> collect_bind_resource_write_types_;
   std::unordered_map<HandleAcquireAST*, StyioDataType> collect_bind_handle_acquire_types_;
+  /* Row name -> enclosing `#(row: csv)` loop, and each loop's projected columns. */
+  std::unordered_map<std::string, IteratorAST*> csv_rows_;
+  std::unordered_map<IteratorAST*, std::vector<CsvColumnUse>> csv_columns_;
+
+  static bool is_csv_iterator(IteratorAST* ast);
+  void note_csv_operand(StyioAST* operand, StyioAST* other, bool arithmetic);
+  void mark_csv_column(IteratorAST* loop, const std::string& name, const std::string& type);
+
+  /* Columns of each `@col{...}` loop and write, from parameter types / written values. */
+  std::unordered_map<IteratorAST*, std::vector<ColumnarColumn>> columnar_loops_;
+  std::unordered_map<ResourceWriteAST*, std::vector<ColumnarColumn>> columnar_writes_;
+
+  static bool is_columnar_resource(StyioAST* ast);
+  static void reject_columnar_resource(StyioAST* ast, const char* use);
 };
 
 #endif
@@ -147,6 +147,9 @@ expr_lowered_type(StyioAnalyzer* an, StyioAST* expr) {
   if (auto bound = bound_type_of(an, expr)) {
     return *bound;
   }
+  if (const auto* col = an->find_csv_column(expr)) {
+    return styio_data_type_from_name(col->numeric() ? col->type : "string");
+  }
   if (auto* attr = dynamic_cast<AttrAST*>(expr)) {
     auto* attr_name = dynamic_cast<NameAST*>(attr->attr);
     StyioDataType body_type = expr_lowered_type(an, attr->body);
@@ -1222,7 +1225,8 @@ StyioAnalyzer::toStyioIR(ParallelAssignAST* ast) {
         idx->getList()->toStyioIR(this),
         idx->getSlot1()->toStyioIR(this),
         rhs_val,
-        styio_dict_value_type_name(base_type)));
+        styio_dict_value_type_name(base_type),
+        styio_dict_has_i64_keys(base_type) ? "i64" : "string"));
     }
     else {
       stmts.push_back(SGListSet::Create(
@@ -1339,7 +1343,8 @@ StyioAnalyzer::toStyioIR(DictAST* ast) {
   StyioDataType dict_type = expr_lowered_type(this, ast);
   return SGDictLiteral::Create(
     std::move(entries),
-    styio_dict_value_type_name(dict_type));
+    styio_dict_value_type_name(dict_type),
+    styio_dict_has_i64_keys(dict_type) ? "i64" : "string");
 }
 
 StyioIR*
@@ -1349,6 +1354,13 @@ StyioAnalyzer::toStyioIR(SizeOfAST* ast) {
 
 StyioIR*
 StyioAnalyzer::toStyioIR(ListOpAST* ast) {
+  int csv_index = -1;
+  if (const auto* col = find_csv_column(ast, &csv_index)) {
+    return SGCsvField::Create(
+      static_cast<NameAST*>(ast->getList())->getAsStr(),
+      csv_index,
+      col->type);
+  }
   StyioDataType base_type = expr_lowered_type(this, ast->getList());
   if (styio_is_dict_type(base_type)
       && (ast->getOp() == StyioNodeType::Access_By_Index
@@ -1356,7 +1368,8 @@ StyioAnalyzer::toStyioIR(ListOpAST* ast) {
     return SGDictGet::Create(
       ast->getList()->toStyioIR(this),
       ast->getSlot1()->toStyioIR(this),
-      styio_dict_value_type_name(base_type));
+      styio_dict_value_type_name(base_type),
+      styio_dict_has_i64_keys(base_type) ? "i64" : "string");
   }
   if (ast->getOp() == StyioNodeType::Access_By_Index) {
     return SGListGet::Create(
@@ -1543,6 +1556,15 @@ StyioAnalyzer::toStyioIR(ResourceWriteAST* ast) {
       var,
       SGListReadStdin::Create(styio_type_item_type_name(collected_type)));
   }
+  if (auto it = columnar_writes_.find(ast); it != columnar_writes_.end()) {
+    /* typeInfer typed each column; a dict literal row is never built as a dict. */
+    std::vector<SGColumnarWrite::Column> columns;
+    for (const auto& col : it->second) {
+      columns.push_back(SGColumnarWrite::Column{col.name, col.type, col.value->toStyioIR(this)});
+    }
+    auto* fr = static_cast<FileResourceAST*>(ast->getResource());
+    return SGColumnarWrite::Create(fr->getPath()->toStyioIR(this), std::move(columns));
+  }
   StyioIR* data_ir = ast->getData()->toStyioIR(this);
   if (expr_is_list_like(this, ast->getData())) {
     data_ir = SGListToString::Create(data_ir);
@@ -1870,11 +1892,63 @@ StyioAnalyzer::toStyioIR(IteratorAST* ast) {
   if (!ast->params.empty()) {
     vname = ast->params[0]->getName();
   }
+  if (is_columnar_resource(ast->collection)) {
+    /* typeInfer bound each parameter to the type of the column it reads. */
+    auto* fr = static_cast<FileResourceAST*>(ast->collection);
+    auto saved_locals = local_binding_types;
+    auto saved_bind = binding_info_;
+    auto saved_csv_rows = csv_rows_;
+    std::vector<SGColumnarIter::Column> columns;
+    for (const auto& col : columnar_loops_[ast]) {
+      local_binding_types[col.name] = styio_data_type_from_name(col.type);
+      csv_rows_.erase(col.name);
+      columns.push_back(SGColumnarIter::Column{col.name, col.type});
+    }
+    SGBlock* body = SGBlock::Create({});
+    if (!ast->following.empty()) {
+      auto* abody = dynamic_cast<BlockAST*>(ast->following[0]);
+      if (abody && pulse_block_has_state(this, abody)) {
+        throw StyioTypeError("state declarations are not supported in @col{...} loops");
+      }
+      body = lower_func_body(this, ast->following[0]);
+    }
+    local_binding_types = std::move(saved_locals);
+    binding_info_ = std::move(saved_bind);
+    csv_rows_ = std::move(saved_csv_rows);
+    return SGColumnarIter::Create(fr->getPath()->toStyioIR(this), std::move(columns), body);
+  }
+  if (is_csv_iterator(ast)) {
+    /* typeInfer checked the collection and collected the projection. */
+    auto* fr = static_cast<FileResourceAST*>(ast->collection);
+    auto saved_locals = local_binding_types;
+    auto saved_bind = binding_info_;
+    auto saved_csv_rows = csv_rows_;
+    local_binding_types[vname] = styio_make_csv_row_type();
+    csv_rows_[vname] = ast;
+    SGBlock* body = SGBlock::Create({});
+    if (!ast->following.empty()) {
+      auto* abody = dynamic_cast<BlockAST*>(ast->following[0]);
+      if (abody && pulse_block_has_state(this, abody)) {
+        throw StyioTypeError("state declarations are not supported in #(row: csv) loops");
+      }
+      body = lower_func_body(this, ast->following[0]);
+    }
+    local_binding_types = std::move(saved_locals);
+    binding_info_ = std::move(saved_bind);
+    csv_rows_ = std::move(saved_csv_rows);
+    std::vector<SGCsvIter::Column> columns;
+    for (const auto& col : csv_columns_[ast]) {
+      columns.push_back(SGCsvIter::Column{col.name, col.type});
+    }
+    return SGCsvIter::Create(fr->getPath()->toStyioIR(this), std::move(vname), std::move(columns), body);
+  }
   auto bind_iter_param = [&](const std::string& name, const StyioDataType& type) {
     local_binding_types[name] = type;
   };
   auto saved_locals = local_binding_types;
   auto saved_bind = binding_info_;
+  auto saved_csv_rows = csv_rows_;
+  csv_rows_.erase(vname);
   if (!ast->params.empty()) {
     bind_iter_param(
       vname,
@@ -1897,6 +1971,7 @@ StyioAnalyzer::toStyioIR(IteratorAST* ast) {
   }
   local_binding_types = std::move(saved_locals);
   binding_info_ = std::move(saved_bind);
+  csv_rows_ = std::move(saved_csv_rows);
   if (ast->collection->getNodeType() == StyioNodeType::Range) {
     auto* rg = static_cast<RangeAST*>(ast->collection);
     return SGRangeFor::Create(
@@ -1932,7 +2007,8 @@ StyioAnalyzer::toStyioIR(IteratorAST* ast) {
     auto* fl = SGFileLineIter::CreateFromPath(
       fr->getPath()->toStyioIR(this),
       std::move(vname),
-      body);
+      body,
+      fr->isAutoDetect());
     if (pplan) {
       fl->set_pulse_plan(std::move(pplan));
       if (fl->pulse_plan && fl->pulse_plan->total_bytes > 0) {
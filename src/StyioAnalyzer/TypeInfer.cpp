@@ -6,6 +6,7 @@
 */
 
 // [C++ STL]
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <optional>
@@ -210,13 +211,22 @@ StyioDataType
 infer_dict_literal_type(StyioAnalyzer* an, DictAST* dict) {
   auto const& entries = dict->getEntries();
   if (entries.empty()) {
+    /* Empty literals carry no keys to look at: keep an annotated type (see adopt_declared_dict_type). */
+    if (styio_is_dict_type(dict->getDataType())) {
+      return dict->getDataType();
+    }
     return styio_make_dict_type("string", "i64");
   }
 
+  /* Integer keys select the i64-keyed storage; keys cannot mix the two. */
+  const bool int_keys = infer_expr_type(an, entries[0].key).option == StyioDataTypeOption::Integer;
+  const StyioDataTypeOption key_option = int_keys
+    ? StyioDataTypeOption::Integer
+    : StyioDataTypeOption::String;
   for (auto const& entry : entries) {
     StyioDataType key_type = infer_expr_type(an, entry.key);
-    if (key_type.option != StyioDataTypeOption::String) {
-      throw StyioTypeError("dict keys must have type string in this slice");
+    if (key_type.option != key_option) {
+      throw StyioTypeError("dict keys must be all string or all i64 in this slice");
     }
   }
 
@@ -240,8 +250,24 @@ infer_dict_literal_type(StyioAnalyzer* an, DictAST* dict) {
     }
     value_type = merge_dict_value_types(value_type, next_type);
   }
+  /* Float literals are typed `Float`; dict helpers are picked by the runtime name. */
+  if (styio_value_family_for_type(value_type) == StyioValueFamily::Float) {
+    value_type = kF64Type;
+  }
+
+  return styio_make_dict_type(int_keys ? "i64" : "string", value_type.name);
+}
 
-  return styio_make_dict_type("string", value_type.name);
+/* `d: dict[i64,f64] = {}` and `:=` alike: an empty dict literal takes the declared key/value types. */
+void
+adopt_declared_dict_type(StyioAST* value, const StyioDataType& declared) {
+  if (!styio_is_dict_type(declared) || value->getNodeType() != StyioNodeType::Dict) {
+    return;
+  }
+  auto* dict = static_cast<DictAST*>(value);
+  if (dict->getEntries().empty()) {
+    dict->setDataType(declared);
+  }
 }
 
 StyioDataType
@@ -289,6 +315,9 @@ infer_expr_type(StyioAnalyzer* an, StyioAST* expr) {
       return kI64Type;
     }
     case StyioNodeType::Access_By_Index: {
+      if (const auto* col = an->find_csv_column(expr)) {
+        return col->type == "i64" ? kI64Type : (col->type == "f64" ? kF64Type : kStringType);
+      }
       auto* access = static_cast<ListOpAST*>(expr);
       StyioDataType base_type = infer_expr_type(an, access->getList());
       if (!styio_type_is_indexable(base_type)) {
@@ -297,6 +326,9 @@ infer_expr_type(StyioAnalyzer* an, StyioAST* expr) {
       return styio_data_type_from_name(styio_type_item_type_name(base_type));
     }
     case StyioNodeType::Access_By_Name: {
+      if (const auto* col = an->find_csv_column(expr)) {
+        return col->type == "i64" ? kI64Type : (col->type == "f64" ? kF64Type : kStringType);
+      }
       auto* access = static_cast<ListOpAST*>(expr);
       StyioDataType base_type = infer_expr_type(an, access->getList());
       if (!styio_is_dict_type(base_type)) {
@@ -431,6 +463,28 @@ infer_numeric_string_coercion(StyioAnalyzer* an, BinOpAST* ast, StyioAST* lhs, S
   return true;
 }
 
+/* The text of a string literal; the lexer keeps the surrounding quotes in the value. */
+std::string
+string_literal_text(StringAST* lit) {
+  const std::string& raw = lit->getValue();
+  if (raw.size() >= 2 && raw.front() == '"' && raw.back() == '"') {
+    return raw.substr(1, raw.size() - 2);
+  }
+  return raw;
+}
+
+/* Column type `@col{...}` stores a value of type `t` as, or "" when it cannot hold it. */
+std::string
+columnar_type_of(const StyioDataType& t) {
+  switch (t.option) {
+    case StyioDataTypeOption::Integer: return "i64";
+    case StyioDataTypeOption::Float:   return "f64";
+    case StyioDataTypeOption::Bool:    return "bool";
+    case StyioDataTypeOption::String:  return "str";
+    default:                           return "";
+  }
+}
+
 }  // namespace
 
 void
@@ -566,6 +620,7 @@ StyioAnalyzer::typeInfer(FlexBindAST* ast) {
   }
 
   ast->getValue()->typeInfer(this);
+  adopt_declared_dict_type(ast->getValue(), var_type);
 
   if (var_type.option == StyioDataTypeOption::Undefined) {
     switch (ast->getValue()->getNodeType()) {
@@ -644,6 +699,7 @@ StyioAnalyzer::typeInfer(FinalBindAST* ast) {
   }
   ast->getValue()->typeInfer(this);
   auto vt = ast->getVar()->getDType()->type;
+  adopt_declared_dict_type(ast->getValue(), vt);
   if (ast->getValue()->getNodeType() == StyioNodeType::BinOp) {
     static_cast<BinOpAST*>(ast->getValue())->setDType(vt);
     ast->getValue()->typeInfer(this);
@@ -754,7 +810,7 @@ StyioAnalyzer::typeInfer(ParallelAssignAST* ast) {
     }
     if (!styio_is_list_type(base_type)) {
       throw StyioTypeError(
-        "indexed assignment in this slice supports dict[string,T] or list[T] targets only");
+        "indexed assignment in this slice supports dict[string,T], dict[i64,T] or list[T] targets only");
     }
     StyioDataType elem_type = styio_data_type_from_name(styio_type_item_type_name(base_type));
     if (!styio_type_supports_runtime_list_elem(elem_type)) {
@@ -849,11 +905,18 @@ StyioAnalyzer::typeInfer(ListOpAST* ast) {
     ast->getSlot2()->typeInfer(this);
   }
 
+  if (find_csv_column(ast) != nullptr) {
+    return;
+  }
+
   StyioDataType list_type = infer_expr_type(this, ast->getList());
   if (ast->getOp() == StyioNodeType::Access_By_Name) {
     if (!styio_is_dict_type(list_type)) {
       throw StyioTypeError("name-based access requires a dict value");
     }
+    if (styio_dict_has_i64_keys(list_type)) {
+      throw StyioTypeError("name-based access requires a string-keyed dict; index dict[i64,T] with [key]");
+    }
     return;
   }
   if (ast->getOp() != StyioNodeType::Access_By_Index) {
@@ -866,7 +929,12 @@ StyioAnalyzer::typeInfer(ListOpAST* ast) {
 
   StyioDataType slot_type = infer_expr_type(this, ast->getSlot1());
   if (styio_is_dict_type(list_type)) {
-    if (slot_type.option != StyioDataTypeOption::String) {
+    if (styio_dict_has_i64_keys(list_type)) {
+      if (slot_type.option != StyioDataTypeOption::Integer) {
+        throw StyioTypeError("dict[i64,T] index must have integer type");
+      }
+    }
+    else if (slot_type.option != StyioDataTypeOption::String) {
       throw StyioTypeError("dict index must have type string");
     }
     return;
@@ -879,6 +947,8 @@ StyioAnalyzer::typeInfer(ListOpAST* ast) {
 
 void
 StyioAnalyzer::typeInfer(BinCompAST* ast) {
+  note_csv_operand(ast->getLHS(), ast->getRHS(), false);
+  note_csv_operand(ast->getRHS(), ast->getLHS(), false);
   ast->getLHS()->typeInfer(this);
   ast->getRHS()->typeInfer(this);
 }
@@ -953,6 +1023,7 @@ StyioAnalyzer::typeInfer(HandleAcquireAST* ast) {
     throw StyioTypeError("resource clone cannot rebind final slot `" + name + "`");
   }
 
+  reject_columnar_resource(ast->getResource(), "a handle");
   ast->getResource()->typeInfer(this);
 
   BindingInfo info;
@@ -1055,6 +1126,42 @@ StyioAnalyzer::typeInfer(ResourceWriteAST* ast) {
     collect_bind_resource_write_types_[ast] = collected_type;
     return;
   }
+  if (is_columnar_resource(ast->getResource())) {
+    /* One column per key of a dict literal, each typed on its own (no dict is built). */
+    std::vector<ColumnarColumn> columns;
+    auto add_column = [&](const std::string& name, StyioAST* value) {
+      value->typeInfer(this);
+      const StyioDataType t = infer_expr_type(this, value);
+      const std::string type = columnar_type_of(t);
+      if (type.empty()) {
+        throw StyioTypeError(
+          "cannot write " + t.name + " to @col{...}: columns hold i64, f64, bool or str");
+      }
+      for (const auto& col : columns) {
+        if (col.name == name) {
+          throw StyioTypeError("@col{...} row names column `" + name + "` twice");
+        }
+      }
+      columns.push_back(ColumnarColumn{name, type, value});
+    };
+    if (auto* row = dynamic_cast<DictAST*>(ast->getData())) {
+      if (row->getEntries().empty()) {
+        throw StyioTypeError("@col{...} row needs at least one column");
+      }
+      for (const auto& entry : row->getEntries()) {
+        auto* key = dynamic_cast<StringAST*>(entry.key);
+        if (key == nullptr) {
+          throw StyioTypeError("@col{...} column names are string literals, e.g. dict{\"price\": p}");
+        }
+        add_column(string_literal_text(key), entry.value);
+      }
+    }
+    else {
+      add_column("value", ast->getData());
+    }
+    columnar_writes_[ast] = std::move(columns);
+    return;
+  }
   ast->getData()->typeInfer(this);
   if (!styio_type_is_writable(resource_type)) {
     throw StyioTypeError("write target must be a writable resource");
@@ -1063,6 +1170,7 @@ StyioAnalyzer::typeInfer(ResourceWriteAST* ast) {
 
 void
 StyioAnalyzer::typeInfer(ResourceRedirectAST* ast) {
+  reject_columnar_resource(ast->getResource(), "a -> redirect");
   ast->getData()->typeInfer(this);
   ast->getResource()->typeInfer(this);
   StyioDataType resource_type = infer_expr_type(this, ast->getResource());
@@ -1092,6 +1200,13 @@ StyioAnalyzer::typeInfer(BinOpAST* ast) {
     return;
   }
 
+  /* `+` may concatenate; every other arithmetic operator needs numbers. */
+  const bool arithmetic = op == StyioOpType::Binary_Sub || op == StyioOpType::Binary_Mul
+                          || op == StyioOpType::Binary_Div || op == StyioOpType::Binary_Pow
+                          || op == StyioOpType::Binary_Mod;
+  note_csv_operand(lhs, rhs, arithmetic);
+  note_csv_operand(rhs, lhs, arithmetic);
+
   if (op == StyioOpType::Self_Add_Assign || op == StyioOpType::Self_Sub_Assign
       || op == StyioOpType::Self_Mul_Assign || op == StyioOpType::Self_Div_Assign
       || op == StyioOpType::Self_Mod_Assign) {
@@ -1581,9 +1696,55 @@ StyioAnalyzer::typeInfer(IteratorAST* ast) {
   if (!styio_type_is_iterable(collection_type)) {
     throw StyioTypeError("iteration requires an iterable value");
   }
+  if (is_columnar_resource(ast->collection)) {
+    if (ast->params.empty()) {
+      throw StyioTypeError("@col{...} loops name the columns they read, e.g. #(price: f64) => {...}");
+    }
+    std::vector<ColumnarColumn> columns;
+    auto saved_csv_rows = csv_rows_;
+    for (auto* param : ast->params) {
+      const std::string name = param->getNameAsStr();
+      if (param->var_type == nullptr) {
+        throw StyioTypeError("@col{...} loop parameter `" + name + "` needs a type: i64, f64, bool or str");
+      }
+      const StyioDataType declared = param->var_type->getDataType();
+      const std::string type = columnar_type_of(declared);
+      if (type.empty()) {
+        throw StyioTypeError("@col{...} columns hold i64, f64, bool or str, not " + declared.name);
+      }
+      columns.push_back(ColumnarColumn{name, type, nullptr});
+      local_binding_types[name] = styio_data_type_from_name(type);
+      csv_rows_.erase(name);
+    }
+    columnar_loops_[ast] = std::move(columns);
+    for (auto* f : ast->following) {
+      f->typeInfer(this);
+    }
+    local_binding_types = std::move(saved);
+    fixed_assignment_names_ = std::move(saved_fixed);
+    binding_info_ = std::move(saved_bind);
+    csv_rows_ = std::move(saved_csv_rows);
+    return;
+  }
   StyioDataType et = infer_collection_elem_type(this, ast->collection);
+  const bool csv = is_csv_iterator(ast);
+  if (csv) {
+    if (ast->collection->getNodeType() != StyioNodeType::FileResource) {
+      throw StyioTypeError("#(row: csv) reads from a file path: @file{...} or @(...)");
+    }
+    et = styio_make_csv_row_type();
+    csv_columns_[ast];
+  }
+  auto saved_csv_rows = csv_rows_;
   if (!ast->params.empty()) {
-    local_binding_types[ast->params[0]->getNameAsStr()] = et;
+    const std::string name = ast->params[0]->getNameAsStr();
+    local_binding_types[name] = et;
+    if (csv) {
+      csv_rows_[name] = ast;
+    }
+    else {
+      csv_rows_.erase(name);
+    }
   }
   for (auto* f : ast->following) {
     f->typeInfer(this);
@@ -1591,6 +1752,130 @@ StyioAnalyzer::typeInfer(IteratorAST* ast) {
   local_binding_types = std::move(saved);
   fixed_assignment_names_ = std::move(saved_fixed);
   binding_info_ = std::move(saved_bind);
+  csv_rows_ = std::move(saved_csv_rows);
+}
+
+bool
+StyioAnalyzer::is_columnar_resource(StyioAST* ast) {
+  auto* fr = dynamic_cast<FileResourceAST*>(ast);
+  return fr != nullptr && fr->isColumnar();
+}
+
+/* `@col{...}` holds typed columns, not text: it is only read by typed loops and written with `<<`. */
+void
+StyioAnalyzer::reject_columnar_resource(StyioAST* ast, const char* use) {
+  if (is_columnar_resource(ast)) {
+    throw StyioTypeError(
+      std::string("@col{...} cannot be used for ") + use
+      + "; read it with @col{...} >> #(x: T) => {...} and write it with <<");
+  }
+}
+
+bool
+StyioAnalyzer::is_csv_iterator(IteratorAST* ast) {
+  return ast->params.size() == 1 && ast->params[0]->var_type != nullptr
+         && ast->params[0]->var_type->getDataType().name == "csv";
+}
+
+StyioAnalyzer::CsvColumnUse*
+StyioAnalyzer::find_csv_column(StyioAST* expr, int* index, IteratorAST** loop) {
+  if (expr == nullptr
+      || (expr->getNodeType() != StyioNodeType::Access_By_Name
+          && expr->getNodeType() != StyioNodeType::Access_By_Index)) {
+    return nullptr;
+  }
+  auto* access = static_cast<ListOpAST*>(expr);
+  auto* base = dynamic_cast<NameAST*>(access->getList());
+  if (base == nullptr) {
+    return nullptr;
+  }
+  auto row = csv_rows_.find(base->getAsStr());
+  if (row == csv_rows_.end()) {
+    return nullptr;
+  }
+  auto* key = dynamic_cast<StringAST*>(access->getSlot1());
+  if (key == nullptr) {
+    throw StyioTypeError(
+      "csv columns are selected by name, e.g. " + base->getAsStr() + "[\"price\"]");
+  }
+  const std::string name = string_literal_text(key);
+  auto& columns = csv_columns_[row->second];
+  size_t i = 0;
+  while (i < columns.size() && columns[i].name != name) {
+    i += 1;
+  }
+  if (i == columns.size()) {
+    columns.push_back(CsvColumnUse{name});
+  }
+  if (index != nullptr) {
+    *index = static_cast<int>(i);
+  }
+  if (loop != nullptr) {
+    *loop = row->second;
+  }
+  return &columns[i];
+}
+
+/* Widen a column's parse type (str < i64 < f64); a column that turns numeric pulls its links along as f64. */
+void
+StyioAnalyzer::mark_csv_column(IteratorAST* loop, const std::string& name, const std::string& type) {
+  auto& columns = csv_columns_[loop];
+  auto it = std::find_if(columns.begin(), columns.end(), [&](const CsvColumnUse& c) { return c.name == name; });
+  if (it == columns.end() || it->type == type || it->type == "f64") {
+    return;
+  }
+  const bool was_text = !it->numeric();
+  it->type = type;
+  if (was_text) {
+    const auto linked = it->linked;
+    for (const auto& [other_loop, other_name] : linked) {
+      mark_csv_column(other_loop, other_name, "f64");
+    }
+  }
+}
+
+/*
+  A csv column is text unless a use needs a number: an arithmetic operator other than
+  `+`, or an operand (of `+` or a comparison) whose type is numeric. An integer operand
+  makes it i64, anything else f64. Two columns compared or added to each other stay text
+  together until one of them turns numeric elsewhere.
+*/
+void
+StyioAnalyzer::note_csv_operand(StyioAST* operand, StyioAST* other, bool arithmetic) {
+  IteratorAST* loop = nullptr;
+  CsvColumnUse* col = find_csv_column(operand, nullptr, &loop);
+  if (col == nullptr) {
+    return;
+  }
+  const std::string name = col->name;
+  IteratorAST* other_loop = nullptr;
+  if (CsvColumnUse* other_col = find_csv_column(other, nullptr, &other_loop)) {
+    if (arithmetic) {
+      mark_csv_column(loop, name, "f64");
+      return;
+    }
+    const std::string other_name = other_col->name;
+    const bool other_numeric = other_col->numeric();
+    /* find_csv_column may have grown the projection: look the column up again. */
+    col = find_csv_column(operand);
+    const std::pair<IteratorAST*, std::string> link{other_loop, other_name};
+    if (std::find(col->linked.begin(), col->linked.end(), link) == col->linked.end()) {
+      col->linked.push_back(link);
+    }
+    if (other_numeric) {
+      mark_csv_column(loop, name, "f64");
+    }
+    return;
+  }
+  const StyioDataType other_type = other != nullptr
+    ? infer_expr_type(this, other)
+    : StyioDataType{StyioDataTypeOption::Undefined, "undefined", 0};
+  if (other_type.option == StyioDataTypeOption::Integer) {
+    mark_csv_column(loop, name, "i64");
+  }
+  else if (other_type.option == StyioDataTypeOption::Float || arithmetic) {
+    mark_csv_column(loop, name, "f64");
+  }
 }
 
 void
@@ -1598,6 +1883,8 @@ StyioAnalyzer::typeInfer(StreamZipAST* ast) {
   auto saved = local_binding_types;
   auto saved_fixed = fixed_assignment_names_;
   auto saved_bind = binding_info_;
+  reject_columnar_resource(ast->getCollectionA(), "zip");
+  reject_columnar_resource(ast->getCollectionB(), "zip");
   ast->getCollectionA()->typeInfer(this);
   ast->getCollectionB()->typeInfer(this);
   StyioDataType ta = infer_expr_type(this, ast->getCollectionA());
@@ -1623,6 +1910,7 @@ StyioAnalyzer::typeInfer(StreamZipAST* ast) {
 
 void
 StyioAnalyzer::typeInfer(SnapshotDeclAST* ast) {
+  reject_columnar_resource(ast->getResource(), "a snapshot");
   snapshot_var_names_.insert(ast->getVar()->getAsStr());
   local_binding_types[ast->getVar()->getAsStr()] =
     StyioDataType{StyioDataTypeOption::Integer, "i64", 64};
@@ -1631,6 +1919,7 @@ StyioAnalyzer::typeInfer(SnapshotDeclAST* ast) {
 
 void
 StyioAnalyzer::typeInfer(InstantPullAST* ast) {
+  reject_columnar_resource(ast->getResource(), "an instant pull");
   ast->getResource()->typeInfer(this);
 }
 
@@ -1,12 +1,22 @@
 // [C++ STL]
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <string>
 
 // [Styio]
 #include "CodeGenVisitor.hpp"
+#include "StyioRuntime/InlineRuntimeBitcode.hpp"
 #include "StyioUtil/Util.hpp"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/Linker/Linker.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Passes/OptimizationLevel.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 
 void
 StyioToLLVM::print_llvm_ir() {
@@ -23,25 +33,312 @@ StyioToLLVM::print_llvm_ir() {
   llvm::outs().flush();
 }
 
+size_t
+StyioToLLVM::link_inline_runtime() {
+  if (styio_inline_runtime_bitcode_size == 0) {
+    return 0;
+  }
+
+  llvm::MemoryBufferRef buffer(
+    llvm::StringRef(
+      reinterpret_cast<const char*>(styio_inline_runtime_bitcode),
+      styio_inline_runtime_bitcode_size),
+    "styio-inline-runtime");
+  auto parsed = llvm::parseBitcodeFile(buffer, *theContext);
+  if (!parsed) {
+    /* Bitcode from an incompatible clang only costs the inlining opportunity. */
+    llvm::consumeError(parsed.takeError());
+    return 0;
+  }
+  std::unique_ptr<llvm::Module> helpers = std::move(*parsed);
+
+  /* Only take bodies for helpers this module already calls. */
+  std::vector<std::string> linked;
+  for (llvm::Function& fn : *helpers) {
+    if (fn.isDeclaration()) {
+      continue;
+    }
+    llvm::Function* used = theModule->getFunction(fn.getName());
+    if (used != nullptr && used->isDeclaration()) {
+      linked.push_back(fn.getName().str());
+    }
+    /* The module's own target decides codegen; don't let clang's defaults block inlining. */
+    fn.removeFnAttr("target-cpu");
+    fn.removeFnAttr("target-features");
+    fn.removeFnAttr("tune-cpu");
+  }
+  if (linked.empty()) {
+    return 0;
+  }
+
+  if (llvm::NamedMDNode* flags = helpers->getModuleFlagsMetadata()) {
+    helpers->eraseNamedMetadata(flags);
+  }
+  helpers->setTargetTriple(theModule->getTargetTriple());
+  helpers->setDataLayout(theModule->getDataLayout());
+
+  if (llvm::Linker::linkModules(*theModule, std::move(helpers), llvm::Linker::Flags::LinkOnlyNeeded)) {
+    return 0;
+  }
+
+  /* The definitions stay owned by ExternLib: calls the inliner leaves behind keep resolving
+     to the registered runtime symbols, and the bodies are dropped before codegen. */
+  for (const std::string& name : linked) {
+    if (llvm::Function* fn = theModule->getFunction(name); fn != nullptr && !fn->isDeclaration()) {
+      fn->setLinkage(llvm::GlobalValue::AvailableExternallyLinkage);
+    }
+  }
+  return linked.size();
+}
+
 void
-StyioToLLVM::execute() {
-  if (llvm::verifyModule(*theModule, &llvm::errs())) {
-    std::cerr << "styio: LLVM module verification failed\n";
+StyioToLLVM::optimize_module(unsigned opt_level) {
+  if (opt_level == 0) {
     return;
   }
-  auto RT = theORCJIT->getMainJITDylib().createResourceTracker();
-  auto TSM = llvm::orc::ThreadSafeModule(std::move(theModule), std::move(theContext));
-  llvm::ExitOnError exit_on_error;
-  exit_on_error(theORCJIT->addModule(std::move(TSM), RT));
+  /* Leave broken modules untouched: execute() reports the verifier failure. */
+  if (llvm::verifyModule(*theModule, nullptr)) {
+    return;
+  }
+
+  link_inline_runtime();
+
+  llvm::OptimizationLevel level = llvm::OptimizationLevel::O2;
+  switch (opt_level) {
+    case 1:
+      level = llvm::OptimizationLevel::O1;
+      break;
+    case 2:
+      level = llvm::OptimizationLevel::O2;
+      break;
+    default:
+      level = llvm::OptimizationLevel::O3;
+      break;
+  }
+
+  llvm::ModulePassManager mpm = thePB.buildPerModuleDefaultPipeline(level);
+  mpm.run(*theModule, *theMAM);
+
+  /* Cached analyses refer to IR the pipeline just rewrote. */
+  theMAM->clear();
+  theCGAM->clear();
+  theFAM->clear();
+  theLAM->clear();
+}
+
+void
+StyioToLLVM::begin_pass_timing(llvm::StringRef name, bool analysis) {
+  const std::string key = (analysis ? "analysis:" : "pass:") + name.str();
+  auto [it, inserted] = pass_timing_slots_.try_emplace(key, pass_timings_.size());
+  if (inserted) {
+    StyioPassTiming timing;
+    timing.name = name.str();
+    timing.analysis = analysis;
+    pass_timings_.push_back(std::move(timing));
+  }
+  PassTimingFrame frame;
+  frame.slot = it->second;
+  frame.started = std::chrono::steady_clock::now();
+  pass_timing_stack_.push_back(frame);
+}
+
+void
+StyioToLLVM::end_pass_timing() {
+  if (pass_timing_stack_.empty()) {
+    return;
+  }
+  const PassTimingFrame frame = pass_timing_stack_.back();
+  pass_timing_stack_.pop_back();
+  const std::uint64_t elapsed_us = static_cast<std::uint64_t>(
+    std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - frame.started).count());
+  /* Like TimePassesHandler, a pass is charged only for the time its nested passes did not take. */
+  StyioPassTiming& timing = pass_timings_[frame.slot];
+  timing.runs += 1;
+  timing.wall_us += elapsed_us > frame.nested_us ? elapsed_us - frame.nested_us : 0;
+  if (!pass_timing_stack_.empty()) {
+    pass_timing_stack_.back().nested_us += elapsed_us;
+  }
+}
+
+void
+StyioToLLVM::enable_pass_timing() {
+  /* Pass managers and adaptors only wrap other passes; timing them would double count. */
+  static const std::vector<llvm::StringRef> wrappers = {"PassManager", "PassAdaptor"};
+  thePIC->registerBeforeNonSkippedPassCallback([this](llvm::StringRef pass, llvm::Any) {
+    if (!llvm::isSpecialPass(pass, wrappers)) {
+      begin_pass_timing(pass, false);
+    }
+  });
+  thePIC->registerAfterPassCallback([this](llvm::StringRef pass, llvm::Any, const llvm::PreservedAnalyses&) {
+    if (!llvm::isSpecialPass(pass, wrappers)) {
+      end_pass_timing();
+    }
+  });
+  thePIC->registerAfterPassInvalidatedCallback([this](llvm::StringRef pass, const llvm::PreservedAnalyses&) {
+    if (!llvm::isSpecialPass(pass, wrappers)) {
+      end_pass_timing();
+    }
+  });
+  thePIC->registerBeforeAnalysisCallback([this](llvm::StringRef analysis, llvm::Any) {
+    begin_pass_timing(analysis, true);
+  });
+  thePIC->registerAfterAnalysisCallback([this](llvm::StringRef, llvm::Any) {
+    end_pass_timing();
+  });
+}
+
+/*
+  Split the program into `parts` modules and give each its own LLVMContext: a
+  ThreadSafeContext serializes every compile that shares it, so parts have to be moved
+  out through bitcode before the JIT can codegen them concurrently. Non-empty parts are
+  named styio.part0, styio.part1, ... without gaps; the object cache stores them under
+  those names and the warm-start path loads them back in the same order.
+*/
+static llvm::Error
+add_split_module(
+  StyioJIT_ORC& jit,
+  llvm::Module& module,
+  unsigned parts,
+  const llvm::orc::ResourceTrackerSP& rt
+) {
+  std::vector<std::pair<std::string, llvm::SmallVector<char, 0>>> encoded;
+  llvm::SplitModule(
+    module,
+    parts,
+    [&](std::unique_ptr<llvm::Module> part) {
+      /* Small programs leave some partitions empty; those would never be materialized. */
+      const bool has_definitions =
+        std::any_of(part->begin(), part->end(), [](const llvm::Function& fn) { return !fn.isDeclaration(); })
+        || std::any_of(part->global_begin(), part->global_end(), [](const llvm::GlobalVariable& gv) { return !gv.isDeclaration(); });
+      if (!has_definitions) {
+        return;
+      }
+      llvm::SmallVector<char, 0> buffer;
+      llvm::raw_svector_ostream os(buffer);
+      llvm::WriteBitcodeToFile(*part, os);
+      encoded.emplace_back("styio.part" + std::to_string(encoded.size()), std::move(buffer));
+    });
+
+  for (auto& [name, buffer] : encoded) {
+    auto context = std::make_unique<llvm::LLVMContext>();
+    /* The buffer identifier becomes the parsed module's identifier. */
+    auto part = llvm::parseBitcodeFile(
+      llvm::MemoryBufferRef(llvm::StringRef(buffer.data(), buffer.size()), name),
+      *context);
+    if (!part) {
+      return part.takeError();
+    }
+    if (llvm::Error err = jit.addModule(llvm::orc::ThreadSafeModule(std::move(*part), std::move(context)), rt)) {
+      return err;
+    }
+  }
+  return llvm::Error::success();
+}
+
+llvm::Expected<StyioJITProgram>
+StyioToLLVM::load_program() {
+  if (llvm::verifyModule(*theModule, &llvm::errs())) {
+    return llvm::createStringError(llvm::inconvertibleErrorCode(), "LLVM module verification failed");
+  }
+  const auto materialize_started = std::chrono::steady_clock::now();
+  StyioJITProgram program;
+  program.tracker = theORCJIT->getMainJITDylib().createResourceTracker();
+  const unsigned parts = theORCJIT->isLazy() ? 1 : theORCJIT->getCompileThreads();
+  if (parts > 1) {
+    std::vector<std::string> defined;
+    for (const llvm::Function& fn : *theModule) {
+      if (!fn.isDeclaration() && !fn.hasLocalLinkage()) {
+        defined.push_back(fn.getName().str());
+      }
+    }
+    if (llvm::Error err = add_split_module(*theORCJIT, *theModule, parts, program.tracker)) {
+      return std::move(err);
+    }
+    theModule.reset();
+    /* One lookup for everything queues every part at once instead of discovering them link by link. */
+    if (llvm::Error err = theORCJIT->materialize(defined)) {
+      return std::move(err);
+    }
+  }
+  else {
+    auto TSM = llvm::orc::ThreadSafeModule(std::move(theModule), std::move(theContext));
+    if (llvm::Error err = theORCJIT->addModule(std::move(TSM), program.tracker)) {
+      return std::move(err);
+    }
+  }
+
+  auto entry_symbol = theORCJIT->lookup("main");
+  if (!entry_symbol) {
+    llvm::consumeError(entry_symbol.takeError());
+    return llvm::createStringError(llvm::inconvertibleErrorCode(), "main not found");
+  }
+  program.entry = entry_symbol->getAddress().toPtr<int (*)()>();
+  /* Eager mode compiles everything by the time `main` resolves; lazy mode only its stubs. */
+  jit_materialize_us_ = static_cast<std::uint64_t>(
+    std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - materialize_started)
+      .count());
+  return program;
+}
 
-  auto ExprSymbol = theORCJIT->lookup("main");
-  if (!ExprSymbol) {
-    std::cerr << "styio: main not found" << std::endl;
+void
+StyioToLLVM::execute() {
+  auto program = load_program();
+  if (!program) {
+    std::cerr << "styio: " << llvm::toString(program.takeError()) << std::endl;
     return;
   }
+  program->entry();
+}
+
+std::unique_ptr<StyioJIT_ORC>
+StyioToLLVM::release_jit() {
+  return std::move(theORCJIT);
+}
+
+bool
+StyioToLLVM::emit_object_file(const std::string& path, std::string& error_message) {
+  if (llvm::verifyModule(*theModule, &llvm::errs())) {
+    error_message = "LLVM module verification failed";
+    return false;
+  }
 
-  int (*FP)() = ExprSymbol->getAddress().toPtr<int (*)()>();
-  FP();
+  /* Same CPU/features as the JIT, but position independent so the object links into PIE executables. */
+  llvm::orc::JITTargetMachineBuilder jtmb = theORCJIT->getTargetMachineBuilder();
+  jtmb.setRelocationModel(llvm::Reloc::PIC_);
+  auto tm = jtmb.createTargetMachine();
+  if (!tm) {
+    error_message = llvm::toString(tm.takeError());
+    return false;
+  }
+
+  if (llvm::Function* program_main = theModule->getFunction("main")) {
+    program_main->setName("styio_program_main");
+    program_main->setLinkage(llvm::GlobalValue::InternalLinkage);
+
+    llvm::FunctionType* entry_type = llvm::FunctionType::get(theBuilder->getInt32Ty(), false);
+    llvm::Function* entry =
+      llvm::Function::Create(entry_type, llvm::GlobalValue::ExternalLinkage, "main", *theModule);
+    llvm::IRBuilder<> entry_builder(llvm::BasicBlock::Create(*theContext, "entry", entry));
+    entry_builder.CreateCall(program_main);
+    llvm::FunctionCallee report_exit = theModule->getOrInsertFunction("styio_runtime_report_exit", entry_type);
+    entry_builder.CreateRet(entry_builder.CreateCall(report_exit));
+  }
+
+  std::error_code ec;
+  llvm::raw_fd_ostream out(path, ec, llvm::sys::fs::OF_None);
+  if (ec) {
+    error_message = "cannot open object output " + path + ": " + ec.message();
+    return false;
+  }
+
+  llvm::legacy::PassManager emit_pm;
+  if ((*tm)->addPassesToEmitFile(emit_pm, out, nullptr, llvm::CodeGenFileType::ObjectFile)) {
+    error_message = "target cannot emit object files";
+    return false;
+  }
+  emit_pm.run(*theModule);
+  out.flush();
+  return true;
 }
 
 std::string
@@ -38,6 +38,7 @@
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/MDBuilder.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/PassManager.h"
 #include "llvm/IR/Type.h"
@@ -46,6 +47,7 @@
 #include "llvm/LinkAllIR.h"
 #include "llvm/Passes/PassBuilder.h"
 #include "llvm/Passes/StandardInstrumentations.h"
+#include "llvm/Support/ModRef.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Transforms/InstCombine/InstCombine.h"
@@ -1200,6 +1202,118 @@ StyioToLLVM::default_runtime_return_value(llvm::Type* ret_ty) {
   return llvm::Constant::getNullValue(ret_ty);
 }
 
+llvm::Value*
+StyioToLLVM::call_in_entry_block(llvm::Function* fn, llvm::FunctionCallee callee, const char* name) {
+  /* After the leading allocas, which create_entry_alloca keeps prepending. */
+  llvm::BasicBlock& entry = fn->getEntryBlock();
+  llvm::BasicBlock::iterator at = entry.getFirstInsertionPt();
+  while (at != entry.end() && llvm::isa<llvm::AllocaInst>(*at)) {
+    ++at;
+  }
+  llvm::IRBuilder<> entry_builder(&entry, at);
+  return entry_builder.CreateCall(callee, {}, name);
+}
+
+llvm::Value*
+StyioToLLVM::runtime_error_word(llvm::Function* fn) {
+  auto it = runtime_error_words_.find(fn);
+  if (it != runtime_error_words_.end()) {
+    return it->second;
+  }
+  llvm::FunctionCallee word_fn = theModule->getOrInsertFunction(
+    "styio_runtime_error_word",
+    llvm::FunctionType::get(llvm::PointerType::get(*theContext, 0), false));
+  /* The address is per thread, not per call: one lookup at entry serves every guard below. */
+  llvm::Value* word = call_in_entry_block(fn, word_fn, "runtime_error_word");
+  runtime_error_words_.emplace(fn, word);
+  return word;
+}
+
+llvm::Value*
+StyioToLLVM::list_epoch_word(llvm::Function* fn) {
+  auto it = list_epoch_words_.find(fn);
+  if (it != list_epoch_words_.end()) {
+    return it->second;
+  }
+  llvm::FunctionCallee word_fn = theModule->getOrInsertFunction(
+    "styio_list_epoch_word",
+    llvm::FunctionType::get(llvm::PointerType::get(*theContext, 0), false));
+  llvm::Value* word = call_in_entry_block(fn, word_fn, "list_epoch_word");
+  list_epoch_words_.emplace(fn, word);
+  return word;
+}
+
+/* Interned id of a string-literal dict key, or nullptr for any other key expression. */
+llvm::Value*
+StyioToLLVM::literal_dict_key_id(StyioIR* key) {
+  auto* literal = dynamic_cast<SGConstString*>(key);
+  if (literal == nullptr) {
+    return nullptr;
+  }
+  llvm::GlobalVariable* slot = nullptr;
+  auto it = interned_key_index_.find(literal->value);
+  if (it != interned_key_index_.end()) {
+    slot = interned_keys_[it->second].second;
+  }
+  else {
+    slot = new llvm::GlobalVariable(
+      *theModule,
+      theBuilder->getInt64Ty(),
+      false,
+      llvm::GlobalValue::InternalLinkage,
+      theBuilder->getInt64(0),
+      "styio_key_id");
+    interned_key_index_.emplace(literal->value, interned_keys_.size());
+    interned_keys_.emplace_back(literal->value, slot);
+  }
+  return theBuilder->CreateLoad(theBuilder->getInt64Ty(), slot, "key_id");
+}
+
+/* Intern every literal dict key once, ahead of the first statement of `main`. */
+void
+StyioToLLVM::emit_interned_key_init(llvm::Function* main_func) {
+  if (interned_keys_.empty()) {
+    return;
+  }
+  llvm::FunctionCallee intern_fn = theModule->getOrInsertFunction(
+    "styio_key_intern",
+    llvm::FunctionType::get(theBuilder->getInt64Ty(), {llvm::PointerType::get(*theContext, 0)}, false));
+  llvm::Function* init_fn = llvm::Function::Create(
+    llvm::FunctionType::get(theBuilder->getVoidTy(), false),
+    llvm::Function::InternalLinkage,
+    "styio_intern_keys",
+    *theModule);
+  llvm::IRBuilder<> init_builder(llvm::BasicBlock::Create(*theContext, "entry", init_fn));
+  for (const auto& [text, slot] : interned_keys_) {
+    llvm::Value* id = init_builder.CreateCall(intern_fn, {init_builder.CreateGlobalStringPtr(text, "styio_key")});
+    init_builder.CreateStore(id, slot);
+  }
+  init_builder.CreateRetVoid();
+  call_in_entry_block(main_func, init_fn, "");
+}
+
+/* Call with the insert point in the loop's exit block. */
+void
+StyioToLLVM::pop_loop_frame() {
+  const bool writes_files = loop_stack_.back().writes_files;
+  loop_stack_.pop_back();
+  if (!writes_files) {
+    return;
+  }
+  if (!loop_stack_.empty()) {
+    loop_stack_.back().writes_files = true;
+    return;
+  }
+  llvm::BasicBlock* cur = theBuilder->GetInsertBlock();
+  if (cur == nullptr || cur->getTerminator() != nullptr) {
+    return;
+  }
+  llvm::FunctionCallee release_fn = theModule->getOrInsertFunction(
+    "styio_file_release_writes",
+    llvm::FunctionType::get(theBuilder->getVoidTy(), false));
+  theBuilder->CreateCall(release_fn);
+}
+
 void
 StyioToLLVM::emit_runtime_error_guard_return() {
   llvm::BasicBlock* cur = theBuilder->GetInsertBlock();
@@ -1207,16 +1321,21 @@ StyioToLLVM::emit_runtime_error_guard_return() {
     return;
   }
 
+  /* A load of the thread's error word instead of a styio_runtime_has_error() call per guard;
+     the helper just called may have set it, so the load is never hoisted past the call. */
   llvm::Function* fn = cur->getParent();
-  llvm::FunctionCallee has_error = theModule->getOrInsertFunction(
-    "styio_runtime_has_error",
-    llvm::FunctionType::get(theBuilder->getInt32Ty(), false));
-  llvm::Value* has_err = theBuilder->CreateCall(has_error, {});
+  llvm::Value* word = runtime_error_word(fn);
+  llvm::Value* has_err = theBuilder->CreateLoad(theBuilder->getInt32Ty(), word, "runtime_error");
   llvm::Value* bad = theBuilder->CreateICmpNE(has_err, theBuilder->getInt32(0));
 
   llvm::BasicBlock* abort_bb = llvm::BasicBlock::Create(*theContext, "runtime_fail", fn);
   llvm::BasicBlock* cont_bb = llvm::BasicBlock::Create(*theContext, "runtime_ok", fn);
-  theBuilder->CreateCondBr(bad, abort_bb, cont_bb);
+  /* Helpers fail once per run at most; keep the bail-out off the hot path. */
+  theBuilder->CreateCondBr(
+    bad,
+    abort_bb,
+    cont_bb,
+    llvm::MDBuilder(*theContext).createBranchWeights(1, (1u << 20) - 1));
 
   theBuilder->SetInsertPoint(abort_bb);
   llvm::Type* ret_ty = fn->getReturnType();
@@ -1262,6 +1381,95 @@ StyioToLLVM::cstr_to_f64_checked(llvm::Value* v) {
   return out;
 }
 
+/*
+  Run once a line loop is fully emitted. When the line returned by `read_call` (directly, or
+  through the slot holding it) feeds styio_cstr_to_i64, or only styio_cstr_to_f64, the read
+  becomes styio_file_read_i64 / _f64, which parses the line while it is still in cache, and
+  every conversion becomes a load of that value. The conversion call is kept on a cold path
+  for lines the fused parse rejects, so diagnostics and string uses of the line are unchanged.
+*/
+void
+StyioToLLVM::fuse_numeric_line_read(llvm::CallInst* read_call) {
+  std::vector<llvm::CallInst*> convs;
+  bool want_i64 = false;
+  bool want_f64 = false;
+  auto collect = [&](llvm::Value* line) {
+    for (llvm::User* u : line->users()) {
+      auto* call = llvm::dyn_cast<llvm::CallInst>(u);
+      llvm::Function* callee = call != nullptr ? call->getCalledFunction() : nullptr;
+      if (callee == nullptr || call->getArgOperand(0) != line) {
+        continue;
+      }
+      if (callee->getName() == "styio_cstr_to_i64") {
+        convs.push_back(call);
+        want_i64 = true;
+      }
+      else if (callee->getName() == "styio_cstr_to_f64") {
+        convs.push_back(call);
+        want_f64 = true;
+      }
+    }
+  };
+  collect(read_call);
+  for (llvm::User* u : read_call->users()) {
+    auto* store = llvm::dyn_cast<llvm::StoreInst>(u);
+    if (store == nullptr || store->getValueOperand() != read_call) {
+      continue;
+    }
+    auto* slot = llvm::dyn_cast<llvm::AllocaInst>(store->getPointerOperand());
+    /* Only a slot that never holds anything but this line. */
+    if (slot == nullptr
+        || !llvm::all_of(slot->users(), [store](llvm::User* su) {
+             return su == store || llvm::isa<llvm::LoadInst>(su);
+           })) {
+      continue;
+    }
+    for (llvm::User* su : slot->users()) {
+      if (auto* ld = llvm::dyn_cast<llvm::LoadInst>(su)) {
+        collect(ld);
+      }
+    }
+  }
+  if (convs.empty() || (want_i64 && want_f64)) {
+    return;
+  }
+
+  llvm::Function* F = read_call->getFunction();
+  llvm::Type* i64t = theBuilder->getInt64Ty();
+  llvm::Type* val_ty = want_i64 ? i64t : theBuilder->getDoubleTy();
+  llvm::Type* ptr_ty = llvm::PointerType::get(*theContext, 0);
+  llvm::IRBuilder<> entry_builder(&F->getEntryBlock(), F->getEntryBlock().getFirstInsertionPt());
+  llvm::AllocaInst* val_slot = entry_builder.CreateAlloca(val_ty, nullptr, "fused_line_v");
+  llvm::AllocaInst* ok_slot = entry_builder.CreateAlloca(i64t, nullptr, "fused_line_ok");
+
+  llvm::FunctionCallee fused_fn = theModule->getOrInsertFunction(
+    want_i64 ? "styio_file_read_i64" : "styio_file_read_f64",
+    llvm::FunctionType::get(ptr_ty, {i64t, ptr_ty, ptr_ty}, false));
+  llvm::IRBuilder<> read_builder(read_call);
+  llvm::Value* line = read_builder.CreateCall(fused_fn, {read_call->getArgOperand(0), val_slot, ok_slot});
+  read_call->replaceAllUsesWith(line);
+  read_call->eraseFromParent();
+
+  for (llvm::CallInst* conv : convs) {
+    llvm::BasicBlock* head = conv->getParent();
+    llvm::BasicBlock* tail = head->splitBasicBlock(conv, "fused_line_m");
+    llvm::BasicBlock* cold = llvm::BasicBlock::Create(*theContext, "fused_line_slow", F, tail);
+    head->getTerminator()->eraseFromParent();
+    llvm::IRBuilder<> head_builder(head);
+    llvm::Value* ok = head_builder.CreateICmpNE(
+      head_builder.CreateLoad(i64t, ok_slot),
+      head_builder.getInt64(0));
+    llvm::Value* fast = head_builder.CreateLoad(val_ty, val_slot);
+    head_builder.CreateCondBr(ok, tail, cold);
+    llvm::BranchInst* cold_br = llvm::BranchInst::Create(tail, cold);
+    conv->moveBefore(cold_br);
+    llvm::PHINode* phi = llvm::PHINode::Create(val_ty, 2, "", &tail->front());
+    conv->replaceAllUsesWith(phi);
+    phi->addIncoming(fast, head);
+    phi->addIncoming(conv, cold);
+  }
+}
+
 void
 StyioToLLVM::define_sgfunc_body(SGFunc* node) {
   std::string fname = node->func_name->as_str();
@@ -1588,6 +1796,7 @@ StyioToLLVM::toLLVMIR(SGMainEntry* node) {
     pop_file_handle_scope();
     theBuilder->CreateRet(truncate_for_main_ret(last_main));
   }
+  emit_interned_key_init(main_func);
 
   return main_func;
 }
@@ -1664,7 +1873,7 @@ StyioToLLVM::toLLVMIR(SGLoop* node) {
       theBuilder->CreateBr(body_bb);
     }
     theBuilder->SetInsertPoint(exit_bb);
-    loop_stack_.pop_back();
+    pop_loop_frame();
     return nullptr;
   }
 
@@ -1687,7 +1896,7 @@ StyioToLLVM::toLLVMIR(SGLoop* node) {
     theBuilder->CreateBr(cond_bb);
   }
   theBuilder->SetInsertPoint(exit_bb);
-  loop_stack_.pop_back();
+  pop_loop_frame();
   return nullptr;
 }
 
@@ -1818,7 +2027,7 @@ StyioToLLVM::toLLVMIR(SGForEach* node) {
 
     theBuilder->SetInsertPoint(exit_bb);
     finish_pulse_region();
-    loop_stack_.pop_back();
+    pop_loop_frame();
     return nullptr;
   }
 
@@ -1835,6 +2044,136 @@ StyioToLLVM::toLLVMIR(SGForEach* node) {
         : (elem_bool
             ? static_cast<llvm::Type*>(theBuilder->getInt1Ty())
             : static_cast<llvm::Type*>(i64t)));
+  if (elem_family == StyioValueFamily::Integer || elem_float || elem_bool) {
+    /*
+      Scalar lists are walked over their borrowed storage (styio_list_span_*) instead of a
+      styio_list_get call per element. The span is refetched only when the thread's list
+      epoch moved, i.e. the body pushed, inserted, popped or released some list; the span
+      helpers only write their length out-parameter, so in a body without such calls the
+      epoch check folds away and the loop is plain memory LLVM can vectorize.
+    */
+    llvm::Type* ptr_t = llvm::PointerType::get(*theContext, 0);
+    llvm::Type* store_ty = elem_float ? static_cast<llvm::Type*>(theBuilder->getDoubleTy()) : i64t;
+    llvm::FunctionCallee span_fn = theModule->getOrInsertFunction(
+      elem_float ? "styio_list_span_f64" : (elem_bool ? "styio_list_span_bool" : "styio_list_span_i64"),
+      llvm::FunctionType::get(ptr_t, {i64t, ptr_t}, false));
+    if (auto* span_decl = llvm::dyn_cast<llvm::Function>(span_fn.getCallee())) {
+      span_decl->setMemoryEffects(
+        llvm::MemoryEffects::readOnly() | llvm::MemoryEffects::argMemOnly(llvm::ModRefInfo::ModRef));
+      span_decl->setDoesNotThrow();
+      span_decl->addFnAttr(llvm::Attribute::WillReturn);
+      span_decl->addParamAttr(1, llvm::Attribute::NoCapture);
+    }
+    llvm::FunctionCallee diag_fn = theModule->getOrInsertFunction(
+      elem_float ? "styio_list_get_f64" : (elem_bool ? "styio_list_get_bool" : "styio_list_get"),
+      llvm::FunctionType::get(store_ty, {i64t, i64t}, false));
+
+    llvm::Value* iterable = node->iterable->toLLVMIR(this);
+    if (!iterable->getType()->isIntegerTy(64)) {
+      iterable = theBuilder->CreateSExtOrTrunc(iterable, i64t);
+    }
+    std::optional<TempResourceKind> iterable_kind = take_owned_resource_temp(iterable);
+    const bool release_iterable =
+      iterable_kind.has_value() && *iterable_kind == TempResourceKind::List;
+
+    llvm::Value* epoch_word = list_epoch_word(F);
+    llvm::AllocaInst* list_slot = theBuilder->CreateAlloca(i64t, nullptr, node->var + ".iter");
+    llvm::AllocaInst* idx_slot = theBuilder->CreateAlloca(i64t, nullptr, "fe_idx");
+    llvm::AllocaInst* data_slot = theBuilder->CreateAlloca(ptr_t, nullptr, "fe_data");
+    llvm::AllocaInst* len_slot = theBuilder->CreateAlloca(i64t, nullptr, "fe_len");
+    /* Only the helper sees this one, so the slots above still become SSA values. */
+    llvm::AllocaInst* len_out = theBuilder->CreateAlloca(i64t, nullptr, "fe_len_out");
+    llvm::AllocaInst* epoch_slot = theBuilder->CreateAlloca(i64t, nullptr, "fe_epoch");
+    theBuilder->CreateStore(iterable, list_slot);
+    theBuilder->CreateStore(zero, idx_slot);
+
+    auto fetch_span = [&](llvm::Value* epoch) {
+      llvm::Value* h = theBuilder->CreateLoad(i64t, list_slot);
+      theBuilder->CreateStore(theBuilder->CreateCall(span_fn, {h, len_out}), data_slot);
+      theBuilder->CreateStore(theBuilder->CreateLoad(i64t, len_out), len_slot);
+      theBuilder->CreateStore(epoch, epoch_slot);
+    };
+    fetch_span(theBuilder->CreateLoad(i64t, epoch_word, "list_epoch"));
+
+    llvm::BasicBlock* exit_bb = llvm::BasicBlock::Create(*theContext, "foreach_span_exit", F);
+    llvm::BasicBlock* hdr_bb = llvm::BasicBlock::Create(*theContext, "foreach_span_hdr", F);
+    llvm::BasicBlock* refresh_bb = llvm::BasicBlock::Create(*theContext, "foreach_span_refresh", F);
+    llvm::BasicBlock* check_bb = llvm::BasicBlock::Create(*theContext, "foreach_span_check", F);
+    llvm::BasicBlock* body_bb = llvm::BasicBlock::Create(*theContext, "foreach_span_body", F);
+    llvm::BasicBlock* step_bb = llvm::BasicBlock::Create(*theContext, "foreach_span_step", F);
+    theBuilder->CreateBr(hdr_bb);
+
+    theBuilder->SetInsertPoint(hdr_bb);
+    llvm::Value* epoch_now = theBuilder->CreateLoad(i64t, epoch_word, "list_epoch");
+    llvm::Value* stale = theBuilder->CreateICmpNE(epoch_now, theBuilder->CreateLoad(i64t, epoch_slot));
+    theBuilder->CreateCondBr(
+      stale,
+      refresh_bb,
+      check_bb,
+      llvm::MDBuilder(*theContext).createBranchWeights(1, (1u << 20) - 1));
+
+    theBuilder->SetInsertPoint(refresh_bb);
+    fetch_span(epoch_now);
+    theBuilder->CreateBr(check_bb);
+
+    theBuilder->SetInsertPoint(check_bb);
+    llvm::Value* go = theBuilder->CreateICmpSLT(
+      theBuilder->CreateLoad(i64t, idx_slot),
+      theBuilder->CreateLoad(i64t, len_slot));
+    theBuilder->CreateCondBr(go, body_bb, exit_bb);
+
+    loop_stack_.push_back(LoopFrame{exit_bb, step_bb});
+    theBuilder->SetInsertPoint(body_bb);
+    llvm::Value* idx = theBuilder->CreateLoad(i64t, idx_slot);
+    llvm::Value* data = theBuilder->CreateLoad(ptr_t, data_slot);
+    llvm::Value* elem = theBuilder->CreateLoad(store_ty, theBuilder->CreateInBoundsGEP(store_ty, data, idx));
+    if (elem_bool) {
+      elem = theBuilder->CreateICmpNE(elem, theBuilder->getInt64(0));
+    }
+
+    llvm::AllocaInst* vs = theBuilder->CreateAlloca(elem_ty, nullptr, node->var);
+    theBuilder->CreateStore(elem, vs);
+    mutable_variables[node->var] = vs;
+
+    emit_snapshot_shadow_reload();
+    run_pulse_prologue();
+    node->body->toLLVMIR(this);
+    run_pulse_epilogue();
+    mutable_variables.erase(node->var);
+
+    llvm::BasicBlock* bcur = theBuilder->GetInsertBlock();
+    if (bcur && !bcur->getTerminator()) {
+      theBuilder->CreateBr(step_bb);
+    }
+
+    theBuilder->SetInsertPoint(step_bb);
+    llvm::Value* nx = theBuilder->CreateAdd(theBuilder->CreateLoad(i64t, idx_slot), one);
+    theBuilder->CreateStore(nx, idx_slot);
+    theBuilder->CreateBr(hdr_bb);
+
+    /* The span helpers stay silent; a bad handle or element kind is reported here by the
+       checked getter, with the same subcodes the per-element loop raised. */
+    theBuilder->SetInsertPoint(exit_bb);
+    llvm::BasicBlock* diag_bb = llvm::BasicBlock::Create(*theContext, "foreach_span_diag", F);
+    llvm::BasicBlock* done_bb = llvm::BasicBlock::Create(*theContext, "foreach_span_done", F);
+    llvm::Value* no_span = theBuilder->CreateICmpEQ(
+      theBuilder->CreateLoad(ptr_t, data_slot),
+      llvm::ConstantPointerNull::get(llvm::cast<llvm::PointerType>(ptr_t)));
+    theBuilder->CreateCondBr(no_span, diag_bb, done_bb);
+    theBuilder->SetInsertPoint(diag_bb);
+    theBuilder->CreateCall(diag_fn, {theBuilder->CreateLoad(i64t, list_slot), zero});
+    theBuilder->CreateBr(done_bb);
+
+    theBuilder->SetInsertPoint(done_bb);
+    if (release_iterable) {
+      llvm::Value* owned = theBuilder->CreateLoad(i64t, list_slot);
+      theBuilder->CreateCall(list_release_fn(), {owned});
+    }
+    finish_pulse_region();
+    pop_loop_frame();
+    return nullptr;
+  }
+
   llvm::Type* get_ty = elem_string
     ? static_cast<llvm::Type*>(llvm::PointerType::get(*theContext, 0))
     : (elem_float
@@ -1930,7 +2269,7 @@ StyioToLLVM::toLLVMIR(SGForEach* node) {
     theBuilder->CreateCall(list_release_fn(), {owned});
   }
   finish_pulse_region();
-  loop_stack_.pop_back();
+  pop_loop_frame();
   return nullptr;
 }
 
@@ -1988,7 +2327,7 @@ StyioToLLVM::toLLVMIR(SGRangeFor* node) {
   theBuilder->CreateBr(hdr_bb);
 
   theBuilder->SetInsertPoint(exit_bb);
-  loop_stack_.pop_back();
+  pop_loop_frame();
   return nullptr;
 }
 
@@ -2115,49 +2454,50 @@ StyioToLLVM::toLLVMIR(SGListLiteral* node) {
 llvm::Value*
 StyioToLLVM::toLLVMIR(SGDictLiteral* node) {
   StyioValueFamily value_family = styio_value_family_from_type_name(node->value_type);
-  const char* new_name = "styio_dict_new_i64";
-  const char* set_name = "styio_dict_set_i64";
+  const bool int_keys = node->key_type == "i64";
+  const char* suffix = "i64";
   llvm::Type* set_value_type = theBuilder->getInt64Ty();
   switch (value_family) {
     case StyioValueFamily::Bool:
-      new_name = "styio_dict_new_bool";
-      set_name = "styio_dict_set_bool";
+      suffix = "bool";
       break;
     case StyioValueFamily::Float:
-      new_name = "styio_dict_new_f64";
-      set_name = "styio_dict_set_f64";
+      suffix = "f64";
       set_value_type = theBuilder->getDoubleTy();
       break;
     case StyioValueFamily::String:
-      new_name = "styio_dict_new_cstr";
-      set_name = "styio_dict_set_cstr";
+      suffix = "cstr";
       set_value_type = llvm::PointerType::get(*theContext, 0);
       break;
     case StyioValueFamily::ListHandle:
-      new_name = "styio_dict_new_list";
-      set_name = "styio_dict_set_list";
+      suffix = "list";
       break;
     case StyioValueFamily::DictHandle:
-      new_name = "styio_dict_new_dict";
-      set_name = "styio_dict_set_dict";
+      suffix = "dict";
       break;
     case StyioValueFamily::Integer:
     default:
       break;
   }
+  llvm::Type* key_type = int_keys
+    ? static_cast<llvm::Type*>(theBuilder->getInt64Ty())
+    : static_cast<llvm::Type*>(llvm::PointerType::get(*theContext, 0));
   llvm::FunctionCallee new_fn = theModule->getOrInsertFunction(
-    new_name,
+    std::string(int_keys ? "styio_idict_new_" : "styio_dict_new_") + suffix,
     llvm::FunctionType::get(theBuilder->getInt64Ty(), {}, false));
   llvm::FunctionCallee set_fn = theModule->getOrInsertFunction(
-    set_name,
+    std::string(int_keys ? "styio_idict_set_" : "styio_dict_set_") + suffix,
     llvm::FunctionType::get(
       theBuilder->getVoidTy(),
-      {theBuilder->getInt64Ty(), llvm::PointerType::get(*theContext, 0), set_value_type},
+      {theBuilder->getInt64Ty(), key_type, set_value_type},
       false));
 
   llvm::Value* dict = theBuilder->CreateCall(new_fn, {});
   for (const auto& entry : node->entries) {
     llvm::Value* key = entry.key->toLLVMIR(this);
+    if (int_keys && !key->getType()->isIntegerTy(64)) {
+      key = theBuilder->CreateSExtOrTrunc(key, theBuilder->getInt64Ty());
+    }
     llvm::Value* value = entry.value->toLLVMIR(this);
     if (value_family == StyioValueFamily::String) {
       if (!value->getType()->isPointerTy()) {
@@ -2436,6 +2776,24 @@ StyioToLLVM::emit_snapshot_shadow_reload() {
 
 namespace {
 
+/* "<type>:<name>" lines, the column spec styio_csv_open / styio_col_open / styio_col_acquire_write take. */
+template <typename Columns>
+std::string
+columnar_spec(const Columns& columns) {
+  std::string spec;
+  for (const auto& col : columns) {
+    if (!spec.empty()) {
+      spec += '\n';
+    }
+    spec += col.type + ":" + col.name;
+  }
+  return spec;
+}
+
+}  // namespace
+
+namespace {
+
 std::string
 path_key_from_path_ir(StyioIR* path_expr) {
   if (auto* cs = dynamic_cast<SGConstString*>(path_expr)) {
@@ -2489,7 +2847,7 @@ StyioToLLVM::toLLVMIR(SGFileLineIter* node) {
   llvm::Function* F = theBuilder->GetInsertBlock()->getParent();
   llvm::Type* char_ptr = llvm::PointerType::get(*theContext, 0);
   llvm::FunctionCallee open_fn = theModule->getOrInsertFunction(
-    "styio_file_open",
+    node->is_auto ? "styio_file_open_auto" : "styio_file_open",
     llvm::FunctionType::get(theBuilder->getInt64Ty(), {char_ptr}, false));
   llvm::FunctionCallee read_fn = theModule->getOrInsertFunction(
     "styio_file_read_line",
@@ -2547,7 +2905,7 @@ StyioToLLVM::toLLVMIR(SGFileLineIter* node) {
   theBuilder->CreateBr(hdr);
   theBuilder->SetInsertPoint(hdr);
   llvm::Value* h = theBuilder->CreateLoad(theBuilder->getInt64Ty(), h_slot);
-  llvm::Value* lineptr = theBuilder->CreateCall(read_fn, {h});
+  llvm::CallInst* lineptr = theBuilder->CreateCall(read_fn, {h});
   llvm::Value* null_line = llvm::ConstantPointerNull::get(
     llvm::cast<llvm::PointerType>(char_ptr));
   llvm::Value* done = theBuilder->CreateICmpEQ(lineptr, null_line);
@@ -2588,6 +2946,7 @@ StyioToLLVM::toLLVMIR(SGFileLineIter* node) {
   }
 
   theBuilder->SetInsertPoint(exit_bb);
+  fuse_numeric_line_read(lineptr);
   if (pulse_sz > 0 && node->pulse_region_id >= 0) {
     llvm::Type* i8p = llvm::PointerType::get(*theContext, 0);
     llvm::Value* li8 = theBuilder->CreateBitCast(ledger_alloc, i8p);
@@ -2603,6 +2962,290 @@ StyioToLLVM::toLLVMIR(SGFileLineIter* node) {
   return theBuilder->getInt64(0);
 }
 
+llvm::Value*
+StyioToLLVM::toLLVMIR(SGCsvIter* node) {
+  llvm::Function* F = theBuilder->GetInsertBlock()->getParent();
+  llvm::Type* i64t = theBuilder->getInt64Ty();
+  llvm::Type* char_ptr = llvm::PointerType::get(*theContext, 0);
+  llvm::FunctionCallee open_fn = theModule->getOrInsertFunction(
+    "styio_csv_open",
+    llvm::FunctionType::get(i64t, {char_ptr, char_ptr}, false));
+  llvm::FunctionCallee batch_fn = theModule->getOrInsertFunction(
+    "styio_csv_next_batch",
+    llvm::FunctionType::get(i64t, {i64t}, false));
+  llvm::FunctionCallee i64_col_fn = theModule->getOrInsertFunction(
+    "styio_csv_column_i64",
+    llvm::FunctionType::get(char_ptr, {i64t, i64t}, false));
+  llvm::FunctionCallee f64_col_fn = theModule->getOrInsertFunction(
+    "styio_csv_column_f64",
+    llvm::FunctionType::get(char_ptr, {i64t, i64t}, false));
+  llvm::FunctionCallee str_col_fn = theModule->getOrInsertFunction(
+    "styio_csv_column_cstr",
+    llvm::FunctionType::get(char_ptr, {i64t, i64t}, false));
+  llvm::FunctionCallee close_fn = theModule->getOrInsertFunction(
+    "styio_csv_close",
+    llvm::FunctionType::get(theBuilder->getVoidTy(), {i64t}, false));
+
+  /* Only the columns the body reads are parsed; see styio_csv_open for the spec format. */
+  llvm::Value* path = node->path_expr->toLLVMIR(this);
+  llvm::Value* h = theBuilder->CreateCall(
+    open_fn,
+    {path, theBuilder->CreateGlobalStringPtr(columnar_spec(node->columns), "csv_columns")});
+  /* Unreadable file or a column missing from the header. */
+  emit_runtime_error_guard_return();
+
+  llvm::BasicBlock* batch_hdr = llvm::BasicBlock::Create(*theContext, "csv_batch", F);
+  llvm::BasicBlock* batch_body = llvm::BasicBlock::Create(*theContext, "csv_columns", F);
+  llvm::BasicBlock* row_hdr = llvm::BasicBlock::Create(*theContext, "csv_row_hdr", F);
+  llvm::BasicBlock* row_body = llvm::BasicBlock::Create(*theContext, "csv_row_body", F);
+  llvm::BasicBlock* row_step = llvm::BasicBlock::Create(*theContext, "csv_row_step", F);
+  llvm::BasicBlock* exit_bb = llvm::BasicBlock::Create(*theContext, "csv_exit", F);
+
+  llvm::AllocaInst* idx_slot = theBuilder->CreateAlloca(i64t, nullptr, node->row_var + ".idx");
+  theBuilder->CreateBr(batch_hdr);
+
+  theBuilder->SetInsertPoint(batch_hdr);
+  llvm::Value* rows = theBuilder->CreateCall(batch_fn, {h}, "csv_rows");
+  llvm::Value* done = theBuilder->CreateICmpEQ(rows, theBuilder->getInt64(0));
+  theBuilder->CreateCondBr(done, exit_bb, batch_body);
+
+  /* Column arrays are fetched once per batch; the row loop below only indexes them. */
+  theBuilder->SetInsertPoint(batch_body);
+  CsvRowFrame frame;
+  for (size_t c = 0; c < node->columns.size(); ++c) {
+    const std::string& type = node->columns[c].type;
+    frame.columns.push_back(theBuilder->CreateCall(
+      type == "i64" ? i64_col_fn : (type == "f64" ? f64_col_fn : str_col_fn),
+      {h, theBuilder->getInt64(static_cast<int64_t>(c))}));
+  }
+  theBuilder->CreateStore(theBuilder->getInt64(0), idx_slot);
+  theBuilder->CreateBr(row_hdr);
+
+  theBuilder->SetInsertPoint(row_hdr);
+  frame.index = theBuilder->CreateLoad(i64t, idx_slot);
+  llvm::Value* more = theBuilder->CreateICmpSLT(frame.index, rows);
+  theBuilder->CreateCondBr(more, row_body, batch_hdr);
+
+  loop_stack_.push_back(LoopFrame{exit_bb, row_step});
+  std::optional<CsvRowFrame> outer_frame;
+  if (auto it = csv_rows_.find(node->row_var); it != csv_rows_.end()) {
+    outer_frame = it->second;
+  }
+  csv_rows_[node->row_var] = frame;
+
+  theBuilder->SetInsertPoint(row_body);
+  emit_snapshot_shadow_reload();
+  node->body->toLLVMIR(this);
+  llvm::BasicBlock* bcur = theBuilder->GetInsertBlock();
+  if (bcur && !bcur->getTerminator()) {
+    theBuilder->CreateBr(row_step);
+  }
+
+  if (outer_frame) {
+    csv_rows_[node->row_var] = *outer_frame;
+  }
+  else {
+    csv_rows_.erase(node->row_var);
+  }
+
+  theBuilder->SetInsertPoint(row_step);
+  llvm::Value* next = theBuilder->CreateAdd(theBuilder->CreateLoad(i64t, idx_slot), theBuilder->getInt64(1));
+  theBuilder->CreateStore(next, idx_slot);
+  theBuilder->CreateBr(row_hdr);
+
+  theBuilder->SetInsertPoint(exit_bb);
+  pop_loop_frame();
+  theBuilder->CreateCall(close_fn, {h});
+  /* A numeric cell that did not parse ends the batch stream with the runtime error set. */
+  emit_runtime_error_guard_return();
+  return theBuilder->getInt64(0);
+}
+
+llvm::Value*
+StyioToLLVM::toLLVMIR(SGCsvField* node) {
+  auto it = csv_rows_.find(node->row_var);
+  if (it == csv_rows_.end() || node->column < 0
+      || static_cast<size_t>(node->column) >= it->second.columns.size()) {
+    throw StyioTypeError("csv field used outside its #(row: csv) loop: " + node->row_var);
+  }
+  llvm::Type* elem_ty = toLLVMType(node);
+  llvm::Value* cell = theBuilder->CreateInBoundsGEP(
+    elem_ty,
+    it->second.columns[static_cast<size_t>(node->column)],
+    it->second.index);
+  return theBuilder->CreateLoad(elem_ty, cell, node->row_var + ".cell");
+}
+
+llvm::Value*
+StyioToLLVM::toLLVMIR(SGColumnarIter* node) {
+  llvm::Function* F = theBuilder->GetInsertBlock()->getParent();
+  llvm::Type* i64t = theBuilder->getInt64Ty();
+  llvm::Type* char_ptr = llvm::PointerType::get(*theContext, 0);
+  llvm::FunctionCallee open_fn = theModule->getOrInsertFunction(
+    "styio_col_open",
+    llvm::FunctionType::get(i64t, {char_ptr, char_ptr}, false));
+  llvm::FunctionCallee rows_fn = theModule->getOrInsertFunction(
+    "styio_col_rows",
+    llvm::FunctionType::get(i64t, {i64t}, false));
+  llvm::FunctionCallee data_fn = theModule->getOrInsertFunction(
+    "styio_col_data",
+    llvm::FunctionType::get(char_ptr, {i64t, i64t}, false));
+  llvm::FunctionCallee strings_fn = theModule->getOrInsertFunction(
+    "styio_col_strings",
+    llvm::FunctionType::get(char_ptr, {i64t, i64t}, false));
+  llvm::FunctionCallee close_fn = theModule->getOrInsertFunction(
+    "styio_col_close",
+    llvm::FunctionType::get(theBuilder->getVoidTy(), {i64t}, false));
+
+  llvm::Value* path = node->path_expr->toLLVMIR(this);
+  llvm::Value* h = theBuilder->CreateCall(
+    open_fn,
+    {path, theBuilder->CreateGlobalStringPtr(columnar_spec(node->columns), "col_columns")});
+  /* Unreadable or malformed file, or a column missing / of another type. */
+  emit_runtime_error_guard_return();
+
+  /* The whole file is mapped: column bases are fetched once and the loop only indexes them. */
+  llvm::Value* rows = theBuilder->CreateCall(rows_fn, {h}, "col_rows");
+  std::vector<llvm::Value*> data;
+  std::vector<llvm::Value*> blobs;
+  std::vector<llvm::AllocaInst*> slots;
+  for (size_t c = 0; c < node->columns.size(); ++c) {
+    const auto& col = node->columns[c];
+    llvm::Value* idx = theBuilder->getInt64(static_cast<int64_t>(c));
+    data.push_back(theBuilder->CreateCall(data_fn, {h, idx}));
+    blobs.push_back(col.type == "str" ? theBuilder->CreateCall(strings_fn, {h, idx}) : nullptr);
+    llvm::Type* slot_ty = char_ptr;
+    if (col.type == "i64") {
+      slot_ty = i64t;
+    }
+    else if (col.type == "f64") {
+      slot_ty = theBuilder->getDoubleTy();
+    }
+    else if (col.type == "bool") {
+      slot_ty = theBuilder->getInt1Ty();
+    }
+    slots.push_back(theBuilder->CreateAlloca(slot_ty, nullptr, col.name));
+  }
+  llvm::AllocaInst* idx_slot = theBuilder->CreateAlloca(i64t, nullptr, "col_row.idx");
+  theBuilder->CreateStore(theBuilder->getInt64(0), idx_slot);
+
+  llvm::BasicBlock* hdr_bb = llvm::BasicBlock::Create(*theContext, "col_row_hdr", F);
+  llvm::BasicBlock* body_bb = llvm::BasicBlock::Create(*theContext, "col_row_body", F);
+  llvm::BasicBlock* step_bb = llvm::BasicBlock::Create(*theContext, "col_row_step", F);
+  llvm::BasicBlock* exit_bb = llvm::BasicBlock::Create(*theContext, "col_exit", F);
+  theBuilder->CreateBr(hdr_bb);
+
+  theBuilder->SetInsertPoint(hdr_bb);
+  llvm::Value* row = theBuilder->CreateLoad(i64t, idx_slot);
+  theBuilder->CreateCondBr(theBuilder->CreateICmpSLT(row, rows), body_bb, exit_bb);
+
+  theBuilder->SetInsertPoint(body_bb);
+  std::unordered_map<std::string, llvm::AllocaInst*> outer;
+  for (size_t c = 0; c < node->columns.size(); ++c) {
+    const auto& col = node->columns[c];
+    llvm::Value* value = nullptr;
+    if (col.type == "str") {
+      llvm::Value* off = theBuilder->CreateLoad(i64t, theBuilder->CreateInBoundsGEP(i64t, data[c], row));
+      value = theBuilder->CreateInBoundsGEP(theBuilder->getInt8Ty(), blobs[c], off, col.name);
+    }
+    else if (col.type == "bool") {
+      llvm::Value* byte = theBuilder->CreateLoad(
+        theBuilder->getInt8Ty(),
+        theBuilder->CreateInBoundsGEP(theBuilder->getInt8Ty(), data[c], row));
+      value = theBuilder->CreateICmpNE(byte, theBuilder->getInt8(0), col.name);
+    }
+    else {
+      llvm::Type* elem_ty = slots[c]->getAllocatedType();
+      value = theBuilder->CreateLoad(elem_ty, theBuilder->CreateInBoundsGEP(elem_ty, data[c], row), col.name);
+    }
+    theBuilder->CreateStore(value, slots[c]);
+    if (auto it = mutable_variables.find(col.name); it != mutable_variables.end()) {
+      outer[col.name] = it->second;
+    }
+    mutable_variables[col.name] = slots[c];
+  }
+
+  loop_stack_.push_back(LoopFrame{exit_bb, step_bb});
+  emit_snapshot_shadow_reload();
+  node->body->toLLVMIR(this);
+  llvm::BasicBlock* bcur = theBuilder->GetInsertBlock();
+  if (bcur && !bcur->getTerminator()) {
+    theBuilder->CreateBr(step_bb);
+  }
+  for (const auto& col : node->columns) {
+    if (auto it = outer.find(col.name); it != outer.end()) {
+      mutable_variables[col.name] = it->second;
+    }
+    else {
+      mutable_variables.erase(col.name);
+    }
+  }
+
+  theBuilder->SetInsertPoint(step_bb);
+  llvm::Value* next = theBuilder->CreateAdd(theBuilder->CreateLoad(i64t, idx_slot), theBuilder->getInt64(1));
+  theBuilder->CreateStore(next, idx_slot);
+  theBuilder->CreateBr(hdr_bb);
+
+  theBuilder->SetInsertPoint(exit_bb);
+  pop_loop_frame();
+  theBuilder->CreateCall(close_fn, {h});
+  return theBuilder->getInt64(0);
+}
+
+llvm::Value*
+StyioToLLVM::toLLVMIR(SGColumnarWrite* node) {
+  llvm::Type* i64t = theBuilder->getInt64Ty();
+  llvm::Type* char_ptr = llvm::PointerType::get(*theContext, 0);
+  /* Cached per path like styio_file_acquire_write; written out when the loop releases it. */
+  llvm::FunctionCallee acquire_fn = theModule->getOrInsertFunction(
+    "styio_col_acquire_write",
+    llvm::FunctionType::get(i64t, {char_ptr, char_ptr}, false));
+
+  llvm::Value* path = node->path_expr->toLLVMIR(this);
+  llvm::Value* h = theBuilder->CreateCall(
+    acquire_fn,
+    {path, theBuilder->CreateGlobalStringPtr(columnar_spec(node->columns), "col_columns")});
+  if (!loop_stack_.empty()) {
+    loop_stack_.back().writes_files = true;
+  }
+  for (size_t c = 0; c < node->columns.size(); ++c) {
+    const auto& col = node->columns[c];
+    llvm::Value* v = col.value->toLLVMIR(this);
+    llvm::Type* arg_ty = i64t;
+    if (col.type == "i64") {
+      if (v->getType()->isDoubleTy()) {
+        v = theBuilder->CreateFPToSI(v, i64t);
+      }
+      else {
+        v = theBuilder->CreateSExtOrTrunc(v, i64t);
+      }
+    }
+    else if (col.type == "f64") {
+      arg_ty = theBuilder->getDoubleTy();
+      if (v->getType()->isIntegerTy()) {
+        v = theBuilder->CreateSIToFP(v, arg_ty);
+      }
+    }
+    else if (col.type == "bool") {
+      v = theBuilder->CreateZExtOrTrunc(v, i64t);
+    }
+    else {
+      arg_ty = char_ptr;
+      if (!v->getType()->isPointerTy()) {
+        v = promote_to_cstr(v);
+      }
+    }
+    llvm::FunctionCallee write_fn = theModule->getOrInsertFunction(
+      col.type == "str" ? "styio_col_write_cstr" : "styio_col_write_" + col.type,
+      llvm::FunctionType::get(theBuilder->getVoidTy(), {i64t, i64t, arg_ty}, false));
+    theBuilder->CreateCall(write_fn, {h, theBuilder->getInt64(static_cast<int64_t>(c)), v});
+    if (arg_ty == char_ptr) {
+      free_owned_cstr_temp_if_tracked(v);
+    }
+  }
+  return theBuilder->getInt64(0);
+}
+
 llvm::Value*
 StyioToLLVM::toLLVMIR(SGSnapshotDecl* node) {
   llvm::AllocaInst* slot = theBuilder->CreateAlloca(
@@ -2867,22 +3510,33 @@ StyioToLLVM::toLLVMIR(SGDictGet* node) {
     : (float_value
         ? static_cast<llvm::Type*>(theBuilder->getDoubleTy())
         : static_cast<llvm::Type*>(theBuilder->getInt64Ty()));
-  llvm::FunctionCallee get_fn = theModule->getOrInsertFunction(
-    string_value
-      ? "styio_dict_get_cstr"
-      : (float_value
-          ? "styio_dict_get_f64"
-          : (bool_value
-              ? "styio_dict_get_bool"
-              : (list_value
-                  ? "styio_dict_get_list"
-                  : (dict_value ? "styio_dict_get_dict" : "styio_dict_get_i64")))),
-    llvm::FunctionType::get(
-      result_type,
-      {theBuilder->getInt64Ty(), llvm::PointerType::get(*theContext, 0)},
-      false));
+  const bool int_keys = node->key_type == "i64";
+  std::string get_name = std::string(int_keys ? "styio_idict_get_" : "styio_dict_get_")
+    + (string_value
+        ? "cstr"
+        : (float_value
+            ? "f64"
+            : (bool_value ? "bool" : (list_value ? "list" : (dict_value ? "dict" : "i64")))));
   llvm::Value* dict = node->dict->toLLVMIR(this);
-  llvm::Value* key = node->key->toLLVMIR(this);
+  /* Literal keys go through their interned id: no key string or hash work per access. */
+  llvm::Value* key = int_keys ? nullptr : literal_dict_key_id(node->key);
+  llvm::Type* key_type = llvm::PointerType::get(*theContext, 0);
+  if (key != nullptr) {
+    get_name += "_keyid";
+    key_type = theBuilder->getInt64Ty();
+  }
+  else {
+    key = node->key->toLLVMIR(this);
+    if (int_keys) {
+      key_type = theBuilder->getInt64Ty();
+      if (!key->getType()->isIntegerTy(64)) {
+        key = theBuilder->CreateSExtOrTrunc(key, key_type);
+      }
+    }
+  }
+  llvm::FunctionCallee get_fn = theModule->getOrInsertFunction(
+    get_name,
+    llvm::FunctionType::get(result_type, {theBuilder->getInt64Ty(), key_type}, false));
   if (!dict->getType()->isIntegerTy(64)) {
     dict = theBuilder->CreateSExtOrTrunc(dict, theBuilder->getInt64Ty());
   }
@@ -2908,37 +3562,53 @@ llvm::Value*
 StyioToLLVM::toLLVMIR(SGDictSet* node) {
   StyioValueFamily value_family = styio_value_family_from_type_name(node->value_type);
   llvm::Type* set_value_type = theBuilder->getInt64Ty();
-  const char* set_name = "styio_dict_set_i64";
+  const bool int_keys = node->key_type == "i64";
+  const char* suffix = "i64";
   switch (value_family) {
     case StyioValueFamily::Bool:
-      set_name = "styio_dict_set_bool";
+      suffix = "bool";
       break;
     case StyioValueFamily::Float:
-      set_name = "styio_dict_set_f64";
+      suffix = "f64";
       set_value_type = theBuilder->getDoubleTy();
       break;
     case StyioValueFamily::String:
-      set_name = "styio_dict_set_cstr";
+      suffix = "cstr";
       set_value_type = llvm::PointerType::get(*theContext, 0);
       break;
     case StyioValueFamily::ListHandle:
-      set_name = "styio_dict_set_list";
+      suffix = "list";
       break;
     case StyioValueFamily::DictHandle:
-      set_name = "styio_dict_set_dict";
+      suffix = "dict";
       break;
     case StyioValueFamily::Integer:
     default:
       break;
   }
+  llvm::Value* dict = node->dict->toLLVMIR(this);
+  llvm::Value* key = int_keys ? nullptr : literal_dict_key_id(node->key);
+  llvm::Type* key_type = llvm::PointerType::get(*theContext, 0);
+  std::string set_fn_name = std::string(int_keys ? "styio_idict_set_" : "styio_dict_set_") + suffix;
+  if (key != nullptr) {
+    set_fn_name += "_keyid";
+    key_type = theBuilder->getInt64Ty();
+  }
+  else {
+    key = node->key->toLLVMIR(this);
+    if (int_keys) {
+      key_type = theBuilder->getInt64Ty();
+      if (!key->getType()->isIntegerTy(64)) {
+        key = theBuilder->CreateSExtOrTrunc(key, key_type);
+      }
+    }
+  }
   llvm::FunctionCallee set_fn = theModule->getOrInsertFunction(
-    set_name,
+    set_fn_name,
     llvm::FunctionType::get(
       theBuilder->getVoidTy(),
-      {theBuilder->getInt64Ty(), llvm::PointerType::get(*theContext, 0), set_value_type},
+      {theBuilder->getInt64Ty(), key_type, set_value_type},
       false));
-  llvm::Value* dict = node->dict->toLLVMIR(this);
-  llvm::Value* key = node->key->toLLVMIR(this);
   llvm::Value* value = node->value->toLLVMIR(this);
   if (!dict->getType()->isIntegerTy(64)) {
     dict = theBuilder->CreateSExtOrTrunc(dict, theBuilder->getInt64Ty());
@@ -3251,7 +3921,7 @@ StyioToLLVM::toLLVMIR(SGStreamZip* node) {
     theBuilder->CreateBr(hdr_bb);
 
     theBuilder->SetInsertPoint(exit_bb);
-    loop_stack_.pop_back();
+    pop_loop_frame();
     finish_zip();
     return theBuilder->getInt64(0);
   }
@@ -3322,7 +3992,7 @@ StyioToLLVM::toLLVMIR(SGStreamZip* node) {
 
     theBuilder->SetInsertPoint(read_bb);
     llvm::Value* hh = theBuilder->CreateLoad(i64t, hb);
-    llvm::Value* ln = theBuilder->CreateCall(read_fn, {hh});
+    llvm::CallInst* ln = theBuilder->CreateCall(read_fn, {hh});
     llvm::Value* null_ln = llvm::ConstantPointerNull::get(llvm::cast<llvm::PointerType>(char_ptr));
     llvm::Value* got = theBuilder->CreateICmpNE(ln, null_ln);
     theBuilder->CreateCondBr(got, body_bb, exit_bb);
@@ -3368,7 +4038,8 @@ StyioToLLVM::toLLVMIR(SGStreamZip* node) {
     theBuilder->SetInsertPoint(exit_bb);
     llvm::Value* hf = theBuilder->CreateLoad(i64t, hb);
     theBuilder->CreateCall(close_fn, {hf});
-    loop_stack_.pop_back();
+    pop_loop_frame();
+    fuse_numeric_line_read(ln);
     finish_zip();
     return theBuilder->getInt64(0);
   }
@@ -3439,7 +4110,7 @@ StyioToLLVM::toLLVMIR(SGStreamZip* node) {
 
     theBuilder->SetInsertPoint(read_bb);
     llvm::Value* hh = theBuilder->CreateLoad(i64t, ha);
-    llvm::Value* ln = theBuilder->CreateCall(read_fn, {hh});
+    llvm::CallInst* ln = theBuilder->CreateCall(read_fn, {hh});
     llvm::Value* null_ln = llvm::ConstantPointerNull::get(llvm::cast<llvm::PointerType>(char_ptr));
     llvm::Value* got = theBuilder->CreateICmpNE(ln, null_ln);
     theBuilder->CreateCondBr(got, body_bb, exit_bb);
@@ -3485,7 +4156,8 @@ StyioToLLVM::toLLVMIR(SGStreamZip* node) {
     theBuilder->SetInsertPoint(exit_bb);
     llvm::Value* hfe = theBuilder->CreateLoad(i64t, ha);
     theBuilder->CreateCall(close_fn, {hfe});
-    loop_stack_.pop_back();
+    pop_loop_frame();
+    fuse_numeric_line_read(ln);
     finish_zip();
     return theBuilder->getInt64(0);
   }
@@ -3506,8 +4178,8 @@ StyioToLLVM::toLLVMIR(SGStreamZip* node) {
 
     theBuilder->CreateBr(hdr_bb);
     theBuilder->SetInsertPoint(hdr_bb);
-    llvm::Value* la = theBuilder->CreateCall(read_fn, {theBuilder->CreateLoad(i64t, ha)});
-    llvm::Value* lb = theBuilder->CreateCall(read_fn, {theBuilder->CreateLoad(i64t, hb)});
+    llvm::CallInst* la = theBuilder->CreateCall(read_fn, {theBuilder->CreateLoad(i64t, ha)});
+    llvm::CallInst* lb = theBuilder->CreateCall(read_fn, {theBuilder->CreateLoad(i64t, hb)});
     llvm::Value* null_ln = llvm::ConstantPointerNull::get(llvm::cast<llvm::PointerType>(char_ptr));
     llvm::Value* da = theBuilder->CreateICmpEQ(la, null_ln);
     llvm::Value* db = theBuilder->CreateICmpEQ(lb, null_ln);
@@ -3551,7 +4223,9 @@ StyioToLLVM::toLLVMIR(SGStreamZip* node) {
     theBuilder->SetInsertPoint(exit_bb);
     theBuilder->CreateCall(close_fn, {theBuilder->CreateLoad(i64t, ha)});
     theBuilder->CreateCall(close_fn, {theBuilder->CreateLoad(i64t, hb)});
-    loop_stack_.pop_back();
+    pop_loop_frame();
+    fuse_numeric_line_read(la);
+    fuse_numeric_line_read(lb);
     finish_zip();
     return theBuilder->getInt64(0);
   }
@@ -3564,8 +4238,10 @@ llvm::Value*
 StyioToLLVM::toLLVMIR(SGResourceWriteToFile* node) {
   (void)node->is_auto_path;
   llvm::Type* char_ptr = llvm::PointerType::get(*theContext, 0);
-  llvm::FunctionCallee openw = theModule->getOrInsertFunction(
-    "styio_file_open_write",
+  /* The runtime keeps one buffered handle per path open across writes (see
+     styio_file_acquire_write); the enclosing loop or program end releases it. */
+  llvm::FunctionCallee acquire_fn = theModule->getOrInsertFunction(
+    "styio_file_acquire_write",
     llvm::FunctionType::get(theBuilder->getInt64Ty(), {char_ptr}, false));
   llvm::FunctionCallee write_fn = theModule->getOrInsertFunction(
     "styio_file_write_cstr",
@@ -3573,12 +4249,10 @@ StyioToLLVM::toLLVMIR(SGResourceWriteToFile* node) {
       theBuilder->getVoidTy(),
       {theBuilder->getInt64Ty(), char_ptr},
       false));
-  llvm::FunctionCallee close_fn = theModule->getOrInsertFunction(
-    "styio_file_close",
-    llvm::FunctionType::get(theBuilder->getVoidTy(), {theBuilder->getInt64Ty()}, false));
 
   llvm::Value* path = node->path_expr->toLLVMIR(this);
-  llvm::Value* h = theBuilder->CreateCall(openw, {path});
+  /* Build the whole line before acquiring: writes inside the data expression may
+     evict this path's cached handle, and a runtime-error bail-out should not open it. */
   llvm::Value* data = node->data_expr->toLLVMIR(this);
   if (node->promote_data_to_cstr || !data->getType()->isPointerTy()) {
     data = promote_to_cstr(data);
@@ -3593,9 +4267,12 @@ StyioToLLVM::toLLVMIR(SGResourceWriteToFile* node) {
     data = with_nl;
     track_owned_cstr_temp(data);
   }
+  llvm::Value* h = theBuilder->CreateCall(acquire_fn, {path});
+  if (!loop_stack_.empty()) {
+    loop_stack_.back().writes_files = true;
+  }
   theBuilder->CreateCall(write_fn, {h, data});
   free_owned_cstr_temp_if_tracked(data);
-  theBuilder->CreateCall(close_fn, {h});
   return theBuilder->getInt64(0);
 }
 
@@ -276,7 +276,7 @@ StyioToLLVM::toLLVMIR(SIOStdStreamWrite* node) {
         cstr = theBuilder->CreateCall(i64_cstr_fn, {as_i64});
       }
 
-      /* styio_stderr_write_cstr appends \n and flushes. */
+      /* styio_stderr_write_cstr appends \n and flushes per the runtime output policy. */
       theBuilder->CreateCall(stderr_fn, {cstr});
       if (v->getType()->isPointerTy()) {
         free_owned_cstr_temp_if_tracked(v);
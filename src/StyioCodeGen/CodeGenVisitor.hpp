@@ -3,6 +3,7 @@
 #define STYIO_CODE_GEN_VISITOR_H_
 
 // [STL]
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -29,6 +30,7 @@
 #include "llvm/Passes/PassBuilder.h"                 /* PassBuilder */
 #include "llvm/Passes/StandardInstrumentations.h"    /* StandardInstrumentations.h */
 #include "llvm/Support/TargetSelect.h"               /* InitializeNativeTarget, InitializeNativeTargetAsmPrinter, InitializeNativeTargetAsmParser */
+#include "llvm/Target/TargetMachine.h"               /* TargetMachine */
 #include "llvm/Transforms/InstCombine/InstCombine.h" /* InstCombinePass */
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Scalar/GVN.h"         /* GVNPass */
@@ -130,6 +132,10 @@ using StyioCodeGenVisitor = CodeGenVisitor<
 
   class SGHandleAcquire,
   class SGFileLineIter,
+  class SGCsvIter,
+  class SGCsvField,
+  class SGColumnarIter,
+  class SGColumnarWrite,
   class SGStreamZip,
   class SGSnapshotDecl,
   class SGSnapshotShadowLoad,
@@ -160,6 +166,22 @@ using StyioCodeGenVisitor = CodeGenVisitor<
   class SIOPrint,
   class SIORead>;
 
+/* A module loaded into the JIT: code lives until `tracker` is removed. */
+struct StyioJITProgram
+{
+  llvm::orc::ResourceTrackerSP tracker;
+  int (*entry)() = nullptr;
+};
+
+/* Accumulated cost of one LLVM pass or analysis over optimize_module (exclusive of nested passes). */
+struct StyioPassTiming
+{
+  std::string name;
+  bool analysis = false;
+  unsigned runs = 0;
+  std::uint64_t wall_us = 0;
+};
+
 class StyioToLLVM : public StyioCodeGenVisitor
 {
   unique_ptr<llvm::LLVMContext> theContext;
@@ -167,6 +189,8 @@ class StyioToLLVM : public StyioCodeGenVisitor
   unique_ptr<llvm::IRBuilder<>> theBuilder;
 
   std::unique_ptr<StyioJIT_ORC> theORCJIT;
+  /* Same CPU/features as the JIT's compiler, so the optimizer sees the real target (vector widths, costs). */
+  unique_ptr<llvm::TargetMachine> theTargetMachine;
 
   unique_ptr<llvm::FunctionPassManager> theFPM;
   unique_ptr<llvm::LoopAnalysisManager> theLAM;
@@ -189,23 +213,51 @@ class StyioToLLVM : public StyioCodeGenVisitor
   struct LoopFrame {
     llvm::BasicBlock* break_dest = nullptr;
     llvm::BasicBlock* continue_dest = nullptr;
+    /* A `<< @file{...}` inside: the outermost such loop releases the cached write handles. */
+    bool writes_files = false;
   };
   std::vector<LoopFrame> loop_stack_;
 
+  /* Open `#(row: csv)` loops by row name: current row index and the batch's column arrays. */
+  struct CsvRowFrame {
+    llvm::Value* index = nullptr;
+    std::vector<llvm::Value*> columns;
+  };
+  std::unordered_map<std::string, CsvRowFrame> csv_rows_;
+
+  /* --time-report: open pass frames and per-pass totals, plus the last load_program cost. */
+  struct PassTimingFrame {
+    size_t slot = 0;
+    std::chrono::steady_clock::time_point started;
+    std::uint64_t nested_us = 0;
+  };
+  std::vector<PassTimingFrame> pass_timing_stack_;
+  std::vector<StyioPassTiming> pass_timings_;
+  std::unordered_map<std::string, size_t> pass_timing_slots_;
+  std::uint64_t jit_materialize_us_ = 0;
+
+  void begin_pass_timing(llvm::StringRef name, bool analysis);
+  void end_pass_timing();
+
 public:
   StyioToLLVM(std::unique_ptr<StyioJIT_ORC> styio_jit) :
       theContext(std::make_unique<llvm::LLVMContext>()),
       theModule(std::make_unique<llvm::Module>("styio", *theContext)),
       theBuilder(std::make_unique<llvm::IRBuilder<>>(*theContext)),
       theORCJIT(std::move(styio_jit)),
+      theTargetMachine(create_target_machine(*theORCJIT)),
       theFPM(std::make_unique<llvm::FunctionPassManager>()),
       theLAM(std::make_unique<llvm::LoopAnalysisManager>()),
       theFAM(std::make_unique<llvm::FunctionAnalysisManager>()),
       theCGAM(std::make_unique<llvm::CGSCCAnalysisManager>()),
       theMAM(std::make_unique<llvm::ModuleAnalysisManager>()),
       thePIC(std::make_unique<llvm::PassInstrumentationCallbacks>()),
-      theSI(std::make_unique<llvm::StandardInstrumentations>(*theContext, /*DebugLogging*/ true)) {
+      theSI(std::make_unique<llvm::StandardInstrumentations>(*theContext, /*DebugLogging*/ false)),
+      thePB(theTargetMachine.get(), llvm::PipelineTuningOptions(), std::nullopt, thePIC.get()) {
     theModule->setDataLayout(theORCJIT->getDataLayout());
+    if (theTargetMachine) {
+      theModule->setTargetTriple(theTargetMachine->getTargetTriple().str());
+    }
 
     theSI->registerCallbacks(*thePIC, theMAM.get());
 
@@ -220,19 +272,72 @@ public:
     theFPM->addPass(llvm::SimplifyCFGPass());
 
     thePB.registerModuleAnalyses(*theMAM);
+    thePB.registerCGSCCAnalyses(*theCGAM);
     thePB.registerFunctionAnalyses(*theFAM);
+    thePB.registerLoopAnalyses(*theLAM);
     thePB.crossRegisterProxies(*theLAM, *theFAM, *theCGAM, *theMAM);
   }
 
   ~StyioToLLVM() {}
 
+  static unique_ptr<llvm::TargetMachine> create_target_machine(StyioJIT_ORC& jit) {
+    auto tm = jit.createTargetMachine();
+    if (!tm) {
+      /* Optimization then runs without target info; the JIT reports real target errors itself. */
+      llvm::consumeError(tm.takeError());
+      return nullptr;
+    }
+    return std::move(*tm);
+  }
+
   static StyioToLLVM* Create(std::unique_ptr<StyioJIT_ORC> styio_jit) {
     return new StyioToLLVM(std::move(styio_jit));
   }
 
   void print_llvm_ir();
+
+  /** Load the module into the JIT and run `main` once (the CLI path). */
   void execute();
 
+  /**
+   * Verify the module, hand it to the JIT under a fresh resource tracker and resolve `main`
+   * without calling it. Consumes the module; the JIT stays owned by the generator.
+   */
+  llvm::Expected<StyioJITProgram> load_program();
+
+  /** Transfer JIT ownership, so a loaded program can outlive the generator. */
+  std::unique_ptr<StyioJIT_ORC> release_jit();
+
+  /**
+   * Run PassBuilder's per-module default pipeline (O1..O3) over the module; 0 is a no-op.
+   * Embedded runtime helper bodies are linked in first so the inliner can see through them.
+   */
+  void optimize_module(unsigned opt_level);
+
+  /** Link used helpers from the embedded runtime bitcode as available_externally; returns how many. */
+  size_t link_inline_runtime();
+
+  /** Time every pass and analysis optimize_module runs from now on (see pass_timings()). */
+  void enable_pass_timing();
+
+  /** Per-pass totals in first-run order; empty unless enable_pass_timing() was called. */
+  const std::vector<StyioPassTiming>& pass_timings() const {
+    return pass_timings_;
+  }
+
+  /** Wall time the last load_program() spent adding the module and resolving `main`. */
+  std::uint64_t jit_materialize_us() const {
+    return jit_materialize_us_;
+  }
+
+  /**
+   * AOT: write the module as a native PIC object file for the JIT's target. The program's
+   * `main` is renamed and wrapped by a `main` that returns styio_runtime_report_exit(), so the
+   * object links against the static styio_runtime library into a standalone executable.
+   * The module is consumed for JIT purposes afterwards.
+   */
+  bool emit_object_file(const std::string& path, std::string& error_message);
+
   /** Module IR without ANSI or extra banners (for golden tests). */
   std::string dump_llvm_ir() const;
 
@@ -290,6 +395,10 @@ public:
 
   llvm::Type* toLLVMType(SGHandleAcquire* node);
   llvm::Type* toLLVMType(SGFileLineIter* node);
+  llvm::Type* toLLVMType(SGCsvIter* node);
+  llvm::Type* toLLVMType(SGCsvField* node);
+  llvm::Type* toLLVMType(SGColumnarIter* node);
+  llvm::Type* toLLVMType(SGColumnarWrite* node);
   llvm::Type* toLLVMType(SGStreamZip* node);
   llvm::Type* toLLVMType(SGSnapshotDecl* node);
   llvm::Type* toLLVMType(SGSnapshotShadowLoad* node);
@@ -378,6 +487,10 @@ public:
 
   llvm::Value* toLLVMIR(SGHandleAcquire* node);
   llvm::Value* toLLVMIR(SGFileLineIter* node);
+  llvm::Value* toLLVMIR(SGCsvIter* node);
+  llvm::Value* toLLVMIR(SGCsvField* node);
+  llvm::Value* toLLVMIR(SGColumnarIter* node);
+  llvm::Value* toLLVMIR(SGColumnarWrite* node);
   llvm::Value* toLLVMIR(SGStreamZip* node);
   llvm::Value* toLLVMIR(SGSnapshotDecl* node);
   llvm::Value* toLLVMIR(SGSnapshotShadowLoad* node);
@@ -419,13 +532,28 @@ private:
   llvm::Value* coerce_for_return(llvm::Value* v, llvm::Type* want_ty);
   llvm::Value* truncate_for_main_ret(llvm::Value* v);
   llvm::Value* default_runtime_return_value(llvm::Type* ret_ty);
+  llvm::Value* call_in_entry_block(llvm::Function* fn, llvm::FunctionCallee callee, const char* name);
+  llvm::Value* runtime_error_word(llvm::Function* fn);
+  llvm::Value* list_epoch_word(llvm::Function* fn);
+  llvm::Value* literal_dict_key_id(StyioIR* key);
+  void emit_interned_key_init(llvm::Function* main_func);
   void emit_runtime_error_guard_return();
+  void pop_loop_frame();
   llvm::Value* cstr_to_i64_checked(llvm::Value* v);
   llvm::Value* cstr_to_f64_checked(llvm::Value* v);
+  void fuse_numeric_line_read(llvm::CallInst* read_call);
 
   llvm::Value* promote_to_cstr(llvm::Value* v);
   llvm::Value* evaluate_arm_block_value(SGBlock* b, bool mixed_phi);
 
+  /* styio_runtime_error_word() result, fetched once in each function's entry block. */
+  std::unordered_map<llvm::Function*, llvm::Value*> runtime_error_words_;
+  /* styio_list_epoch_word() result, fetched the same way by raw list loops. */
+  std::unordered_map<llvm::Function*, llvm::Value*> list_epoch_words_;
+  /* Literal dict keys in first-use order, each with the global its styio_key_intern id lands in. */
+  std::vector<std::pair<std::string, llvm::GlobalVariable*>> interned_keys_;
+  std::unordered_map<std::string, size_t> interned_key_index_;
+
   std::vector<std::vector<std::string>> file_handle_scope_stack_;
   std::vector<std::vector<llvm::AllocaInst*>> cstr_slot_scope_stack_;
   std::vector<std::vector<llvm::AllocaInst*>> dynamic_slot_scope_stack_;
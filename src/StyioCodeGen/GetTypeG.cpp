@@ -335,6 +335,35 @@ StyioToLLVM::toLLVMType(SGFileLineIter* node) {
   return theBuilder->getVoidTy();
 }
 
+llvm::Type*
+StyioToLLVM::toLLVMType(SGCsvIter* node) {
+  (void)node;
+  return theBuilder->getVoidTy();
+}
+
+llvm::Type*
+StyioToLLVM::toLLVMType(SGCsvField* node) {
+  if (node->type == "i64") {
+    return theBuilder->getInt64Ty();
+  }
+  if (node->type == "f64") {
+    return theBuilder->getDoubleTy();
+  }
+  return llvm::PointerType::get(*theContext, 0);
+}
+
+llvm::Type*
+StyioToLLVM::toLLVMType(SGColumnarIter* node) {
+  (void)node;
+  return theBuilder->getVoidTy();
+}
+
+llvm::Type*
+StyioToLLVM::toLLVMType(SGColumnarWrite* node) {
+  (void)node;
+  return theBuilder->getVoidTy();
+}
+
 llvm::Type*
 StyioToLLVM::toLLVMType(SGStreamZip* node) {
   (void)node;
@@ -53,4 +53,8 @@
 #define STYIO_NANO_ENABLE_DICT_BACKEND_LINEAR 1
 #endif
 
+#ifndef STYIO_NANO_ENABLE_DICT_BACKEND_FLAT_HASH
+#define STYIO_NANO_ENABLE_DICT_BACKEND_FLAT_HASH 1
+#endif
+
 #endif  // STYIO_CONFIG_NANO_PROFILE_HPP
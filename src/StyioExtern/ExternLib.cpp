@@ -1,11 +1,19 @@
+#include <charconv>
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <cstdint>
 #include <cctype>
 #include <cerrno>
+#include <chrono>
+#include <deque>
 #include <filesystem>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -13,16 +21,28 @@
 
 #include "ExternLib.hpp"
 #include "StyioConfig/NanoProfile.hpp"
+#include "StyioRuntime/ColumnarFile.hpp"
+#include "StyioRuntime/CsvReader.hpp"
+#include "StyioRuntime/Decompress.hpp"
+#include "StyioRuntime/FlatIndex.hpp"
 #include "StyioRuntime/HandleTable.hpp"
+#include "StyioRuntime/LineReader.hpp"
+#include "StyioRuntime/ReadAhead.hpp"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace {
 
-/* Alternating buffers so two consecutive reads (e.g. zip of two files) keep both lines valid. */
-thread_local char g_read_line_bufs[2][65536];
-thread_local int g_read_line_buf_which = 0;
 thread_local StyioHandleTable g_handle_table;
+/* `@stdin` line iteration and the whole-stdin list readers share this buffer. */
+thread_local StyioLineReader g_stdin_reader;
 thread_local std::unordered_set<const void*> g_owned_cstr_ptrs;
-thread_local bool g_runtime_error = false;
+/* An int32 so JIT code can test it in place through styio_runtime_error_word(). */
+thread_local int32_t g_runtime_error = 0;
 thread_local std::string g_runtime_error_message;
 thread_local std::string g_runtime_error_subcode;
 thread_local StyioRuntimeLogSink g_runtime_log_sink = nullptr;
@@ -31,6 +51,7 @@ constexpr const char* kRuntimeSubcodeInvalidFileHandle = "STYIO_RUNTIME_INVALID_
 constexpr const char* kRuntimeSubcodeFilePathNull = "STYIO_RUNTIME_FILE_PATH_NULL";
 constexpr const char* kRuntimeSubcodeFileOpenRead = "STYIO_RUNTIME_FILE_OPEN_READ";
 constexpr const char* kRuntimeSubcodeFileOpenWrite = "STYIO_RUNTIME_FILE_OPEN_WRITE";
+constexpr const char* kRuntimeSubcodeFileCodec = "STYIO_RUNTIME_FILE_CODEC";
 constexpr const char* kRuntimeSubcodeInvalidListHandle = "STYIO_RUNTIME_INVALID_LIST_HANDLE";
 constexpr const char* kRuntimeSubcodeInvalidDictHandle = "STYIO_RUNTIME_INVALID_DICT_HANDLE";
 constexpr const char* kRuntimeSubcodeListParse = "STYIO_RUNTIME_LIST_PARSE";
@@ -38,6 +59,9 @@ constexpr const char* kRuntimeSubcodeListIndex = "STYIO_RUNTIME_LIST_INDEX";
 constexpr const char* kRuntimeSubcodeListElemKind = "STYIO_RUNTIME_LIST_ELEM_KIND";
 constexpr const char* kRuntimeSubcodeDictKey = "STYIO_RUNTIME_DICT_KEY";
 constexpr const char* kRuntimeSubcodeNumericParse = "STYIO_RUNTIME_NUMERIC_PARSE";
+constexpr const char* kRuntimeSubcodeCsvColumn = "STYIO_RUNTIME_CSV_COLUMN";
+constexpr const char* kRuntimeSubcodeColumnarFormat = "STYIO_RUNTIME_COLUMNAR_FORMAT";
+constexpr const char* kRuntimeSubcodeColumnarSchema = "STYIO_RUNTIME_COLUMNAR_SCHEMA";
 
 enum class StyioListElemKind : std::uint8_t
 {
@@ -124,10 +148,17 @@ enum class StyioDictValueKind : std::uint8_t
   DictHandle = 5,
 };
 
+enum class StyioDictKeyKind : std::uint8_t
+{
+  String = 0,
+  I64 = 1,
+};
+
 enum class StyioDictRuntimeImpl : std::uint8_t
 {
   OrderedHash = 0,
   Linear = 1,
+  FlatHash = 2,
 };
 
 struct StyioDictBackendSpec
@@ -144,6 +175,9 @@ constexpr StyioDictBackendSpec kStyioDictBackendRegistry[] = {
 #if STYIO_NANO_ENABLE_DICT_BACKEND_LINEAR
   {StyioDictRuntimeImpl::Linear, "linear", {"v1", nullptr, nullptr}},
 #endif
+#if STYIO_NANO_ENABLE_DICT_BACKEND_FLAT_HASH
+  {StyioDictRuntimeImpl::FlatHash, "flat-hash", {"flat_hash", "swiss", "v3"}},
+#endif
 };
 
 constexpr int kStyioDictBackendRegistryCount =
@@ -152,28 +186,103 @@ static_assert(kStyioDictBackendRegistryCount > 0, "styio dict registry must expo
 
 struct StyioDictBase
 {
-  explicit StyioDictBase(StyioDictValueKind kind, StyioDictRuntimeImpl impl) :
+  StyioDictBase(StyioDictKeyKind key, StyioDictValueKind kind, StyioDictRuntimeImpl impl) :
+      key_kind(key),
       value_kind(kind),
       runtime_impl(impl) {
   }
 
   virtual ~StyioDictBase() = default;
 
+  StyioDictKeyKind key_kind;
   StyioDictValueKind value_kind;
   StyioDictRuntimeImpl runtime_impl;
 };
 
-template <typename T, StyioDictValueKind Kind>
+/*
+  A dict key as the lookup helpers see it. Keys interned by generated code
+  (styio_key_intern) arrive with their hash, so neither hash backend rehashes them.
+*/
+struct StyioDictKey
+{
+  std::string_view text;
+  uint64_t hash = 0;
+  bool hashed = false;
+
+  uint64_t key_hash() const {
+    return hashed ? hash : StyioFlatIndex::hash_key(text);
+  }
+};
+
+/* Transparent, so `index_by_key` is probed with a StyioDictKey instead of a std::string temporary. */
+struct StyioDictKeyHash
+{
+  using is_transparent = void;
+
+  size_t operator()(std::string_view text) const {
+    return static_cast<size_t>(StyioFlatIndex::hash_key(text));
+  }
+
+  size_t operator()(const StyioDictKey& key) const {
+    return static_cast<size_t>(key.key_hash());
+  }
+};
+
+struct StyioDictKeyEqual
+{
+  using is_transparent = void;
+
+  bool operator()(std::string_view a, std::string_view b) const {
+    return a == b;
+  }
+
+  bool operator()(const StyioDictKey& a, std::string_view b) const {
+    return a.text == b;
+  }
+
+  bool operator()(std::string_view a, const StyioDictKey& b) const {
+    return a == b.text;
+  }
+};
+
+/* Per key type: the OrderedHash index and the key the lookup helpers are handed. */
+template <typename K>
+struct StyioDictKeyTraits;
+
+template <>
+struct StyioDictKeyTraits<std::string>
+{
+  static constexpr StyioDictKeyKind kind = StyioDictKeyKind::String;
+  using index_map = std::unordered_map<std::string, size_t, StyioDictKeyHash, StyioDictKeyEqual>;
+  using lookup_key = StyioDictKey;
+};
+
+template <>
+struct StyioDictKeyTraits<int64_t>
+{
+  static constexpr StyioDictKeyKind kind = StyioDictKeyKind::I64;
+  using index_map = std::unordered_map<int64_t, size_t>;
+  using lookup_key = int64_t;
+};
+
+template <typename T, StyioDictValueKind Kind, typename K = std::string>
 struct StyioDictStorage : public StyioDictBase
 {
+  using key_type = K;
   using mapped_type = T;
+  using lookup_key = typename StyioDictKeyTraits<K>::lookup_key;
+  static constexpr StyioDictKeyKind kKeyKind = StyioDictKeyTraits<K>::kind;
+  static constexpr StyioDictValueKind kValueKind = Kind;
 
   explicit StyioDictStorage(StyioDictRuntimeImpl impl = StyioDictRuntimeImpl::OrderedHash) :
-      StyioDictBase(Kind, impl) {
+      StyioDictBase(kKeyKind, Kind, impl) {
   }
 
-  std::vector<std::pair<std::string, T>> entries;
-  std::unordered_map<std::string, size_t> index_by_key;
+  std::vector<std::pair<K, T>> entries;
+  /* OrderedHash: key -> position in `entries` (a second copy of each key). */
+  typename StyioDictKeyTraits<K>::index_map index_by_key;
+  /* FlatHash: hash -> position in `entries`; the key is only stored in the entry. */
+  StyioFlatIndex flat_index;
 };
 
 using StyioDictBool = StyioDictStorage<int64_t, StyioDictValueKind::Bool>;
@@ -183,10 +292,136 @@ using StyioDictString = StyioDictStorage<std::string, StyioDictValueKind::String
 using StyioDictListHandle = StyioDictStorage<int64_t, StyioDictValueKind::ListHandle>;
 using StyioDictDictHandle = StyioDictStorage<int64_t, StyioDictValueKind::DictHandle>;
 
+/* dict[i64, V]: keys stay machine integers end to end, with no string formatting or compare. */
+using StyioIntDictBool = StyioDictStorage<int64_t, StyioDictValueKind::Bool, int64_t>;
+using StyioIntDictI64 = StyioDictStorage<int64_t, StyioDictValueKind::I64, int64_t>;
+using StyioIntDictF64 = StyioDictStorage<double, StyioDictValueKind::F64, int64_t>;
+using StyioIntDictString = StyioDictStorage<std::string, StyioDictValueKind::String, int64_t>;
+using StyioIntDictListHandle = StyioDictStorage<int64_t, StyioDictValueKind::ListHandle, int64_t>;
+using StyioIntDictDictHandle = StyioDictStorage<int64_t, StyioDictValueKind::DictHandle, int64_t>;
+
+/* Key hooks that let the backend routines below serve both key types. */
+uint64_t
+dict_key_hash(const StyioDictKey& key) {
+  return key.key_hash();
+}
+
+uint64_t
+dict_key_hash(std::string_view key) {
+  return StyioFlatIndex::hash_key(key);
+}
+
+uint64_t
+dict_key_hash(int64_t key) {
+  return StyioFlatIndex::hash_key(key);
+}
+
+bool
+dict_key_matches(const std::string& stored, const StyioDictKey& key) {
+  return stored == key.text;
+}
+
+bool
+dict_key_matches(int64_t stored, int64_t key) {
+  return stored == key;
+}
+
+std::string
+dict_key_owned(const StyioDictKey& key) {
+  return std::string(key.text);
+}
+
+int64_t
+dict_key_owned(int64_t key) {
+  return key;
+}
+
+std::string
+dict_key_text(const StyioDictKey& key) {
+  return std::string(key.text);
+}
+
+std::string
+dict_key_text(int64_t key) {
+  return std::to_string(static_cast<long long>(key));
+}
+
+/* Keys interned through styio_key_intern; key id = index + 1. A deque, so `text` never moves. */
+struct StyioInternedKey
+{
+  std::string text;
+  uint64_t hash;
+};
+
+thread_local std::deque<StyioInternedKey> g_interned_keys;
+thread_local StyioFlatIndex g_interned_key_index;
+
 thread_local int64_t g_active_list_handles = 0;
+/* Bumped whenever list storage may move or go away; see styio_list_epoch_word(). */
+thread_local uint64_t g_list_epoch = 0;
 thread_local int64_t g_active_dict_handles = 0;
 thread_local StyioDictRuntimeImpl g_default_dict_runtime_impl = StyioDictRuntimeImpl::OrderedHash;
 
+/* Payload of HandleKind::File. Each handle reads lines through its own block reader, so a
+   zip over two files keeps both current lines valid. */
+struct StyioFileStream
+{
+  FILE* file = nullptr;
+  StyioLineReader reader;
+  /* Set for read handles on regular files of at least kReadAheadMinBytes. */
+  std::unique_ptr<StyioReadAhead> read_ahead;
+  /* Set for gzip/zstd inputs opened through styio_file_open_auto; reads `file`. */
+  std::unique_ptr<StyioDecompressor> decoder;
+};
+
+/*
+  Payload of HandleKind::MappedFile: a regular file mapped read-only with sequential
+  read-ahead advice. Lines are located with memchr in the mapping itself; since the C
+  ABI hands out NUL-terminated strings, each line is copied once into `line` (there is
+  no read(2) copy and no block buffer). Rewind is `pos = 0`.
+*/
+struct StyioMappedFile
+{
+  const char* data = nullptr;
+  size_t size = 0;
+  size_t pos = 0;
+  std::string line;
+};
+
+/* Payload of HandleKind::Csv. The reader pulls blocks from `file`, a read handle from
+   styio_file_open, so CSV sources get the same mapping and read-ahead as line loops. */
+struct StyioCsvSource
+{
+  int64_t file = 0;
+  StyioCsvReader reader;
+};
+
+/* Payload of HandleKind::Columnar. `image` is the mapped file (or a heap copy where it
+   cannot be mapped); `bound[i]` is the file column read as loop parameter i. */
+struct StyioColumnarSource
+{
+  const void* image = nullptr;
+  size_t size = 0;
+  bool mapped = false;
+  std::vector<uint64_t> heap;
+  StyioColumnarReader reader;
+  std::vector<size_t> bound;
+};
+
+/* Payload of HandleKind::ColumnarWriter; the file is written when the handle is released. */
+struct StyioColumnarSink
+{
+  std::string path;
+  /* The spec the writer was created from; every later acquire must pass the same one. */
+  std::string columns;
+  StyioColumnarWriter writer;
+};
+
+void close_file(void* raw);
+void close_mapped_file(void* raw);
+void close_csv(void* raw);
+void close_columnar(void* raw);
+void close_columnar_writer(void* raw);
 void close_list(void* raw);
 void close_dict(void* raw);
 int64_t clone_list_handle_value(int64_t h);
@@ -194,17 +429,118 @@ int64_t clone_dict_handle_value(int64_t h);
 void append_list_handle_repr(std::string& out, int64_t h);
 void append_dict_handle_repr(std::string& out, int64_t h);
 
+void
+release_all_handles() {
+  g_handle_table.release_all(
+    StyioHandleTable::HandleKind::File,
+    [](void* raw) { close_file(raw); });
+  g_handle_table.release_all(
+    StyioHandleTable::HandleKind::MappedFile,
+    [](void* raw) { close_mapped_file(raw); });
+  /* After File / MappedFile: close_csv must not erase entries release_all is walking. */
+  g_handle_table.release_all(
+    StyioHandleTable::HandleKind::Csv,
+    [](void* raw) { close_csv(raw); });
+  g_handle_table.release_all(
+    StyioHandleTable::HandleKind::Columnar,
+    [](void* raw) { close_columnar(raw); });
+  g_handle_table.release_all(
+    StyioHandleTable::HandleKind::ColumnarWriter,
+    [](void* raw) { close_columnar_writer(raw); });
+  g_handle_table.release_all(
+    StyioHandleTable::HandleKind::List,
+    [](void* raw) { close_list(raw); });
+  g_handle_table.release_all(
+    StyioHandleTable::HandleKind::Dict,
+    [](void* raw) { close_dict(raw); });
+}
+
+/*
+  `<< @file{...}` write handles, one per distinct path, acquired by the first write and
+  kept open (with a large stdio buffer) until styio_file_release_writes(): codegen emits
+  that at the exit of the outermost loop containing a write, and the driver / AOT entry
+  at program end. Files are opened in append mode, so keeping the handle open writes
+  the same bytes as the former open-write-close per record.
+*/
+constexpr size_t kWriteHandleBufferBytes = 256u << 10;
+constexpr size_t kWriteHandleCacheMaxPaths = 32;
+
+struct WriteHandleCache
+{
+  struct Entry
+  {
+    int64_t handle = 0;
+    /* Outlives the FILE: release() closes the handle before the entry is erased. */
+    std::unique_ptr<char[]> buffer;
+  };
+
+  std::unordered_map<std::string, Entry> entries;
+  /* Loops write to one path over and over; skip the hash lookup for a repeat. */
+  std::string last_path;
+  int64_t last_handle = 0;
+
+  void flush() {
+    for (auto& [path, entry] : entries) {
+      auto* stream = g_handle_table.lookup_as<StyioFileStream>(entry.handle, StyioHandleTable::HandleKind::File);
+      if (stream != nullptr) {
+        std::fflush(stream->file);
+      }
+    }
+  }
+
+  void release() {
+    for (auto& [path, entry] : entries) {
+      (void)g_handle_table.release(entry.handle, StyioHandleTable::HandleKind::File, close_file);
+    }
+    entries.clear();
+    last_path.clear();
+    last_handle = 0;
+  }
+
+  ~WriteHandleCache() {
+    release();
+  }
+};
+
+thread_local WriteHandleCache g_write_handle_cache;
+
+/*
+  `<< @col{...}` writers, one per path, released together with the text write handles.
+  Releasing a writer writes its file, so a later `@col{...}` read of the same path (or
+  the next stage) sees every row written so far.
+*/
+struct ColumnarWriteCache
+{
+  std::unordered_map<std::string, int64_t> entries;
+
+  void release() {
+    for (auto& [path, handle] : entries) {
+      (void)g_handle_table.release(handle, StyioHandleTable::HandleKind::ColumnarWriter, close_columnar_writer);
+    }
+    entries.clear();
+  }
+
+  void release_path(const std::string& path) {
+    auto it = entries.find(path);
+    if (it == entries.end()) {
+      return;
+    }
+    (void)g_handle_table.release(it->second, StyioHandleTable::HandleKind::ColumnarWriter, close_columnar_writer);
+    entries.erase(it);
+  }
+
+  ~ColumnarWriteCache() {
+    release();
+  }
+};
+
+thread_local ColumnarWriteCache g_columnar_write_cache;
+
 thread_local struct HandleTableCleanup {
   ~HandleTableCleanup() {
-    g_handle_table.release_all(
-      StyioHandleTable::HandleKind::File,
-      [](void* raw) { std::fclose(static_cast<FILE*>(raw)); });
-    g_handle_table.release_all(
-      StyioHandleTable::HandleKind::List,
-      [](void* raw) { close_list(raw); });
-    g_handle_table.release_all(
-      StyioHandleTable::HandleKind::Dict,
-      [](void* raw) { close_dict(raw); });
+    g_write_handle_cache.release();
+    g_columnar_write_cache.release();
+    release_all_handles();
   }
 } g_handle_table_cleanup;
 
@@ -300,9 +636,156 @@ resolve_read_path(const char* path) {
   return p;
 }
 
+/*
+  Output flush policy for styio_stdout_write_cstr / styio_stderr_write_cstr. Lines go
+  through the stdio FILE buffers, so they stay ordered with the printf/puts calls
+  generated code makes for `>_`; the policy only decides when to fflush:
+
+    line            after every line (default, interactive)
+    block:<bytes>   once <bytes> are pending; the FILE buffer is resized to match
+    interval:<ms>   on the first write at least <ms> after the previous flush, and
+                    before any stdin read, so a prompt is out before input blocks
+    exit            only on runtime error, reset and program exit
+
+  Process-wide, like the streams themselves.
+*/
+enum class OutputFlushMode
+{
+  Line,
+  Block,
+  Interval,
+  Exit,
+};
+
+struct OutputStreamState
+{
+  size_t pending = 0;
+  std::chrono::steady_clock::time_point last_flush = std::chrono::steady_clock::now();
+  /* Handed to setvbuf and never freed: stdio flushes streams after static destructors run. */
+  char* buffer = nullptr;
+  size_t buffer_size = 0;
+};
+
+constexpr size_t kOutputFlushDefaultBufferBytes = 1u << 20;
+constexpr size_t kOutputFlushMaxBufferBytes = 64u << 20;
+
+std::mutex g_output_mutex;
+OutputFlushMode g_output_flush_mode = OutputFlushMode::Line;
+size_t g_output_flush_block_bytes = 0;
+std::chrono::milliseconds g_output_flush_interval{0};
+OutputStreamState g_stdout_state;
+OutputStreamState g_stderr_state;
+
+void
+resize_output_buffer(std::FILE* out, OutputStreamState& state, size_t bytes) {
+  if (state.buffer_size == bytes) {
+    return;
+  }
+  std::fflush(out);
+  char* buffer = new char[bytes];
+  /* glibc and Apple libc accept setvbuf on a stream that has been used once it is flushed. */
+  if (std::setvbuf(out, buffer, _IOFBF, bytes) != 0) {
+    delete[] buffer;
+    return;
+  }
+  delete[] state.buffer;
+  state.buffer = buffer;
+  state.buffer_size = bytes;
+}
+
+void
+flush_output_locked() {
+  std::fflush(stdout);
+  std::fflush(stderr);
+  const auto now = std::chrono::steady_clock::now();
+  g_stdout_state.pending = 0;
+  g_stdout_state.last_flush = now;
+  g_stderr_state.pending = 0;
+  g_stderr_state.last_flush = now;
+}
+
+void
+flush_output() {
+  std::lock_guard<std::mutex> lock(g_output_mutex);
+  flush_output_locked();
+}
+
+void
+write_output_line(std::FILE* out, OutputStreamState& state, const char* s) {
+  std::lock_guard<std::mutex> lock(g_output_mutex);
+  const size_t n = std::strlen(s);
+  std::fwrite(s, 1, n, out);
+  std::fputc('\n', out);
+  switch (g_output_flush_mode) {
+    case OutputFlushMode::Line:
+      std::fflush(out);
+      break;
+    case OutputFlushMode::Block:
+      state.pending += n + 1;
+      if (state.pending >= g_output_flush_block_bytes) {
+        std::fflush(out);
+        state.pending = 0;
+      }
+      break;
+    case OutputFlushMode::Interval: {
+      state.pending += n + 1;
+      const auto now = std::chrono::steady_clock::now();
+      if (now - state.last_flush >= g_output_flush_interval) {
+        std::fflush(out);
+        state.pending = 0;
+        state.last_flush = now;
+      }
+      break;
+    }
+    case OutputFlushMode::Exit:
+      break;
+  }
+}
+
+/* Interval mode holds lines until the next write; a stdin read that blocks would hold
+   them until input arrives, so whatever is pending goes out first. */
+void
+flush_output_before_stdin_read() {
+  std::lock_guard<std::mutex> lock(g_output_mutex);
+  if (g_output_flush_mode != OutputFlushMode::Interval) {
+    return;
+  }
+  const auto now = std::chrono::steady_clock::now();
+  if (g_stdout_state.pending > 0 || g_stderr_state.pending > 0
+      || now - g_stdout_state.last_flush >= g_output_flush_interval) {
+    flush_output_locked();
+  }
+}
+
+bool
+parse_output_flush_amount(const char* digits, size_t max_value, size_t& out) {
+  if (digits == nullptr || *digits == '\0') {
+    return false;
+  }
+  size_t value = 0;
+  for (const char* p = digits; *p != '\0'; ++p) {
+    if (!std::isdigit(static_cast<unsigned char>(*p))) {
+      return false;
+    }
+    value = value * 10 + static_cast<size_t>(*p - '0');
+    if (value > max_value) {
+      return false;
+    }
+  }
+  if (value == 0) {
+    return false;
+  }
+  out = value;
+  return true;
+}
+
 void
 set_runtime_error_once(const char* subcode, const std::string& message) {
-  g_runtime_error = true;
+  /* Whatever the program printed before failing must precede the driver's diagnostic. */
+  if (g_runtime_error == 0) {
+    flush_output();
+  }
+  g_runtime_error = 1;
   if (g_runtime_error_message.empty()) {
     g_runtime_error_message = message;
     g_runtime_error_subcode = (subcode != nullptr) ? subcode : "";
@@ -311,21 +794,32 @@ set_runtime_error_once(const char* subcode, const std::string& message) {
 
 int64_t
 stash_file(FILE* f) {
-  return g_handle_table.acquire(StyioHandleTable::HandleKind::File, f);
+  if (f == nullptr) {
+    return 0;
+  }
+  auto* stream = new StyioFileStream();
+  stream->file = f;
+  return g_handle_table.acquire(StyioHandleTable::HandleKind::File, stream);
 }
 
-FILE*
-as_file(int64_t h, bool diagnose_if_missing = false) {
+StyioFileStream*
+as_file_stream(int64_t h, bool diagnose_if_missing = false) {
   if (h == 0) {
     return nullptr;
   }
-  FILE* f = g_handle_table.lookup_as<FILE>(h, StyioHandleTable::HandleKind::File);
-  if (f == nullptr && diagnose_if_missing) {
+  auto* stream = g_handle_table.lookup_as<StyioFileStream>(h, StyioHandleTable::HandleKind::File);
+  if (stream == nullptr && diagnose_if_missing) {
     set_runtime_error_once(
       kRuntimeSubcodeInvalidFileHandle,
       "invalid file handle: " + std::to_string(static_cast<long long>(h)));
   }
-  return f;
+  return stream;
+}
+
+FILE*
+as_file(int64_t h, bool diagnose_if_missing = false) {
+  StyioFileStream* stream = as_file_stream(h, diagnose_if_missing);
+  return stream != nullptr ? stream->file : nullptr;
 }
 
 void
@@ -333,81 +827,523 @@ close_file(void* raw) {
   if (raw == nullptr) {
     return;
   }
-  std::fclose(static_cast<FILE*>(raw));
+  auto* stream = static_cast<StyioFileStream*>(raw);
+  /* Join the worker before its descriptor (and the decoder it may be running) go away. */
+  stream->read_ahead.reset();
+  stream->decoder.reset();
+  std::fclose(stream->file);
+  delete stream;
+}
+
+/* How styio_file_open reads: mapped for regular files of at least kMappedFileAutoMinBytes
+   (auto), always streamed, or mapped whenever the file can be mapped. Process-wide; the
+   driver sets it before running. Pipes, devices and empty files always stream. */
+enum class FileSourceMode
+{
+  Auto,
+  Stream,
+  Mapped,
+};
+
+constexpr size_t kMappedFileAutoMinBytes = size_t(4) << 20;
+FileSourceMode g_file_source_mode = FileSourceMode::Auto;
+
+void
+close_mapped_file(void* raw) {
+  if (raw == nullptr) {
+    return;
+  }
+  auto* mapped = static_cast<StyioMappedFile*>(raw);
+#ifndef _WIN32
+  ::munmap(const_cast<char*>(mapped->data), mapped->size);
+#endif
+  delete mapped;
 }
 
+/* Map `f` when the source mode allows it; on success the FILE is closed (the mapping
+   outlives the descriptor) and a MappedFile handle is returned, otherwise 0. */
 int64_t
-stash_list(StyioListBase* list) {
-  if (list == nullptr) {
+try_stash_mapped_file(FILE* f) {
+#ifdef _WIN32
+  (void)f;
+  return 0;
+#else
+  if (g_file_source_mode == FileSourceMode::Stream) {
     return 0;
   }
-  ++g_active_list_handles;
-  return g_handle_table.acquire(StyioHandleTable::HandleKind::List, list);
+  const int fd = fileno(f);
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+    return 0;
+  }
+  const size_t size = static_cast<size_t>(st.st_size);
+  if (g_file_source_mode == FileSourceMode::Auto && size < kMappedFileAutoMinBytes) {
+    return 0;
+  }
+  void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == MAP_FAILED) {
+    return 0;
+  }
+  (void)::madvise(data, size, MADV_SEQUENTIAL);
+  auto* mapped = new StyioMappedFile();
+  mapped->data = static_cast<const char*>(data);
+  mapped->size = size;
+  std::fclose(f);
+  return g_handle_table.acquire(StyioHandleTable::HandleKind::MappedFile, mapped);
+#endif
 }
 
-StyioListBase*
-as_list_base(int64_t h, bool diagnose_if_missing = false) {
-  if (h == 0) {
-    return nullptr;
-  }
-  auto* list = g_handle_table.lookup_as<StyioListBase>(h, StyioHandleTable::HandleKind::List);
-  if (list == nullptr && diagnose_if_missing) {
-    set_runtime_error_once(
-      kRuntimeSubcodeInvalidListHandle,
-      "invalid list handle: " + std::to_string(static_cast<long long>(h)));
+/* Smaller files are consumed in one or two reads; a worker thread would not pay off. */
+constexpr size_t kReadAheadMinBytes = StyioLineReader::kDefaultBlockBytes;
+
+size_t read_available(FILE* f, char* dst, size_t cap);
+
+/* Bytes of a stream handle before read-ahead: decompressed when it has a decoder. */
+size_t
+read_stream_source(StyioFileStream* stream, char* dst, size_t cap) {
+  if (stream->decoder) {
+    return stream->decoder->read(dst, cap);
   }
-  return list;
+  return read_available(stream->file, dst, cap);
 }
 
-StyioListI64*
-as_list_i64(int64_t h, bool diagnose_if_missing = false) {
-  StyioListBase* list = as_list_base(h, diagnose_if_missing);
-  if (list == nullptr) {
-    return nullptr;
+/*
+  Stash a read handle, with a read-ahead worker when the file is large enough. With a
+  `codec`, reads go through a decoder; the worker then inflates as well as reads, so
+  decompression overlaps the loop body too.
+*/
+int64_t
+stash_read_file(FILE* f, StyioDecompressor::Codec codec = StyioDecompressor::Codec::None) {
+  const int64_t h = stash_file(f);
+  if (h == 0) {
+    return 0;
   }
-  if (list->elem_kind != StyioListElemKind::I64) {
-    if (diagnose_if_missing) {
-      set_runtime_error_once(
-        kRuntimeSubcodeListElemKind,
-        "list handle does not carry i64 elements: " + std::to_string(static_cast<long long>(h)));
-    }
-    return nullptr;
+  auto* stream = g_handle_table.lookup_as<StyioFileStream>(h, StyioHandleTable::HandleKind::File);
+  if (codec != StyioDecompressor::Codec::None) {
+    stream->decoder = std::make_unique<StyioDecompressor>(
+      codec, [f](char* dst, size_t cap) { return read_available(f, dst, cap); });
   }
-  return static_cast<StyioListI64*>(list);
+#ifndef _WIN32
+  struct stat st;
+  if (::fstat(fileno(f), &st) == 0 && S_ISREG(st.st_mode)
+      && static_cast<size_t>(st.st_size) >= kReadAheadMinBytes) {
+    stream->read_ahead = std::make_unique<StyioReadAhead>(
+      [stream](char* dst, size_t cap) { return read_stream_source(stream, dst, cap); });
+  }
+#endif
+  return h;
+}
+
+/* Codec of a regular file from its magic bytes, read in place so the descriptor stays at 0. */
+StyioDecompressor::Codec
+sniff_file_codec(FILE* f) {
+#ifdef _WIN32
+  (void)f;
+  return StyioDecompressor::Codec::None;
+#else
+  unsigned char head[StyioDecompressor::kMagicBytes];
+  ssize_t got = -1;
+  do {
+    got = ::pread(fileno(f), head, sizeof(head), 0);
+  } while (got < 0 && errno == EINTR);
+  if (got <= 0) {
+    /* Pipes and devices cannot be peeked without consuming input; they stay raw. */
+    return StyioDecompressor::Codec::None;
+  }
+  return StyioDecompressor::detect(head, static_cast<size_t>(got));
+#endif
 }
 
-StyioListBool*
-as_list_bool(int64_t h, bool diagnose_if_missing = false) {
-  StyioListBase* list = as_list_base(h, diagnose_if_missing);
-  if (list == nullptr) {
-    return nullptr;
-  }
-  if (list->elem_kind != StyioListElemKind::Bool) {
-    if (diagnose_if_missing) {
-      set_runtime_error_once(
-        kRuntimeSubcodeListElemKind,
-        "list handle does not carry bool elements: " + std::to_string(static_cast<long long>(h)));
-    }
-    return nullptr;
+size_t
+fill_from_stream(StyioFileStream* stream, char* dst, size_t cap) {
+  const size_t got = stream->read_ahead ? stream->read_ahead->take(dst, cap) : read_stream_source(stream, dst, cap);
+  /* The decoder may run on the read-ahead worker; report its failure on this thread. */
+  if (got == 0 && stream->decoder && !stream->decoder->error().empty()) {
+    set_runtime_error_once(kRuntimeSubcodeFileCodec, stream->decoder->error());
   }
-  return static_cast<StyioListBool*>(list);
+  return got;
 }
 
-StyioListF64*
-as_list_f64(int64_t h, bool diagnose_if_missing = false) {
-  StyioListBase* list = as_list_base(h, diagnose_if_missing);
-  if (list == nullptr) {
+const char*
+mapped_read_line(StyioMappedFile* mapped) {
+  if (mapped->pos >= mapped->size) {
     return nullptr;
   }
-  if (list->elem_kind != StyioListElemKind::F64) {
-    if (diagnose_if_missing) {
-      set_runtime_error_once(
-        kRuntimeSubcodeListElemKind,
-        "list handle does not carry f64 elements: " + std::to_string(static_cast<long long>(h)));
+  const char* begin = mapped->data + mapped->pos;
+  const size_t rest = mapped->size - mapped->pos;
+  const auto* nl = static_cast<const char*>(std::memchr(begin, '\n', rest));
+  size_t len = nl != nullptr ? static_cast<size_t>(nl - begin) : rest;
+  mapped->pos += nl != nullptr ? len + 1 : len;
+  while (len > 0 && begin[len - 1] == '\r') {
+    --len;
+  }
+  mapped->line.assign(begin, len);
+  return mapped->line.c_str();
+}
+
+/* Line-reader fill: whatever the descriptor has, up to `cap` bytes. A plain read(2) returns
+   what a pipe or terminal holds instead of blocking for a full block like fread would. */
+size_t
+read_available(FILE* f, char* dst, size_t cap) {
+#ifdef _WIN32
+  return std::fread(dst, 1, cap, f);
+#else
+  const int fd = fileno(f);
+  while (true) {
+    const ssize_t got = ::read(fd, dst, cap);
+    if (got >= 0) {
+      return static_cast<size_t>(got);
+    }
+    if (errno != EINTR) {
+      return 0;
     }
-    return nullptr;
   }
-  return static_cast<StyioListF64*>(list);
+#endif
+}
+
+/* Every stdin fill goes through here so buffered output is out before the read can block. */
+size_t
+read_stdin_available(char* dst, size_t cap) {
+  flush_output_before_stdin_read();
+  return read_available(stdin, dst, cap);
+}
+
+/* Next line of a read handle (stream or mapped), NUL-terminated; false at end of input. */
+bool
+read_file_line_slice(int64_t h, StyioLineReader::Line& out) {
+  const StyioHandleTable::Entry* entry = g_handle_table.lookup_entry(h);
+  if (entry != nullptr && entry->kind == StyioHandleTable::HandleKind::MappedFile) {
+    auto* mapped = static_cast<StyioMappedFile*>(entry->ptr);
+    if (mapped_read_line(mapped) == nullptr) {
+      return false;
+    }
+    out.data = mapped->line.data();
+    out.size = mapped->line.size();
+    return true;
+  }
+  StyioFileStream* stream = entry != nullptr && entry->kind == StyioHandleTable::HandleKind::File
+                              ? static_cast<StyioFileStream*>(entry->ptr)
+                              : as_file_stream(h, true);
+  if (stream == nullptr) {
+    return false;
+  }
+  return stream->reader.next(out, [stream](char* dst, size_t cap) { return fill_from_stream(stream, dst, cap); });
+}
+
+/* Block fill from a read handle: copied out of the mapping, or through the stream's reader source. */
+size_t
+fill_from_read_handle(int64_t h, char* dst, size_t cap) {
+  const StyioHandleTable::Entry* entry = g_handle_table.lookup_entry(h);
+  if (entry == nullptr) {
+    return 0;
+  }
+  if (entry->kind == StyioHandleTable::HandleKind::MappedFile) {
+    auto* mapped = static_cast<StyioMappedFile*>(entry->ptr);
+    const size_t n = std::min(cap, mapped->size - mapped->pos);
+    std::memcpy(dst, mapped->data + mapped->pos, n);
+    mapped->pos += n;
+    return n;
+  }
+  if (entry->kind == StyioHandleTable::HandleKind::File) {
+    return fill_from_stream(static_cast<StyioFileStream*>(entry->ptr), dst, cap);
+  }
+  return 0;
+}
+
+void
+close_csv(void* raw) {
+  if (raw == nullptr) {
+    return;
+  }
+  auto* source = static_cast<StyioCsvSource*>(raw);
+  if (!g_handle_table.release(source->file, StyioHandleTable::HandleKind::File, close_file)) {
+    (void)g_handle_table.release(source->file, StyioHandleTable::HandleKind::MappedFile, close_mapped_file);
+  }
+  delete source;
+}
+
+StyioCsvSource*
+as_csv_source(int64_t h) {
+  auto* source = g_handle_table.lookup_as<StyioCsvSource>(h, StyioHandleTable::HandleKind::Csv);
+  if (source == nullptr) {
+    set_runtime_error_once(
+      kRuntimeSubcodeInvalidFileHandle,
+      "invalid csv handle: " + std::to_string(static_cast<long long>(h)));
+  }
+  return source;
+}
+
+void
+close_columnar(void* raw) {
+  if (raw == nullptr) {
+    return;
+  }
+  auto* source = static_cast<StyioColumnarSource*>(raw);
+#ifndef _WIN32
+  if (source->mapped) {
+    ::munmap(const_cast<void*>(source->image), source->size);
+  }
+#endif
+  delete source;
+}
+
+/* Map `path` (or, where it cannot be mapped, copy it into an 8-byte aligned buffer) and
+   validate the columnar header. Reports the error and returns false on failure. */
+bool
+load_columnar_image(const char* path, StyioColumnarSource& source) {
+  const std::string resolved = resolve_read_path(path);
+  FILE* f = std::fopen(resolved.c_str(), "rb");
+  if (f == nullptr) {
+    set_runtime_error_once(
+      kRuntimeSubcodeFileOpenRead,
+      std::string("cannot open file for read: ") + path);
+    return false;
+  }
+#ifndef _WIN32
+  struct stat st;
+  if (::fstat(fileno(f), &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+    if (data != MAP_FAILED) {
+      source.image = data;
+      source.size = size;
+      source.mapped = true;
+    }
+  }
+#endif
+  if (!source.mapped) {
+    std::string bytes;
+    char buf[1 << 16];
+    size_t n = 0;
+    while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) {
+      bytes.append(buf, n);
+    }
+    source.heap.assign((bytes.size() + 7) / 8, 0);
+    if (!bytes.empty()) {
+      std::memcpy(source.heap.data(), bytes.data(), bytes.size());
+    }
+    source.image = source.heap.data();
+    source.size = bytes.size();
+  }
+  std::fclose(f);
+  if (!source.reader.open(source.image, source.size)) {
+    set_runtime_error_once(kRuntimeSubcodeColumnarFormat, source.reader.error() + ": " + path);
+    return false;
+  }
+  return true;
+}
+
+/* One "<i64|f64|bool|str>:<name>" entry per line, in column order. */
+bool
+parse_columnar_spec(const char* columns, std::vector<std::pair<StyioColumnarType, std::string>>& out) {
+  const std::string spec = columns != nullptr ? columns : "";
+  size_t pos = 0;
+  while (pos < spec.size()) {
+    size_t nl = spec.find('\n', pos);
+    if (nl == std::string::npos) {
+      nl = spec.size();
+    }
+    const std::string entry = spec.substr(pos, nl - pos);
+    pos = nl + 1;
+    const size_t colon = entry.find(':');
+    StyioColumnarType type = StyioColumnarType::I64;
+    if (colon == std::string::npos || !styio_columnar_type_from_name(entry.substr(0, colon), type)) {
+      return false;
+    }
+    out.emplace_back(type, entry.substr(colon + 1));
+  }
+  return true;
+}
+
+template <typename Columns>
+std::string
+describe_columnar_columns(const Columns& columns, size_t count) {
+  std::string out = "(";
+  for (size_t c = 0; c < count; ++c) {
+    if (c > 0) {
+      out += ", ";
+    }
+    out += std::string(styio_columnar_type_name(columns.column(c).type)) + ":" + columns.column(c).name;
+  }
+  return out + ")";
+}
+
+/* Write-then-rename, so the next stage never maps a half-written file. */
+bool
+write_columnar_file(const StyioColumnarSink& sink) {
+  if (sink.writer.rows() < 0) {
+    set_runtime_error_once(
+      kRuntimeSubcodeColumnarSchema,
+      "columns written to " + sink.path + " have different row counts");
+    return false;
+  }
+  const std::string tmp = sink.path + ".tmp";
+  FILE* f = std::fopen(tmp.c_str(), "wb");
+  if (f == nullptr) {
+    set_runtime_error_once(
+      kRuntimeSubcodeFileOpenWrite,
+      "cannot open file for write: " + sink.path);
+    return false;
+  }
+  bool ok = sink.writer.write([f](const void* data, size_t size) {
+    return size == 0 || std::fwrite(data, 1, size, f) == size;
+  });
+  ok = std::fclose(f) == 0 && ok;
+  std::error_code ec;
+  if (ok) {
+    std::filesystem::rename(tmp, sink.path, ec);
+  }
+  if (!ok || ec) {
+    std::filesystem::remove(tmp, ec);
+    set_runtime_error_once(
+      kRuntimeSubcodeFileOpenWrite,
+      "cannot write columnar file: " + sink.path);
+    return false;
+  }
+  return true;
+}
+
+void
+close_columnar_writer(void* raw) {
+  if (raw == nullptr) {
+    return;
+  }
+  auto* sink = static_cast<StyioColumnarSink*>(raw);
+  (void)write_columnar_file(*sink);
+  delete sink;
+}
+
+StyioColumnarSource*
+as_columnar_source(int64_t h) {
+  auto* source = g_handle_table.lookup_as<StyioColumnarSource>(h, StyioHandleTable::HandleKind::Columnar);
+  if (source == nullptr) {
+    set_runtime_error_once(
+      kRuntimeSubcodeInvalidFileHandle,
+      "invalid columnar handle: " + std::to_string(static_cast<long long>(h)));
+  }
+  return source;
+}
+
+/* The writer behind `h` if column `col` exists and holds `type`; reports and returns null otherwise. */
+StyioColumnarWriter*
+as_columnar_writer(int64_t h, int64_t col, StyioColumnarType type) {
+  auto* sink = g_handle_table.lookup_as<StyioColumnarSink>(h, StyioHandleTable::HandleKind::ColumnarWriter);
+  if (sink == nullptr) {
+    set_runtime_error_once(
+      kRuntimeSubcodeInvalidFileHandle,
+      "invalid columnar handle: " + std::to_string(static_cast<long long>(h)));
+    return nullptr;
+  }
+  if (col < 0 || static_cast<size_t>(col) >= sink->writer.column_count()
+      || sink->writer.column(static_cast<size_t>(col)).type != type) {
+    set_runtime_error_once(
+      kRuntimeSubcodeColumnarSchema,
+      std::string("columnar column ") + std::to_string(static_cast<long long>(col)) + " of " + sink->path
+        + " does not hold " + styio_columnar_type_name(type) + " values");
+    return nullptr;
+  }
+  return &sink->writer;
+}
+
+/* from_chars over the whole slice. Anything it rejects (leading blanks, '+', hex floats,
+   overflow) is left to styio_cstr_to_i64 / styio_cstr_to_f64, which own the diagnostics. */
+template <typename T>
+bool
+parse_line_exact(const StyioLineReader::Line& line, T& out) {
+  const char* end = line.data + line.size;
+  const auto res = std::from_chars(line.data, end, out);
+  if (line.size == 0 || res.ec != std::errc() || res.ptr != end) {
+    return false;
+  }
+  if constexpr (std::is_floating_point_v<T>) {
+    /* strtod flags underflow with ERANGE and styio_cstr_to_f64 rejects it; from_chars may
+       accept a subnormal (or round to zero), so those go to the slow path as well. */
+    if (std::fpclassify(out) == FP_SUBNORMAL) {
+      return false;
+    }
+    if (out == 0) {
+      for (const char* p = line.data; p != end && *p != 'e' && *p != 'E'; ++p) {
+        if (*p >= '1' && *p <= '9') {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+int64_t
+stash_list(StyioListBase* list) {
+  if (list == nullptr) {
+    return 0;
+  }
+  ++g_active_list_handles;
+  return g_handle_table.acquire(StyioHandleTable::HandleKind::List, list);
+}
+
+StyioListBase*
+as_list_base(int64_t h, bool diagnose_if_missing = false) {
+  if (h == 0) {
+    return nullptr;
+  }
+  auto* list = g_handle_table.lookup_as<StyioListBase>(h, StyioHandleTable::HandleKind::List);
+  if (list == nullptr && diagnose_if_missing) {
+    set_runtime_error_once(
+      kRuntimeSubcodeInvalidListHandle,
+      "invalid list handle: " + std::to_string(static_cast<long long>(h)));
+  }
+  return list;
+}
+
+StyioListI64*
+as_list_i64(int64_t h, bool diagnose_if_missing = false) {
+  StyioListBase* list = as_list_base(h, diagnose_if_missing);
+  if (list == nullptr) {
+    return nullptr;
+  }
+  if (list->elem_kind != StyioListElemKind::I64) {
+    if (diagnose_if_missing) {
+      set_runtime_error_once(
+        kRuntimeSubcodeListElemKind,
+        "list handle does not carry i64 elements: " + std::to_string(static_cast<long long>(h)));
+    }
+    return nullptr;
+  }
+  return static_cast<StyioListI64*>(list);
+}
+
+StyioListBool*
+as_list_bool(int64_t h, bool diagnose_if_missing = false) {
+  StyioListBase* list = as_list_base(h, diagnose_if_missing);
+  if (list == nullptr) {
+    return nullptr;
+  }
+  if (list->elem_kind != StyioListElemKind::Bool) {
+    if (diagnose_if_missing) {
+      set_runtime_error_once(
+        kRuntimeSubcodeListElemKind,
+        "list handle does not carry bool elements: " + std::to_string(static_cast<long long>(h)));
+    }
+    return nullptr;
+  }
+  return static_cast<StyioListBool*>(list);
+}
+
+StyioListF64*
+as_list_f64(int64_t h, bool diagnose_if_missing = false) {
+  StyioListBase* list = as_list_base(h, diagnose_if_missing);
+  if (list == nullptr) {
+    return nullptr;
+  }
+  if (list->elem_kind != StyioListElemKind::F64) {
+    if (diagnose_if_missing) {
+      set_runtime_error_once(
+        kRuntimeSubcodeListElemKind,
+        "list handle does not carry f64 elements: " + std::to_string(static_cast<long long>(h)));
+    }
+    return nullptr;
+  }
+  return static_cast<StyioListF64*>(list);
 }
 
 StyioListString*
@@ -469,6 +1405,7 @@ close_list(void* raw) {
     return;
   }
   auto* list = static_cast<StyioListBase*>(raw);
+  g_list_epoch += 1;
   switch (list->elem_kind) {
     case StyioListElemKind::Bool:
       delete static_cast<StyioListBool*>(list);
@@ -525,94 +1462,120 @@ as_dict_base(int64_t h, bool diagnose_if_missing = false) {
   return dict;
 }
 
-StyioDictBool*
-as_dict_bool(int64_t h, bool diagnose_if_missing = false) {
+const char*
+dict_value_kind_name(StyioDictValueKind kind) {
+  switch (kind) {
+    case StyioDictValueKind::Bool:
+      return "bool";
+    case StyioDictValueKind::I64:
+      return "i64";
+    case StyioDictValueKind::F64:
+      return "f64";
+    case StyioDictValueKind::String:
+      return "string";
+    case StyioDictValueKind::ListHandle:
+      return "list";
+    case StyioDictValueKind::DictHandle:
+      return "dict";
+  }
+  return "unknown";
+}
+
+/* Dict `h` as storage type DictT, or nullptr when it is missing or has other key/value kinds. */
+template <typename DictT>
+DictT*
+as_dict_storage(int64_t h, bool diagnose_if_missing = false) {
   StyioDictBase* dict = as_dict_base(h, diagnose_if_missing);
   if (dict == nullptr) {
     return nullptr;
   }
-  if (dict->value_kind != StyioDictValueKind::Bool) {
+  if (dict->key_kind != DictT::kKeyKind) {
     if (diagnose_if_missing) {
-      set_runtime_error_once(kRuntimeSubcodeInvalidDictHandle, "dict handle does not carry bool values");
+      set_runtime_error_once(
+        kRuntimeSubcodeInvalidDictHandle,
+        DictT::kKeyKind == StyioDictKeyKind::I64
+          ? "dict handle does not carry i64 keys"
+          : "dict handle does not carry string keys");
     }
     return nullptr;
   }
-  return static_cast<StyioDictBool*>(dict);
-}
-
-StyioDictI64*
-as_dict_i64(int64_t h, bool diagnose_if_missing = false) {
-  StyioDictBase* dict = as_dict_base(h, diagnose_if_missing);
-  if (dict == nullptr) {
-    return nullptr;
-  }
-  if (dict->value_kind != StyioDictValueKind::I64) {
+  if (dict->value_kind != DictT::kValueKind) {
     if (diagnose_if_missing) {
-      set_runtime_error_once(kRuntimeSubcodeInvalidDictHandle, "dict handle does not carry i64 values");
+      set_runtime_error_once(
+        kRuntimeSubcodeInvalidDictHandle,
+        std::string("dict handle does not carry ") + dict_value_kind_name(DictT::kValueKind) + " values");
     }
     return nullptr;
   }
-  return static_cast<StyioDictI64*>(dict);
+  return static_cast<DictT*>(dict);
+}
+
+StyioDictBool*
+as_dict_bool(int64_t h, bool diagnose_if_missing = false) {
+  return as_dict_storage<StyioDictBool>(h, diagnose_if_missing);
+}
+
+StyioDictI64*
+as_dict_i64(int64_t h, bool diagnose_if_missing = false) {
+  return as_dict_storage<StyioDictI64>(h, diagnose_if_missing);
 }
 
 StyioDictF64*
 as_dict_f64(int64_t h, bool diagnose_if_missing = false) {
-  StyioDictBase* dict = as_dict_base(h, diagnose_if_missing);
-  if (dict == nullptr) {
-    return nullptr;
-  }
-  if (dict->value_kind != StyioDictValueKind::F64) {
-    if (diagnose_if_missing) {
-      set_runtime_error_once(kRuntimeSubcodeInvalidDictHandle, "dict handle does not carry f64 values");
-    }
-    return nullptr;
-  }
-  return static_cast<StyioDictF64*>(dict);
+  return as_dict_storage<StyioDictF64>(h, diagnose_if_missing);
 }
 
 StyioDictString*
 as_dict_string(int64_t h, bool diagnose_if_missing = false) {
-  StyioDictBase* dict = as_dict_base(h, diagnose_if_missing);
-  if (dict == nullptr) {
-    return nullptr;
-  }
-  if (dict->value_kind != StyioDictValueKind::String) {
-    if (diagnose_if_missing) {
-      set_runtime_error_once(kRuntimeSubcodeInvalidDictHandle, "dict handle does not carry string values");
-    }
-    return nullptr;
-  }
-  return static_cast<StyioDictString*>(dict);
+  return as_dict_storage<StyioDictString>(h, diagnose_if_missing);
 }
 
 StyioDictListHandle*
 as_dict_list(int64_t h, bool diagnose_if_missing = false) {
-  StyioDictBase* dict = as_dict_base(h, diagnose_if_missing);
-  if (dict == nullptr) {
-    return nullptr;
-  }
-  if (dict->value_kind != StyioDictValueKind::ListHandle) {
-    if (diagnose_if_missing) {
-      set_runtime_error_once(kRuntimeSubcodeInvalidDictHandle, "dict handle does not carry list values");
-    }
-    return nullptr;
-  }
-  return static_cast<StyioDictListHandle*>(dict);
+  return as_dict_storage<StyioDictListHandle>(h, diagnose_if_missing);
 }
 
 StyioDictDictHandle*
 as_dict_dict(int64_t h, bool diagnose_if_missing = false) {
-  StyioDictBase* dict = as_dict_base(h, diagnose_if_missing);
-  if (dict == nullptr) {
-    return nullptr;
-  }
-  if (dict->value_kind != StyioDictValueKind::DictHandle) {
-    if (diagnose_if_missing) {
-      set_runtime_error_once(kRuntimeSubcodeInvalidDictHandle, "dict handle does not carry dict values");
+  return as_dict_storage<StyioDictDictHandle>(h, diagnose_if_missing);
+}
+
+/* Calls `fn` with `dict` cast to its concrete storage type. */
+template <typename Fn>
+decltype(auto)
+visit_dict(StyioDictBase* dict, Fn&& fn) {
+  if (dict->key_kind == StyioDictKeyKind::I64) {
+    switch (dict->value_kind) {
+      case StyioDictValueKind::Bool:
+        return fn(static_cast<StyioIntDictBool*>(dict));
+      case StyioDictValueKind::I64:
+        return fn(static_cast<StyioIntDictI64*>(dict));
+      case StyioDictValueKind::F64:
+        return fn(static_cast<StyioIntDictF64*>(dict));
+      case StyioDictValueKind::String:
+        return fn(static_cast<StyioIntDictString*>(dict));
+      case StyioDictValueKind::ListHandle:
+        return fn(static_cast<StyioIntDictListHandle*>(dict));
+      case StyioDictValueKind::DictHandle:
+        break;
     }
-    return nullptr;
+    return fn(static_cast<StyioIntDictDictHandle*>(dict));
+  }
+  switch (dict->value_kind) {
+    case StyioDictValueKind::Bool:
+      return fn(static_cast<StyioDictBool*>(dict));
+    case StyioDictValueKind::I64:
+      return fn(static_cast<StyioDictI64*>(dict));
+    case StyioDictValueKind::F64:
+      return fn(static_cast<StyioDictF64*>(dict));
+    case StyioDictValueKind::String:
+      return fn(static_cast<StyioDictString*>(dict));
+    case StyioDictValueKind::ListHandle:
+      return fn(static_cast<StyioDictListHandle*>(dict));
+    case StyioDictValueKind::DictHandle:
+      break;
   }
-  return static_cast<StyioDictDictHandle*>(dict);
+  return fn(static_cast<StyioDictDictHandle*>(dict));
 }
 
 template <typename DictT>
@@ -629,9 +1592,28 @@ rebuild_dict_index(DictT* dict) {
 }
 
 template <typename DictT>
+void
+rebuild_dict_flat_index(DictT* dict) {
+  if (dict == nullptr) {
+    return;
+  }
+  dict->flat_index.clear();
+  dict->flat_index.reserve(dict->entries.size());
+  for (size_t i = 0; i < dict->entries.size(); ++i) {
+    dict->flat_index.insert(dict_key_hash(dict->entries[i].first), static_cast<uint32_t>(i));
+  }
+}
+
+template <typename DictT, typename KeyT>
+uint32_t
+dict_flat_find(const DictT* dict, const KeyT& key, uint64_t hash) {
+  return dict->flat_index.find(hash, [&](uint32_t pos) { return dict_key_matches(dict->entries[pos].first, key); });
+}
+
+template <typename DictT, typename KeyT>
 bool
-dict_find_pos(const DictT* dict, const char* key, size_t& pos) {
-  if (dict == nullptr || key == nullptr) {
+dict_find_pos(const DictT* dict, const KeyT& key, size_t& pos) {
+  if (dict == nullptr) {
     return false;
   }
   const auto* backend = dict_backend_spec_by_impl(dict->runtime_impl);
@@ -647,9 +1629,17 @@ dict_find_pos(const DictT* dict, const char* key, size_t& pos) {
       pos = it->second;
       return pos < dict->entries.size();
     }
+    case StyioDictRuntimeImpl::FlatHash: {
+      const uint32_t found = dict_flat_find(dict, key, dict_key_hash(key));
+      if (found == StyioFlatIndex::kNotFound) {
+        return false;
+      }
+      pos = found;
+      return true;
+    }
     case StyioDictRuntimeImpl::Linear:
       for (size_t i = 0; i < dict->entries.size(); ++i) {
-        if (dict->entries[i].first == key) {
+        if (dict_key_matches(dict->entries[i].first, key)) {
           pos = i;
           return true;
         }
@@ -677,13 +1667,17 @@ dict_after_clone(DictT* dict) {
     case StyioDictRuntimeImpl::Linear:
       dict->index_by_key.clear();
       return;
+    case StyioDictRuntimeImpl::FlatHash:
+      dict->index_by_key.clear();
+      rebuild_dict_flat_index(dict);
+      return;
   }
 }
 
-template <typename DictT, typename ValueT>
+template <typename DictT, typename KeyT, typename ValueT>
 void
-dict_set(DictT* dict, const char* key, ValueT&& value) {
-  if (dict == nullptr || key == nullptr) {
+dict_set(DictT* dict, const KeyT& key, ValueT&& value) {
+  if (dict == nullptr) {
     return;
   }
   const auto* backend = dict_backend_spec_by_impl(dict->runtime_impl);
@@ -697,26 +1691,37 @@ dict_set(DictT* dict, const char* key, ValueT&& value) {
         dict->entries[it->second].second = std::forward<ValueT>(value);
         return;
       }
-      dict->entries.emplace_back(std::string(key), std::forward<ValueT>(value));
+      dict->entries.emplace_back(dict_key_owned(key), std::forward<ValueT>(value));
       dict->index_by_key[dict->entries.back().first] = dict->entries.size() - 1;
       return;
     }
+    case StyioDictRuntimeImpl::FlatHash: {
+      const uint64_t hash = dict_key_hash(key);
+      const uint32_t found = dict_flat_find(dict, key, hash);
+      if (found != StyioFlatIndex::kNotFound) {
+        dict->entries[found].second = std::forward<ValueT>(value);
+        return;
+      }
+      dict->entries.emplace_back(dict_key_owned(key), std::forward<ValueT>(value));
+      dict->flat_index.insert(hash, static_cast<uint32_t>(dict->entries.size() - 1));
+      return;
+    }
     case StyioDictRuntimeImpl::Linear:
       for (auto& entry : dict->entries) {
-        if (entry.first == key) {
+        if (dict_key_matches(entry.first, key)) {
           entry.second = std::forward<ValueT>(value);
           return;
         }
       }
-      dict->entries.emplace_back(std::string(key), std::forward<ValueT>(value));
+      dict->entries.emplace_back(dict_key_owned(key), std::forward<ValueT>(value));
       return;
   }
 }
 
-template <typename DictT, typename ReleaseFn>
+template <typename DictT, typename KeyT, typename ReleaseFn>
 void
-dict_set_handle(DictT* dict, const char* key, int64_t value, ReleaseFn&& release_existing) {
-  if (dict == nullptr || key == nullptr) {
+dict_set_handle(DictT* dict, const KeyT& key, int64_t value, ReleaseFn&& release_existing) {
+  if (dict == nullptr) {
     return;
   }
   const auto* backend = dict_backend_spec_by_impl(dict->runtime_impl);
@@ -731,19 +1736,31 @@ dict_set_handle(DictT* dict, const char* key, int64_t value, ReleaseFn&& release
         dict->entries[it->second].second = value;
         return;
       }
-      dict->entries.emplace_back(std::string(key), value);
+      dict->entries.emplace_back(dict_key_owned(key), value);
       dict->index_by_key[dict->entries.back().first] = dict->entries.size() - 1;
       return;
     }
+    case StyioDictRuntimeImpl::FlatHash: {
+      const uint64_t hash = dict_key_hash(key);
+      const uint32_t found = dict_flat_find(dict, key, hash);
+      if (found != StyioFlatIndex::kNotFound) {
+        release_existing(dict->entries[found].second);
+        dict->entries[found].second = value;
+        return;
+      }
+      dict->entries.emplace_back(dict_key_owned(key), value);
+      dict->flat_index.insert(hash, static_cast<uint32_t>(dict->entries.size() - 1));
+      return;
+    }
     case StyioDictRuntimeImpl::Linear:
       for (auto& entry : dict->entries) {
-        if (entry.first == key) {
+        if (dict_key_matches(entry.first, key)) {
           release_existing(entry.second);
           entry.second = value;
           return;
         }
       }
-      dict->entries.emplace_back(std::string(key), value);
+      dict->entries.emplace_back(dict_key_owned(key), value);
       return;
   }
 }
@@ -763,51 +1780,25 @@ clone_dict_storage(const DictT* src, StyioDictRuntimeImpl impl) {
   return clone;
 }
 
-template <typename DictT>
-bool
-dict_try_get(const DictT* dict, const char* key, typename DictT::mapped_type& out) {
-  size_t pos = 0;
-  if (!dict_find_pos(dict, key, pos)) {
-    return false;
-  }
-  out = dict->entries[pos].second;
-  return true;
-}
-
 void
 close_dict(void* raw) {
   if (raw == nullptr) {
     return;
   }
-  auto* dict = static_cast<StyioDictBase*>(raw);
-  switch (dict->value_kind) {
-    case StyioDictValueKind::Bool:
-      delete static_cast<StyioDictBool*>(dict);
-      break;
-    case StyioDictValueKind::I64:
-      delete static_cast<StyioDictI64*>(dict);
-      break;
-    case StyioDictValueKind::F64:
-      delete static_cast<StyioDictF64*>(dict);
-      break;
-    case StyioDictValueKind::String:
-      delete static_cast<StyioDictString*>(dict);
-      break;
-    case StyioDictValueKind::ListHandle: {
-      auto* values = static_cast<StyioDictListHandle*>(dict);
+  visit_dict(static_cast<StyioDictBase*>(raw), [](auto* values) {
+    using DictT = std::remove_pointer_t<decltype(values)>;
+    if constexpr (DictT::kValueKind == StyioDictValueKind::ListHandle) {
       for (const auto& entry : values->entries) {
         (void)g_handle_table.release(entry.second, StyioHandleTable::HandleKind::List, close_list);
       }
-      delete values;
-    } break;
-    case StyioDictValueKind::DictHandle: {
-      auto* values = static_cast<StyioDictDictHandle*>(dict);
+    }
+    else if constexpr (DictT::kValueKind == StyioDictValueKind::DictHandle) {
       for (const auto& entry : values->entries) {
         (void)g_handle_table.release(entry.second, StyioHandleTable::HandleKind::Dict, close_dict);
       }
-      delete values;
-    } break;
-  }
+    }
+    delete values;
+  });
   if (g_active_dict_handles > 0) {
     --g_active_dict_handles;
   }
@@ -867,10 +1858,13 @@ parse_i64_list_literal(const std::string& input, std::vector<int64_t>& out) {
 
 std::string
 read_all_stdin() {
-  std::string input;
-  char buf[4096];
+  /* Bytes the line reader already pulled from stdin come first. */
+  const auto [pending, pending_size] = g_stdin_reader.buffered();
+  std::string input(pending, pending_size);
+  g_stdin_reader.consume_buffered();
+  char buf[65536];
   while (true) {
-    size_t n = std::fread(buf, 1, sizeof(buf), stdin);
+    size_t n = read_stdin_available(buf, sizeof(buf));
     if (n == 0) {
       break;
     }
@@ -981,37 +1975,159 @@ clone_dict_handle_value(int64_t h) {
   if (src == nullptr) {
     return 0;
   }
-  switch (src->value_kind) {
-    case StyioDictValueKind::Bool:
-      return stash_dict(clone_dict_storage(static_cast<StyioDictBool*>(src), src->runtime_impl));
-    case StyioDictValueKind::I64:
-      return stash_dict(clone_dict_storage(static_cast<StyioDictI64*>(src), src->runtime_impl));
-    case StyioDictValueKind::F64:
-      return stash_dict(clone_dict_storage(static_cast<StyioDictF64*>(src), src->runtime_impl));
-    case StyioDictValueKind::String:
-      return stash_dict(clone_dict_storage(static_cast<StyioDictString*>(src), src->runtime_impl));
-    case StyioDictValueKind::ListHandle: {
-      auto* clone = new StyioDictListHandle(src->runtime_impl);
-      auto* values = static_cast<StyioDictListHandle*>(src);
+  return visit_dict(src, [](auto* values) -> int64_t {
+    using DictT = std::remove_pointer_t<decltype(values)>;
+    if constexpr (DictT::kValueKind == StyioDictValueKind::ListHandle
+                  || DictT::kValueKind == StyioDictValueKind::DictHandle) {
+      auto* clone = new DictT(values->runtime_impl);
       clone->entries.reserve(values->entries.size());
       for (const auto& entry : values->entries) {
-        clone->entries.emplace_back(entry.first, clone_list_handle_value(entry.second));
+        if constexpr (DictT::kValueKind == StyioDictValueKind::ListHandle) {
+          clone->entries.emplace_back(entry.first, clone_list_handle_value(entry.second));
+        }
+        else {
+          clone->entries.emplace_back(entry.first, clone_dict_handle_value(entry.second));
+        }
       }
       dict_after_clone(clone);
       return stash_dict(clone);
     }
-    case StyioDictValueKind::DictHandle: {
-      auto* clone = new StyioDictDictHandle(src->runtime_impl);
-      auto* values = static_cast<StyioDictDictHandle*>(src);
-      clone->entries.reserve(values->entries.size());
+    else {
+      return stash_dict(clone_dict_storage(values, values->runtime_impl));
+    }
+  });
+}
+
+/* Key of a styio_dict_*(h, const char* key, ...) call. */
+bool
+resolve_dict_key(const char* key, StyioDictKey& out) {
+  if (key == nullptr) {
+    set_runtime_error_once(kRuntimeSubcodeDictKey, "dict key is null");
+    return false;
+  }
+  out = StyioDictKey{key};
+  return true;
+}
+
+/* Key of a styio_dict_*_keyid(h, key_id, ...) call: text and hash come from the intern table. */
+bool
+resolve_dict_key(int64_t key_id, StyioDictKey& out) {
+  if (key_id <= 0 || static_cast<uint64_t>(key_id) > g_interned_keys.size()) {
+    set_runtime_error_once(kRuntimeSubcodeDictKey, "dict key id is not interned");
+    return false;
+  }
+  const StyioInternedKey& interned = g_interned_keys[static_cast<size_t>(key_id - 1)];
+  out = StyioDictKey{interned.text, interned.hash, true};
+  return true;
+}
+
+/* Key of a styio_idict_*(h, int64_t key, ...) call: used as is. */
+bool
+resolve_dict_key(int64_t key, int64_t& out) {
+  out = key;
+  return true;
+}
+
+/* Shared body of the typed getters; `dict` is null when as_dict_* already reported why. */
+template <typename DictT, typename KeyT, typename Result, typename Convert>
+Result
+dict_get_checked(const DictT* dict, KeyT key, Result missing, Convert&& convert) {
+  if (dict == nullptr) {
+    return missing;
+  }
+  typename DictT::lookup_key k;
+  if (!resolve_dict_key(key, k)) {
+    return missing;
+  }
+  size_t pos = 0;
+  if (dict_find_pos(dict, k, pos)) {
+    return convert(dict->entries[pos].second);
+  }
+  set_runtime_error_once(
+    kRuntimeSubcodeDictKey,
+    "dict key not found: " + dict_key_text(k));
+  return missing;
+}
+
+template <typename DictT, typename KeyT, typename ValueT>
+void
+dict_set_checked(DictT* dict, KeyT key, ValueT&& value) {
+  if (dict == nullptr) {
+    return;
+  }
+  typename DictT::lookup_key k;
+  if (!resolve_dict_key(key, k)) {
+    return;
+  }
+  dict_set(dict, k, std::forward<ValueT>(value));
+}
+
+template <typename DictT, typename KeyT>
+void
+dict_set_list_checked(DictT* dict, KeyT key, int64_t value) {
+  if (dict == nullptr) {
+    return;
+  }
+  typename DictT::lookup_key k;
+  if (!resolve_dict_key(key, k)) {
+    return;
+  }
+  dict_set_handle(
+    dict,
+    k,
+    clone_list_handle_value(value),
+    [](int64_t existing) {
+      (void)g_handle_table.release(existing, StyioHandleTable::HandleKind::List, close_list);
+    });
+}
+
+template <typename DictT, typename KeyT>
+void
+dict_set_dict_checked(DictT* dict, KeyT key, int64_t value) {
+  if (dict == nullptr) {
+    return;
+  }
+  typename DictT::lookup_key k;
+  if (!resolve_dict_key(key, k)) {
+    return;
+  }
+  dict_set_handle(
+    dict,
+    k,
+    clone_dict_handle_value(value),
+    [](int64_t existing) {
+      (void)g_handle_table.release(existing, StyioHandleTable::HandleKind::Dict, close_dict);
+    });
+}
+
+/* Shared body of styio_dict_values_*: the values of a dict holding `Kind`, whatever its key type. */
+template <typename ListT, StyioDictValueKind Kind, typename Convert>
+int64_t
+dict_values_list(int64_t h, Convert&& convert) {
+  StyioDictBase* dict = as_dict_base(h, true);
+  if (dict == nullptr) {
+    return 0;
+  }
+  if (dict->value_kind != Kind) {
+    set_runtime_error_once(
+      kRuntimeSubcodeInvalidDictHandle,
+      std::string("dict handle does not carry ") + dict_value_kind_name(Kind) + " values");
+    return 0;
+  }
+  return visit_dict(dict, [&](auto* values) -> int64_t {
+    using DictT = std::remove_pointer_t<decltype(values)>;
+    if constexpr (DictT::kValueKind != Kind) {
+      return 0;
+    }
+    else {
+      auto* list = new ListT();
+      list->elems.reserve(values->entries.size());
       for (const auto& entry : values->entries) {
-        clone->entries.emplace_back(entry.first, clone_dict_handle_value(entry.second));
+        list->elems.push_back(convert(entry.second));
       }
-      dict_after_clone(clone);
-      return stash_dict(clone);
+      return stash_list(list);
     }
-  }
-  return 0;
+  });
 }
 
 void
@@ -1084,6 +2200,18 @@ append_list_handle_repr(std::string& out, int64_t h) {
   out += "[]";
 }
 
+void
+append_dict_key_repr(std::string& out, const std::string& key) {
+  out.push_back('"');
+  out += escape_string_for_literal(key);
+  out.push_back('"');
+}
+
+void
+append_dict_key_repr(std::string& out, int64_t key) {
+  out += std::to_string(static_cast<long long>(key));
+}
+
 void
 append_dict_handle_repr(std::string& out, int64_t h) {
   StyioDictBase* dict = as_dict_base(h, true);
@@ -1092,108 +2220,101 @@ append_dict_handle_repr(std::string& out, int64_t h) {
     return;
   }
   std::string text = "{";
-  switch (dict->value_kind) {
-    case StyioDictValueKind::Bool: {
-      auto* values = static_cast<StyioDictBool*>(dict);
-      for (size_t i = 0; i < values->entries.size(); ++i) {
-        if (i > 0) {
-          text.push_back(',');
-        }
-        text.push_back('"');
-        text += escape_string_for_literal(values->entries[i].first);
-        text += "\":";
-        text += values->entries[i].second != 0 ? "true" : "false";
+  visit_dict(dict, [&](auto* values) {
+    using DictT = std::remove_pointer_t<decltype(values)>;
+    for (size_t i = 0; i < values->entries.size(); ++i) {
+      if (i > 0) {
+        text.push_back(',');
       }
-    } break;
-    case StyioDictValueKind::I64: {
-      auto* values = static_cast<StyioDictI64*>(dict);
-      for (size_t i = 0; i < values->entries.size(); ++i) {
-        if (i > 0) {
-          text.push_back(',');
-        }
-        text.push_back('"');
-        text += escape_string_for_literal(values->entries[i].first);
-        text += "\":";
-        text += std::to_string(static_cast<long long>(values->entries[i].second));
+      const auto& entry = values->entries[i];
+      append_dict_key_repr(text, entry.first);
+      text.push_back(':');
+      if constexpr (DictT::kValueKind == StyioDictValueKind::Bool) {
+        text += entry.second != 0 ? "true" : "false";
       }
-    } break;
-    case StyioDictValueKind::F64: {
-      auto* values = static_cast<StyioDictF64*>(dict);
-      for (size_t i = 0; i < values->entries.size(); ++i) {
-        if (i > 0) {
-          text.push_back(',');
-        }
-        text.push_back('"');
-        text += escape_string_for_literal(values->entries[i].first);
-        text += "\":";
-        text += format_f64_literal(values->entries[i].second);
+      else if constexpr (DictT::kValueKind == StyioDictValueKind::I64) {
+        text += std::to_string(static_cast<long long>(entry.second));
       }
-    } break;
-    case StyioDictValueKind::String: {
-      auto* values = static_cast<StyioDictString*>(dict);
-      for (size_t i = 0; i < values->entries.size(); ++i) {
-        if (i > 0) {
-          text.push_back(',');
-        }
+      else if constexpr (DictT::kValueKind == StyioDictValueKind::F64) {
+        text += format_f64_literal(entry.second);
+      }
+      else if constexpr (DictT::kValueKind == StyioDictValueKind::String) {
         text.push_back('"');
-        text += escape_string_for_literal(values->entries[i].first);
-        text += "\":\"";
-        text += escape_string_for_literal(values->entries[i].second);
+        text += escape_string_for_literal(entry.second);
         text.push_back('"');
       }
-    } break;
-    case StyioDictValueKind::ListHandle: {
-      auto* values = static_cast<StyioDictListHandle*>(dict);
-      for (size_t i = 0; i < values->entries.size(); ++i) {
-        if (i > 0) {
-          text.push_back(',');
-        }
-        text.push_back('"');
-        text += escape_string_for_literal(values->entries[i].first);
-        text += "\":";
-        append_list_handle_repr(text, values->entries[i].second);
+      else if constexpr (DictT::kValueKind == StyioDictValueKind::ListHandle) {
+        append_list_handle_repr(text, entry.second);
       }
-    } break;
-    case StyioDictValueKind::DictHandle: {
-      auto* values = static_cast<StyioDictDictHandle*>(dict);
-      for (size_t i = 0; i < values->entries.size(); ++i) {
-        if (i > 0) {
-          text.push_back(',');
-        }
-        text.push_back('"');
-        text += escape_string_for_literal(values->entries[i].first);
-        text += "\":";
-        append_dict_handle_repr(text, values->entries[i].second);
+      else {
+        append_dict_handle_repr(text, entry.second);
       }
-    } break;
-  }
+    }
+  });
   text.push_back('}');
   out += text;
 }
 
-}  // namespace
-
-extern "C" DLLEXPORT int64_t
-styio_file_open(const char* path) {
+/* Open `path` for reading as styio_file_open does; nullptr (with the runtime error set) on failure. */
+FILE*
+open_read_path(const char* path) {
   if (path == nullptr) {
     set_runtime_error_once(kRuntimeSubcodeFilePathNull, "file path is null");
-    return 0;
+    return nullptr;
   }
+  /* A file written earlier in the program must be readable in full. */
+  g_write_handle_cache.flush();
   std::string resolved = resolve_read_path(path);
   FILE* f = std::fopen(resolved.c_str(), "rb");
   if (f == nullptr) {
     set_runtime_error_once(
       kRuntimeSubcodeFileOpenRead,
       std::string("cannot open file for read: ") + path);
+  }
+  return f;
+}
+
+}  // namespace
+
+extern "C" DLLEXPORT int64_t
+styio_file_open(const char* path) {
+  FILE* f = open_read_path(path);
+  if (f == nullptr) {
     return 0;
   }
-  return stash_file(f);
+  if (const int64_t mapped = try_stash_mapped_file(f)) {
+    return mapped;
+  }
+  return stash_read_file(f);
 }
 
+/*
+  `@{...}` inputs: like styio_file_open, but a gzip or zstd file (by magic bytes, not by
+  extension) is decompressed block by block as it is read. Compressed files are never
+  mapped; their handle is a stream whose fill runs the decoder.
+*/
 extern "C" DLLEXPORT int64_t
 styio_file_open_auto(const char* path) {
-  /* M5: same as explicit file path for local filesystem paths. */
-  return styio_file_open(path);
+  FILE* f = open_read_path(path);
+  if (f == nullptr) {
+    return 0;
+  }
+  const StyioDecompressor::Codec codec = sniff_file_codec(f);
+  if (codec == StyioDecompressor::Codec::None) {
+    if (const int64_t mapped = try_stash_mapped_file(f)) {
+      return mapped;
+    }
+    return stash_read_file(f);
+  }
+  if (!StyioDecompressor::available(codec)) {
+    std::fclose(f);
+    set_runtime_error_once(
+      kRuntimeSubcodeFileCodec,
+      std::string("file is ") + StyioDecompressor::name(codec)
+        + "-compressed but this build has no " + StyioDecompressor::name(codec) + " support: " + path);
+    return 0;
+  }
+  return stash_read_file(f, codec);
 }
 
 extern "C" DLLEXPORT int64_t
@@ -1202,6 +2323,8 @@ styio_file_open_write(const char* path) {
     set_runtime_error_once(kRuntimeSubcodeFilePathNull, "file path is null");
     return 0;
   }
+  /* Keep bytes from cached write handles ahead of this handle's in a shared file. */
+  g_write_handle_cache.flush();
   /* Append so repeated writes in one program (e.g. per-iteration << file) accumulate. */
   FILE* f = std::fopen(path, "ab");
   if (f == nullptr) {
@@ -1213,40 +2336,85 @@ styio_file_open_write(const char* path) {
   return stash_file(f);
 }
 
+extern "C" DLLEXPORT int64_t
+styio_file_acquire_write(const char* path) {
+  if (path == nullptr) {
+    set_runtime_error_once(kRuntimeSubcodeFilePathNull, "file path is null");
+    return 0;
+  }
+  WriteHandleCache& cache = g_write_handle_cache;
+  if (cache.last_handle != 0 && cache.last_path == path) {
+    return cache.last_handle;
+  }
+  auto it = cache.entries.find(path);
+  if (it == cache.entries.end()) {
+    if (cache.entries.size() >= kWriteHandleCacheMaxPaths) {
+      cache.release();
+    }
+    FILE* f = std::fopen(path, "ab");
+    if (f == nullptr) {
+      set_runtime_error_once(
+        kRuntimeSubcodeFileOpenWrite,
+        std::string("cannot open file for write: ") + path);
+      return 0;
+    }
+    WriteHandleCache::Entry entry;
+    entry.buffer.reset(new char[kWriteHandleBufferBytes]);
+    if (std::setvbuf(f, entry.buffer.get(), _IOFBF, kWriteHandleBufferBytes) != 0) {
+      entry.buffer.reset();
+    }
+    entry.handle = stash_file(f);
+    it = cache.entries.emplace(path, std::move(entry)).first;
+  }
+  cache.last_path = it->first;
+  cache.last_handle = it->second.handle;
+  return it->second.handle;
+}
+
+extern "C" DLLEXPORT void
+styio_file_release_writes() {
+  g_write_handle_cache.release();
+  g_columnar_write_cache.release();
+}
+
 extern "C" DLLEXPORT void
 styio_file_close(int64_t h) {
-  (void)g_handle_table.release(h, StyioHandleTable::HandleKind::File, close_file);
+  if (!g_handle_table.release(h, StyioHandleTable::HandleKind::File, close_file)) {
+    (void)g_handle_table.release(h, StyioHandleTable::HandleKind::MappedFile, close_mapped_file);
+  }
 }
 
 extern "C" DLLEXPORT void
 styio_file_rewind(int64_t h) {
-  FILE* f = as_file(h, true);
-  if (f != nullptr) {
-    std::rewind(f);
+  const StyioHandleTable::Entry* entry = g_handle_table.lookup_entry(h);
+  if (entry != nullptr && entry->kind == StyioHandleTable::HandleKind::MappedFile) {
+    static_cast<StyioMappedFile*>(entry->ptr)->pos = 0;
+    return;
+  }
+  StyioFileStream* stream = as_file_stream(h, true);
+  if (stream != nullptr) {
+    if (stream->read_ahead) {
+      stream->read_ahead->stop();
+    }
+    stream->reader.reset();
+    std::rewind(stream->file);
+    if (stream->decoder) {
+      stream->decoder->reset();
+    }
   }
 }
 
 extern "C" DLLEXPORT const char*
 styio_file_read_line(int64_t h) {
-  FILE* f = as_file(h, true);
-  if (f == nullptr) {
-    return nullptr;
-  }
-  int w = g_read_line_buf_which;
-  g_read_line_buf_which = 1 - g_read_line_buf_which;
-  char* buf = g_read_line_bufs[w];
-  if (std::fgets(buf, static_cast<int>(sizeof(g_read_line_bufs[0])), f) == nullptr) {
+  StyioLineReader::Line line;
+  if (!read_file_line_slice(h, line)) {
     return nullptr;
   }
-  size_t n = std::strlen(buf);
-  while (n > 0 && (buf[n - 1] == '\n' || buf[n - 1] == '\r')) {
-    buf[--n] = '\0';
-  }
-  return buf;
+  return line.data;
 }
 
 extern "C" DLLEXPORT int64_t
-styio_cstr_to_i64(const char* s) {
+styio_cstr_to_i64_slow(const char* s) {
   if (s == nullptr || s[0] == '\0') {
     set_runtime_error_once(kRuntimeSubcodeNumericParse, "cannot parse empty string as integer");
     return 0;
@@ -1263,6 +2431,12 @@ styio_cstr_to_i64(const char* s) {
   return static_cast<int64_t>(value);
 }
 
+/* Keep in sync with the inlinable twin in src/StyioRuntime/InlineRuntime.cpp. */
+extern "C" DLLEXPORT int64_t
+styio_cstr_to_i64(const char* s) {
+  return styio_cstr_to_i64_slow(s);
+}
+
 extern "C" DLLEXPORT double
 styio_cstr_to_f64(const char* s) {
   if (s == nullptr || s[0] == '\0') {
@@ -1281,25 +2455,368 @@ styio_cstr_to_f64(const char* s) {
   return value;
 }
 
-extern "C" DLLEXPORT void
-styio_file_write_cstr(int64_t h, const char* data) {
-  FILE* f = as_file(h, true);
-  if (f == nullptr || data == nullptr) {
-    return;
+extern "C" DLLEXPORT const char*
+styio_file_read_i64(int64_t h, int64_t* value, int64_t* parsed) {
+  StyioLineReader::Line line;
+  if (!read_file_line_slice(h, line)) {
+    return nullptr;
   }
-  std::fputs(data, f);
+  int64_t v = 0;
+  const bool ok = parse_line_exact(line, v);
+  if (value != nullptr) {
+    *value = v;
+  }
+  if (parsed != nullptr) {
+    *parsed = ok ? 1 : 0;
+  }
+  return line.data;
+}
+
+extern "C" DLLEXPORT const char*
+styio_file_read_f64(int64_t h, double* value, int64_t* parsed) {
+  StyioLineReader::Line line;
+  if (!read_file_line_slice(h, line)) {
+    return nullptr;
+  }
+  double v = 0.0;
+  const bool ok = parse_line_exact(line, v);
+  if (value != nullptr) {
+    *value = v;
+  }
+  if (parsed != nullptr) {
+    *parsed = ok ? 1 : 0;
+  }
+  return line.data;
 }
 
 extern "C" DLLEXPORT int64_t
-styio_read_file_i64line(const char* path) {
-  if (path == nullptr) {
-    set_runtime_error_once(kRuntimeSubcodeFilePathNull, "file path is null");
+styio_file_read_i64_batch(int64_t h, int64_t* dst, int64_t cap) {
+  if (dst == nullptr || cap <= 0) {
     return 0;
   }
-  std::string resolved = resolve_read_path(path);
-  FILE* f = std::fopen(resolved.c_str(), "rb");
-  if (f == nullptr) {
-    set_runtime_error_once(
+  int64_t n = 0;
+  StyioLineReader::Line line;
+  while (n < cap && read_file_line_slice(h, line)) {
+    if (!parse_line_exact(line, dst[n])) {
+      dst[n] = styio_cstr_to_i64(line.data);
+      if (styio_runtime_has_error()) {
+        break;
+      }
+    }
+    ++n;
+  }
+  return n;
+}
+
+extern "C" DLLEXPORT int64_t
+styio_file_read_f64_batch(int64_t h, double* dst, int64_t cap) {
+  if (dst == nullptr || cap <= 0) {
+    return 0;
+  }
+  int64_t n = 0;
+  StyioLineReader::Line line;
+  while (n < cap && read_file_line_slice(h, line)) {
+    if (!parse_line_exact(line, dst[n])) {
+      dst[n] = styio_cstr_to_f64(line.data);
+      if (styio_runtime_has_error()) {
+        break;
+      }
+    }
+    ++n;
+  }
+  return n;
+}
+
+extern "C" DLLEXPORT int64_t
+styio_csv_open(const char* path, const char* columns) {
+  const int64_t file = styio_file_open(path);
+  if (file == 0) {
+    return 0;
+  }
+  auto* source = new StyioCsvSource();
+  source->file = file;
+  /* One "<i64|f64|str>:<header name>" entry per line, in column index order. */
+  const std::string spec = columns != nullptr ? columns : "";
+  size_t pos = 0;
+  while (pos < spec.size()) {
+    size_t nl = spec.find('\n', pos);
+    if (nl == std::string::npos) {
+      nl = spec.size();
+    }
+    const std::string entry = spec.substr(pos, nl - pos);
+    pos = nl + 1;
+    const size_t colon = entry.find(':');
+    const std::string kind = entry.substr(0, colon);
+    auto type = StyioCsvReader::ColumnType::String;
+    if (kind == "i64") {
+      type = StyioCsvReader::ColumnType::I64;
+    }
+    else if (kind == "f64") {
+      type = StyioCsvReader::ColumnType::F64;
+    }
+    source->reader.add_column(colon == std::string::npos ? entry : entry.substr(colon + 1), type);
+  }
+  if (!source->reader.open([file](char* dst, size_t cap) { return fill_from_read_handle(file, dst, cap); })) {
+    set_runtime_error_once(kRuntimeSubcodeCsvColumn, source->reader.error() + " in " + path);
+    close_csv(source);
+    return 0;
+  }
+  return g_handle_table.acquire(StyioHandleTable::HandleKind::Csv, source);
+}
+
+/*
+  Rows in the next batch (at most StyioCsvReader::kDefaultBatchRows); 0 at end of input.
+  A bad record cuts its batch short; the rows before it still come back, and the next
+  call returns 0 with the runtime error set.
+*/
+extern "C" DLLEXPORT int64_t
+styio_csv_next_batch(int64_t h) {
+  StyioCsvSource* source = as_csv_source(h);
+  if (source == nullptr) {
+    return 0;
+  }
+  const int64_t file = source->file;
+  const size_t rows = source->reader.next_batch(
+    [file](char* dst, size_t cap) { return fill_from_read_handle(file, dst, cap); });
+  if (rows == 0 && !source->reader.error().empty()) {
+    set_runtime_error_once(
+      source->reader.parse_failed() ? kRuntimeSubcodeNumericParse : kRuntimeSubcodeCsvColumn,
+      source->reader.error());
+  }
+  return static_cast<int64_t>(rows);
+}
+
+extern "C" DLLEXPORT const int64_t*
+styio_csv_column_i64(int64_t h, int64_t col) {
+  StyioCsvSource* source = as_csv_source(h);
+  if (source == nullptr || col < 0 || static_cast<size_t>(col) >= source->reader.column_count()) {
+    return nullptr;
+  }
+  return source->reader.column(static_cast<size_t>(col)).i64.data();
+}
+
+extern "C" DLLEXPORT const double*
+styio_csv_column_f64(int64_t h, int64_t col) {
+  StyioCsvSource* source = as_csv_source(h);
+  if (source == nullptr || col < 0 || static_cast<size_t>(col) >= source->reader.column_count()) {
+    return nullptr;
+  }
+  return source->reader.column(static_cast<size_t>(col)).f64.data();
+}
+
+extern "C" DLLEXPORT const char* const*
+styio_csv_column_cstr(int64_t h, int64_t col) {
+  StyioCsvSource* source = as_csv_source(h);
+  if (source == nullptr || col < 0 || static_cast<size_t>(col) >= source->reader.column_count()) {
+    return nullptr;
+  }
+  return source->reader.column(static_cast<size_t>(col)).str.data();
+}
+
+extern "C" DLLEXPORT void
+styio_csv_close(int64_t h) {
+  (void)g_handle_table.release(h, StyioHandleTable::HandleKind::Csv, close_csv);
+}
+
+/*
+  `@col{...} >> #(a: i64, b: str) => {...}`: one "<i64|f64|bool|str>:<name>" line per loop
+  parameter. Each binds the file column of that name; a lone parameter binds the only
+  column of a single-column file whatever it is called. The declared type must match.
+*/
+extern "C" DLLEXPORT int64_t
+styio_col_open(const char* path, const char* columns) {
+  if (path == nullptr) {
+    set_runtime_error_once(kRuntimeSubcodeFilePathNull, "file path is null");
+    return 0;
+  }
+  /* Rows written to this path earlier in the program must be in the file. */
+  g_columnar_write_cache.release_path(path);
+  std::vector<std::pair<StyioColumnarType, std::string>> spec;
+  if (!parse_columnar_spec(columns, spec)) {
+    set_runtime_error_once(kRuntimeSubcodeColumnarSchema, std::string("bad columnar column spec for ") + path);
+    return 0;
+  }
+  auto* source = new StyioColumnarSource();
+  if (!load_columnar_image(path, *source)) {
+    close_columnar(source);
+    return 0;
+  }
+  const StyioColumnarReader& reader = source->reader;
+  for (const auto& [type, name] : spec) {
+    int c = reader.find(name);
+    if (c < 0 && spec.size() == 1 && reader.column_count() == 1) {
+      c = 0;
+    }
+    if (c < 0) {
+      set_runtime_error_once(
+        kRuntimeSubcodeColumnarSchema,
+        "columnar column not found: '" + name + "' in " + path + " " + describe_columnar_columns(reader, reader.column_count()));
+      close_columnar(source);
+      return 0;
+    }
+    if (reader.column(static_cast<size_t>(c)).type != type) {
+      set_runtime_error_once(
+        kRuntimeSubcodeColumnarSchema,
+        "columnar column '" + reader.column(static_cast<size_t>(c)).name + "' in " + path + " holds "
+          + styio_columnar_type_name(reader.column(static_cast<size_t>(c)).type) + ", read as "
+          + styio_columnar_type_name(type));
+      close_columnar(source);
+      return 0;
+    }
+    source->bound.push_back(static_cast<size_t>(c));
+  }
+  return g_handle_table.acquire(StyioHandleTable::HandleKind::Columnar, source);
+}
+
+extern "C" DLLEXPORT int64_t
+styio_col_rows(int64_t h) {
+  StyioColumnarSource* source = as_columnar_source(h);
+  return source != nullptr ? static_cast<int64_t>(source->reader.rows()) : 0;
+}
+
+/* Values of bound column `col`: int64_t / double / one byte per bool, or for a str
+   column the uint64_t offsets into styio_col_strings(). */
+extern "C" DLLEXPORT const void*
+styio_col_data(int64_t h, int64_t col) {
+  StyioColumnarSource* source = as_columnar_source(h);
+  if (source == nullptr || col < 0 || static_cast<size_t>(col) >= source->bound.size()) {
+    return nullptr;
+  }
+  return source->reader.column(source->bound[static_cast<size_t>(col)]).data;
+}
+
+extern "C" DLLEXPORT const char*
+styio_col_strings(int64_t h, int64_t col) {
+  StyioColumnarSource* source = as_columnar_source(h);
+  if (source == nullptr || col < 0 || static_cast<size_t>(col) >= source->bound.size()) {
+    return nullptr;
+  }
+  return source->reader.string_blob(source->bound[static_cast<size_t>(col)]);
+}
+
+extern "C" DLLEXPORT void
+styio_col_close(int64_t h) {
+  (void)g_handle_table.release(h, StyioHandleTable::HandleKind::Columnar, close_columnar);
+}
+
+/*
+  Writer for `<< @col{...}`, cached per path like styio_file_acquire_write and written
+  out by styio_file_release_writes. `columns` uses the styio_col_open spec. As with
+  `<< @file{...}`, writes append: the rows of an existing file are kept, so its columns
+  must match.
+*/
+extern "C" DLLEXPORT int64_t
+styio_col_acquire_write(const char* path, const char* columns) {
+  if (path == nullptr) {
+    set_runtime_error_once(kRuntimeSubcodeFilePathNull, "file path is null");
+    return 0;
+  }
+  const char* spec_text = columns != nullptr ? columns : "";
+  ColumnarWriteCache& cache = g_columnar_write_cache;
+  auto it = cache.entries.find(path);
+  if (it != cache.entries.end()) {
+    auto* sink = g_handle_table.lookup_as<StyioColumnarSink>(it->second, StyioHandleTable::HandleKind::ColumnarWriter);
+    if (sink != nullptr && sink->columns == spec_text) {
+      return it->second;
+    }
+    set_runtime_error_once(
+      kRuntimeSubcodeColumnarSchema,
+      std::string("columnar file ") + path + " is written with different columns in one program");
+    return 0;
+  }
+
+  std::vector<std::pair<StyioColumnarType, std::string>> spec;
+  if (!parse_columnar_spec(spec_text, spec)) {
+    set_runtime_error_once(kRuntimeSubcodeColumnarSchema, std::string("bad columnar column spec for ") + path);
+    return 0;
+  }
+  auto sink = std::make_unique<StyioColumnarSink>();
+  sink->path = path;
+  sink->columns = spec_text;
+  for (const auto& [type, name] : spec) {
+    sink->writer.add_column(name, type);
+  }
+  std::error_code ec;
+  if (std::filesystem::exists(path, ec) && std::filesystem::file_size(path, ec) > 0 && !ec) {
+    auto* existing = new StyioColumnarSource();
+    bool ok = load_columnar_image(path, *existing);
+    if (ok) {
+      const StyioColumnarReader& reader = existing->reader;
+      ok = reader.column_count() == spec.size();
+      for (size_t c = 0; ok && c < spec.size(); ++c) {
+        ok = reader.column(c).type == spec[c].first && reader.column(c).name == spec[c].second;
+      }
+      if (ok) {
+        sink->writer.append_rows(reader);
+      }
+      else {
+        set_runtime_error_once(
+          kRuntimeSubcodeColumnarSchema,
+          std::string("columnar file ") + path + " has columns " + describe_columnar_columns(reader, reader.column_count())
+            + ", written as " + describe_columnar_columns(sink->writer, sink->writer.column_count()));
+      }
+    }
+    close_columnar(existing);
+    if (!ok) {
+      return 0;
+    }
+  }
+  if (cache.entries.size() >= kWriteHandleCacheMaxPaths) {
+    cache.release();
+  }
+  const int64_t h = g_handle_table.acquire(StyioHandleTable::HandleKind::ColumnarWriter, sink.release());
+  cache.entries.emplace(path, h);
+  return h;
+}
+
+extern "C" DLLEXPORT void
+styio_col_write_i64(int64_t h, int64_t col, int64_t value) {
+  if (StyioColumnarWriter* writer = as_columnar_writer(h, col, StyioColumnarType::I64)) {
+    writer->append_i64(static_cast<size_t>(col), value);
+  }
+}
+
+extern "C" DLLEXPORT void
+styio_col_write_f64(int64_t h, int64_t col, double value) {
+  if (StyioColumnarWriter* writer = as_columnar_writer(h, col, StyioColumnarType::F64)) {
+    writer->append_f64(static_cast<size_t>(col), value);
+  }
+}
+
+extern "C" DLLEXPORT void
+styio_col_write_bool(int64_t h, int64_t col, int64_t value) {
+  if (StyioColumnarWriter* writer = as_columnar_writer(h, col, StyioColumnarType::Bool)) {
+    writer->append_bool(static_cast<size_t>(col), value != 0);
+  }
+}
+
+extern "C" DLLEXPORT void
+styio_col_write_cstr(int64_t h, int64_t col, const char* value) {
+  if (StyioColumnarWriter* writer = as_columnar_writer(h, col, StyioColumnarType::String)) {
+    writer->append_string(static_cast<size_t>(col), value != nullptr ? value : "", value != nullptr ? std::strlen(value) : 0);
+  }
+}
+
+extern "C" DLLEXPORT void
+styio_file_write_cstr(int64_t h, const char* data) {
+  FILE* f = as_file(h, true);
+  if (f == nullptr || data == nullptr) {
+    return;
+  }
+  std::fputs(data, f);
+}
+
+extern "C" DLLEXPORT int64_t
+styio_read_file_i64line(const char* path) {
+  if (path == nullptr) {
+    set_runtime_error_once(kRuntimeSubcodeFilePathNull, "file path is null");
+    return 0;
+  }
+  g_write_handle_cache.flush();
+  std::string resolved = resolve_read_path(path);
+  FILE* f = std::fopen(resolved.c_str(), "rb");
+  if (f == nullptr) {
+    set_runtime_error_once(
       kRuntimeSubcodeFileOpenRead,
       std::string("cannot open file for read: ") + path);
     return 0;
@@ -1374,6 +2891,11 @@ styio_runtime_has_error() {
   return g_runtime_error ? 1 : 0;
 }
 
+extern "C" DLLEXPORT int32_t*
+styio_runtime_error_word() {
+  return &g_runtime_error;
+}
+
 extern "C" DLLEXPORT const char*
 styio_runtime_last_error() {
   if (!g_runtime_error || g_runtime_error_message.empty()) {
@@ -1392,57 +2914,151 @@ styio_runtime_last_error_subcode() {
 
 extern "C" DLLEXPORT void
 styio_runtime_clear_error() {
-  g_runtime_error = false;
+  g_runtime_error = 0;
   g_runtime_error_message.clear();
   g_runtime_error_subcode.clear();
 }
 
+extern "C" DLLEXPORT void
+styio_runtime_reset() {
+  flush_output();
+  g_write_handle_cache.release();
+  g_columnar_write_cache.release();
+  release_all_handles();
+  g_active_list_handles = 0;
+  g_active_dict_handles = 0;
+  for (const void* p : g_owned_cstr_ptrs) {
+    std::free(const_cast<void*>(p));
+  }
+  g_owned_cstr_ptrs.clear();
+  g_stdin_reader.reset();
+  styio_runtime_clear_error();
+}
+
 extern "C" DLLEXPORT void
 styio_runtime_set_log_sink(StyioRuntimeLogSink sink) {
   g_runtime_log_sink = sink;
 }
 
-/* M9+: write a C-string to stdout with trailing newline and immediate flush.
+extern "C" DLLEXPORT int
+styio_runtime_set_output_flush(const char* policy) {
+  if (policy == nullptr) {
+    return 0;
+  }
+  const std::string text = policy;
+  OutputFlushMode mode = OutputFlushMode::Line;
+  size_t amount = 0;
+  if (text == "line") {
+    mode = OutputFlushMode::Line;
+  }
+  else if (text == "exit") {
+    mode = OutputFlushMode::Exit;
+  }
+  else if (text.rfind("block:", 0) == 0) {
+    mode = OutputFlushMode::Block;
+    if (!parse_output_flush_amount(policy + 6, kOutputFlushMaxBufferBytes, amount)) {
+      return 0;
+    }
+  }
+  else if (text.rfind("interval:", 0) == 0) {
+    mode = OutputFlushMode::Interval;
+    if (!parse_output_flush_amount(policy + 9, 24u * 60u * 60u * 1000u, amount)) {
+      return 0;
+    }
+  }
+  else {
+    return 0;
+  }
+
+  std::lock_guard<std::mutex> lock(g_output_mutex);
+  flush_output_locked();
+  g_output_flush_mode = mode;
+  g_output_flush_block_bytes = mode == OutputFlushMode::Block ? amount : 0;
+  g_output_flush_interval = std::chrono::milliseconds(mode == OutputFlushMode::Interval ? amount : 0);
+  /* Line mode keeps whatever buffering the streams have; it flushes every line anyway. */
+  if (mode != OutputFlushMode::Line) {
+    const size_t bytes = mode == OutputFlushMode::Block ? amount : kOutputFlushDefaultBufferBytes;
+    resize_output_buffer(stdout, g_stdout_state, bytes);
+    resize_output_buffer(stderr, g_stderr_state, bytes);
+  }
+  return 1;
+}
+
+extern "C" DLLEXPORT int
+styio_runtime_set_file_source(const char* mode) {
+  if (mode == nullptr) {
+    return 0;
+  }
+  const std::string text = mode;
+  if (text == "auto") {
+    g_file_source_mode = FileSourceMode::Auto;
+  }
+  else if (text == "stream") {
+    g_file_source_mode = FileSourceMode::Stream;
+  }
+  else if (text == "mmap") {
+    g_file_source_mode = FileSourceMode::Mapped;
+  }
+  else {
+    return 0;
+  }
+  return 1;
+}
+
+extern "C" DLLEXPORT void
+styio_runtime_flush_output() {
+  flush_output();
+}
+
+extern "C" DLLEXPORT int
+styio_runtime_report_exit() {
+  g_write_handle_cache.release();
+  g_columnar_write_cache.release();
+  flush_output();
+  if (!g_runtime_error) {
+    return 0;
+  }
+  const char* message =
+    g_runtime_error_message.empty() ? "runtime helper reported error" : g_runtime_error_message.c_str();
+  std::fprintf(stderr, "[RuntimeError] %s\n", message);
+  std::fflush(stderr);
+  return 5;
+}
+
+/* M9+: write a C-string to stdout with trailing newline, flushed per the output policy.
    Null-safe (no-op for nullptr). */
 extern "C" DLLEXPORT void
 styio_stdout_write_cstr(const char* s) {
   if (s != nullptr) {
-    std::fprintf(stdout, "%s\n", s);
-    std::fflush(stdout);
+    write_output_line(stdout, g_stdout_state, s);
     if (g_runtime_log_sink != nullptr) {
       g_runtime_log_sink("stdout", s);
     }
   }
 }
 
-/* M9: write a C-string to stderr with trailing newline and immediate flush.
+/* M9: write a C-string to stderr with trailing newline, flushed per the output policy.
    Null-safe (no-op for nullptr). */
 extern "C" DLLEXPORT void
 styio_stderr_write_cstr(const char* s) {
   if (s != nullptr) {
-    std::fprintf(stderr, "%s\n", s);
-    std::fflush(stderr);
+    write_output_line(stderr, g_stderr_state, s);
     if (g_runtime_log_sink != nullptr) {
       g_runtime_log_sink("stderr", s);
     }
   }
 }
 
-/* M10: read one line from stdin into a thread-local buffer.
-   Returns borrowed pointer (valid until next call on this thread).
+/* M10: read one line from stdin through the thread's stdin block reader.
+   Returns borrowed pointer (valid until next stdin read on this thread).
    Returns nullptr on EOF. Strips trailing newline/CR. */
-thread_local char g_stdin_line_buf[65536];
-
 extern "C" DLLEXPORT const char*
 styio_stdin_read_line() {
-  if (std::fgets(g_stdin_line_buf, static_cast<int>(sizeof(g_stdin_line_buf)), stdin) == nullptr) {
+  StyioLineReader::Line line;
+  if (!g_stdin_reader.next(line, read_stdin_available)) {
     return nullptr;
   }
-  size_t n = std::strlen(g_stdin_line_buf);
-  while (n > 0 && (g_stdin_line_buf[n - 1] == '\n' || g_stdin_line_buf[n - 1] == '\r')) {
-    g_stdin_line_buf[--n] = '\0';
-  }
-  return g_stdin_line_buf;
+  return line.data;
 }
 
 extern "C" DLLEXPORT int64_t
@@ -1463,13 +3079,9 @@ styio_list_i64_read_stdin() {
 extern "C" DLLEXPORT int64_t
 styio_list_cstr_read_stdin() {
   auto* list = new StyioListString();
-  char line_buf[65536];
-  while (std::fgets(line_buf, static_cast<int>(sizeof(line_buf)), stdin) != nullptr) {
-    size_t n = std::strlen(line_buf);
-    while (n > 0 && (line_buf[n - 1] == '\n' || line_buf[n - 1] == '\r')) {
-      line_buf[--n] = '\0';
-    }
-    list->elems.emplace_back(line_buf);
+  StyioLineReader::Line line;
+  while (g_stdin_reader.next(line, read_stdin_available)) {
+    list->elems.emplace_back(line.data, line.size);
   }
   return stash_list(list);
 }
@@ -1499,6 +3111,7 @@ list_insert_value(ListT* list, int64_t idx, ValueT&& value) {
     return;
   }
   list->elems.insert(list->elems.begin() + static_cast<size_t>(idx), std::forward<ValueT>(value));
+  g_list_epoch += 1;
 }
 
 template <typename ListT, typename ValueT>
@@ -1545,6 +3158,7 @@ styio_list_push_bool(int64_t h, int64_t value) {
   StyioListBool* list = as_list_bool(h, true);
   if (list != nullptr) {
     list->elems.push_back(value != 0 ? 1 : 0);
+    g_list_epoch += 1;
   }
 }
 
@@ -1553,6 +3167,7 @@ styio_list_push_i64(int64_t h, int64_t value) {
   StyioListI64* list = as_list_i64(h, true);
   if (list != nullptr) {
     list->elems.push_back(value);
+    g_list_epoch += 1;
   }
 }
 
@@ -1561,6 +3176,7 @@ styio_list_push_f64(int64_t h, double value) {
   StyioListF64* list = as_list_f64(h, true);
   if (list != nullptr) {
     list->elems.push_back(value);
+    g_list_epoch += 1;
   }
 }
 
@@ -1805,6 +3421,7 @@ styio_list_pop(int64_t h) {
   if (list == nullptr) {
     return;
   }
+  g_list_epoch += 1;
   bool popped = false;
   switch (list->elem_kind) {
     case StyioListElemKind::Bool: {
@@ -1886,6 +3503,45 @@ styio_list_active_count() {
   return g_active_list_handles;
 }
 
+namespace {
+
+/* Element storage of a scalar list as a borrowed span. An empty list gets a non-null
+   pointer, so nullptr always means "not a list of this kind". */
+template <typename ListT, typename ElemT>
+const ElemT*
+list_span(StyioListBase* list, StyioListElemKind kind, int64_t* len) {
+  static const ElemT kEmpty{};
+  if (list == nullptr || list->elem_kind != kind) {
+    *len = 0;
+    return nullptr;
+  }
+  const auto& elems = static_cast<ListT*>(list)->elems;
+  *len = static_cast<int64_t>(elems.size());
+  return elems.empty() ? &kEmpty : elems.data();
+}
+
+}  // namespace
+
+extern "C" DLLEXPORT const int64_t*
+styio_list_span_i64(int64_t h, int64_t* len) {
+  return list_span<StyioListI64, int64_t>(as_list_base(h), StyioListElemKind::I64, len);
+}
+
+extern "C" DLLEXPORT const double*
+styio_list_span_f64(int64_t h, int64_t* len) {
+  return list_span<StyioListF64, double>(as_list_base(h), StyioListElemKind::F64, len);
+}
+
+extern "C" DLLEXPORT const int64_t*
+styio_list_span_bool(int64_t h, int64_t* len) {
+  return list_span<StyioListBool, int64_t>(as_list_base(h), StyioListElemKind::Bool, len);
+}
+
+extern "C" DLLEXPORT const uint64_t*
+styio_list_epoch_word() {
+  return &g_list_epoch;
+}
+
 extern "C" DLLEXPORT int64_t
 styio_dict_new_bool() {
   return stash_dict(make_dict_storage_for_current_backend<StyioDictBool>());
@@ -1927,366 +3583,296 @@ styio_dict_len(int64_t h) {
   if (dict == nullptr) {
     return 0;
   }
-  switch (dict->value_kind) {
-    case StyioDictValueKind::Bool:
-      return static_cast<int64_t>(static_cast<StyioDictBool*>(dict)->entries.size());
-    case StyioDictValueKind::I64:
-      return static_cast<int64_t>(static_cast<StyioDictI64*>(dict)->entries.size());
-    case StyioDictValueKind::F64:
-      return static_cast<int64_t>(static_cast<StyioDictF64*>(dict)->entries.size());
-    case StyioDictValueKind::String:
-      return static_cast<int64_t>(static_cast<StyioDictString*>(dict)->entries.size());
-    case StyioDictValueKind::ListHandle:
-      return static_cast<int64_t>(static_cast<StyioDictListHandle*>(dict)->entries.size());
-    case StyioDictValueKind::DictHandle:
-      return static_cast<int64_t>(static_cast<StyioDictDictHandle*>(dict)->entries.size());
-  }
-  return 0;
+  return visit_dict(dict, [](auto* values) { return static_cast<int64_t>(values->entries.size()); });
 }
 
 extern "C" DLLEXPORT int64_t
-styio_dict_get_bool(int64_t h, const char* key) {
-  StyioDictBool* dict = as_dict_bool(h, true);
-  if (dict == nullptr) {
-    return 0;
-  }
+styio_key_intern(const char* key) {
   if (key == nullptr) {
-    set_runtime_error_once(kRuntimeSubcodeDictKey, "dict key is null");
     return 0;
   }
-  int64_t value = 0;
-  if (dict_try_get(dict, key, value)) {
-    return value != 0 ? 1 : 0;
+  const std::string_view text(key);
+  const uint64_t hash = StyioFlatIndex::hash_key(text);
+  const uint32_t found = g_interned_key_index.find(hash, [&](uint32_t pos) { return g_interned_keys[pos].text == text; });
+  if (found != StyioFlatIndex::kNotFound) {
+    return static_cast<int64_t>(found) + 1;
   }
-  set_runtime_error_once(
-    kRuntimeSubcodeDictKey,
-    std::string("dict key not found: ") + key);
-  return 0;
+  g_interned_keys.push_back(StyioInternedKey{std::string(text), hash});
+  g_interned_key_index.insert(hash, static_cast<uint32_t>(g_interned_keys.size() - 1));
+  return static_cast<int64_t>(g_interned_keys.size());
+}
+
+extern "C" DLLEXPORT int64_t
+styio_dict_get_bool(int64_t h, const char* key) {
+  return dict_get_checked(as_dict_bool(h, true), key, int64_t(0), [](int64_t value) {
+    return value != 0 ? int64_t(1) : int64_t(0);
+  });
+}
+
+extern "C" DLLEXPORT int64_t
+styio_dict_get_bool_keyid(int64_t h, int64_t key_id) {
+  return dict_get_checked(as_dict_bool(h, true), key_id, int64_t(0), [](int64_t value) {
+    return value != 0 ? int64_t(1) : int64_t(0);
+  });
 }
 
 extern "C" DLLEXPORT int64_t
 styio_dict_get_i64(int64_t h, const char* key) {
-  StyioDictI64* dict = as_dict_i64(h, true);
-  if (dict == nullptr) {
-    return 0;
-  }
-  if (key == nullptr) {
-    set_runtime_error_once(kRuntimeSubcodeDictKey, "dict key is null");
-    return 0;
-  }
-  int64_t value = 0;
-  if (dict_try_get(dict, key, value)) {
-    return value;
-  }
-  set_runtime_error_once(
-    kRuntimeSubcodeDictKey,
-    std::string("dict key not found: ") + key);
-  return 0;
+  return dict_get_checked(as_dict_i64(h, true), key, int64_t(0), [](int64_t value) { return value; });
+}
+
+extern "C" DLLEXPORT int64_t
+styio_dict_get_i64_keyid(int64_t h, int64_t key_id) {
+  return dict_get_checked(as_dict_i64(h, true), key_id, int64_t(0), [](int64_t value) { return value; });
 }
 
 extern "C" DLLEXPORT double
 styio_dict_get_f64(int64_t h, const char* key) {
-  StyioDictF64* dict = as_dict_f64(h, true);
-  if (dict == nullptr) {
-    return 0.0;
-  }
-  if (key == nullptr) {
-    set_runtime_error_once(kRuntimeSubcodeDictKey, "dict key is null");
-    return 0.0;
-  }
-  double value = 0.0;
-  if (dict_try_get(dict, key, value)) {
-    return value;
-  }
-  set_runtime_error_once(
-    kRuntimeSubcodeDictKey,
-    std::string("dict key not found: ") + key);
-  return 0.0;
+  return dict_get_checked(as_dict_f64(h, true), key, 0.0, [](double value) { return value; });
+}
+
+extern "C" DLLEXPORT double
+styio_dict_get_f64_keyid(int64_t h, int64_t key_id) {
+  return dict_get_checked(as_dict_f64(h, true), key_id, 0.0, [](double value) { return value; });
 }
 
 extern "C" DLLEXPORT const char*
 styio_dict_get_cstr(int64_t h, const char* key) {
-  StyioDictString* dict = as_dict_string(h, true);
-  if (dict == nullptr) {
-    return nullptr;
-  }
-  if (key == nullptr) {
-    set_runtime_error_once(kRuntimeSubcodeDictKey, "dict key is null");
-    return nullptr;
-  }
-  std::string value;
-  if (dict_try_get(dict, key, value)) {
-    return copy_to_owned_cstr(value);
-  }
-  set_runtime_error_once(
-    kRuntimeSubcodeDictKey,
-    std::string("dict key not found: ") + key);
-  return nullptr;
+  return dict_get_checked(
+    as_dict_string(h, true), key, static_cast<const char*>(nullptr),
+    [](const std::string& value) { return copy_to_owned_cstr(value); });
+}
+
+extern "C" DLLEXPORT const char*
+styio_dict_get_cstr_keyid(int64_t h, int64_t key_id) {
+  return dict_get_checked(
+    as_dict_string(h, true), key_id, static_cast<const char*>(nullptr),
+    [](const std::string& value) { return copy_to_owned_cstr(value); });
 }
 
 extern "C" DLLEXPORT int64_t
 styio_dict_get_list(int64_t h, const char* key) {
-  StyioDictListHandle* dict = as_dict_list(h, true);
-  if (dict == nullptr) {
-    return 0;
-  }
-  if (key == nullptr) {
-    set_runtime_error_once(kRuntimeSubcodeDictKey, "dict key is null");
-    return 0;
-  }
-  int64_t value = 0;
-  if (dict_try_get(dict, key, value)) {
-    return clone_list_handle_value(value);
-  }
-  set_runtime_error_once(
-    kRuntimeSubcodeDictKey,
-    std::string("dict key not found: ") + key);
-  return 0;
+  return dict_get_checked(as_dict_list(h, true), key, int64_t(0), clone_list_handle_value);
+}
+
+extern "C" DLLEXPORT int64_t
+styio_dict_get_list_keyid(int64_t h, int64_t key_id) {
+  return dict_get_checked(as_dict_list(h, true), key_id, int64_t(0), clone_list_handle_value);
 }
 
 extern "C" DLLEXPORT int64_t
 styio_dict_get_dict(int64_t h, const char* key) {
-  StyioDictDictHandle* dict = as_dict_dict(h, true);
-  if (dict == nullptr) {
-    return 0;
-  }
-  if (key == nullptr) {
-    set_runtime_error_once(kRuntimeSubcodeDictKey, "dict key is null");
-    return 0;
-  }
-  int64_t value = 0;
-  if (dict_try_get(dict, key, value)) {
-    return clone_dict_handle_value(value);
-  }
-  set_runtime_error_once(
-    kRuntimeSubcodeDictKey,
-    std::string("dict key not found: ") + key);
-  return 0;
+  return dict_get_checked(as_dict_dict(h, true), key, int64_t(0), clone_dict_handle_value);
+}
+
+extern "C" DLLEXPORT int64_t
+styio_dict_get_dict_keyid(int64_t h, int64_t key_id) {
+  return dict_get_checked(as_dict_dict(h, true), key_id, int64_t(0), clone_dict_handle_value);
 }
 
 extern "C" DLLEXPORT void
 styio_dict_set_bool(int64_t h, const char* key, int64_t value) {
-  StyioDictBool* dict = as_dict_bool(h, true);
-  if (dict == nullptr) {
-    return;
-  }
-  if (key == nullptr) {
-    set_runtime_error_once(kRuntimeSubcodeDictKey, "dict key is null");
-    return;
-  }
-  dict_set(dict, key, value != 0 ? 1 : 0);
+  dict_set_checked(as_dict_bool(h, true), key, value != 0 ? int64_t(1) : int64_t(0));
+}
+
+extern "C" DLLEXPORT void
+styio_dict_set_bool_keyid(int64_t h, int64_t key_id, int64_t value) {
+  dict_set_checked(as_dict_bool(h, true), key_id, value != 0 ? int64_t(1) : int64_t(0));
 }
 
 extern "C" DLLEXPORT void
 styio_dict_set_i64(int64_t h, const char* key, int64_t value) {
-  StyioDictI64* dict = as_dict_i64(h, true);
-  if (dict == nullptr) {
-    return;
-  }
-  if (key == nullptr) {
-    set_runtime_error_once(kRuntimeSubcodeDictKey, "dict key is null");
-    return;
-  }
-  dict_set(dict, key, value);
+  dict_set_checked(as_dict_i64(h, true), key, value);
+}
+
+extern "C" DLLEXPORT void
+styio_dict_set_i64_keyid(int64_t h, int64_t key_id, int64_t value) {
+  dict_set_checked(as_dict_i64(h, true), key_id, value);
 }
 
 extern "C" DLLEXPORT void
 styio_dict_set_f64(int64_t h, const char* key, double value) {
-  StyioDictF64* dict = as_dict_f64(h, true);
-  if (dict == nullptr) {
-    return;
-  }
-  if (key == nullptr) {
-    set_runtime_error_once(kRuntimeSubcodeDictKey, "dict key is null");
-    return;
-  }
-  dict_set(dict, key, value);
+  dict_set_checked(as_dict_f64(h, true), key, value);
+}
+
+extern "C" DLLEXPORT void
+styio_dict_set_f64_keyid(int64_t h, int64_t key_id, double value) {
+  dict_set_checked(as_dict_f64(h, true), key_id, value);
 }
 
 extern "C" DLLEXPORT void
 styio_dict_set_cstr(int64_t h, const char* key, const char* value) {
-  StyioDictString* dict = as_dict_string(h, true);
-  if (dict == nullptr) {
-    return;
-  }
-  if (key == nullptr) {
-    set_runtime_error_once(kRuntimeSubcodeDictKey, "dict key is null");
-    return;
-  }
-  const std::string stored = value == nullptr ? std::string() : std::string(value);
-  dict_set(dict, key, stored);
+  dict_set_checked(as_dict_string(h, true), key, value == nullptr ? std::string() : std::string(value));
+}
+
+extern "C" DLLEXPORT void
+styio_dict_set_cstr_keyid(int64_t h, int64_t key_id, const char* value) {
+  dict_set_checked(as_dict_string(h, true), key_id, value == nullptr ? std::string() : std::string(value));
 }
 
 extern "C" DLLEXPORT void
 styio_dict_set_list(int64_t h, const char* key, int64_t value) {
-  StyioDictListHandle* dict = as_dict_list(h, true);
-  if (dict == nullptr) {
-    return;
-  }
-  if (key == nullptr) {
-    set_runtime_error_once(kRuntimeSubcodeDictKey, "dict key is null");
-    return;
-  }
-  int64_t stored = clone_list_handle_value(value);
-  dict_set_handle(
-    dict,
-    key,
-    stored,
-    [](int64_t existing) {
-      (void)g_handle_table.release(existing, StyioHandleTable::HandleKind::List, close_list);
-    });
+  dict_set_list_checked(as_dict_list(h, true), key, value);
+}
+
+extern "C" DLLEXPORT void
+styio_dict_set_list_keyid(int64_t h, int64_t key_id, int64_t value) {
+  dict_set_list_checked(as_dict_list(h, true), key_id, value);
 }
 
 extern "C" DLLEXPORT void
 styio_dict_set_dict(int64_t h, const char* key, int64_t value) {
-  StyioDictDictHandle* dict = as_dict_dict(h, true);
-  if (dict == nullptr) {
-    return;
-  }
-  if (key == nullptr) {
-    set_runtime_error_once(kRuntimeSubcodeDictKey, "dict key is null");
-    return;
-  }
-  int64_t stored = clone_dict_handle_value(value);
-  dict_set_handle(
-    dict,
-    key,
-    stored,
-    [](int64_t existing) {
-      (void)g_handle_table.release(existing, StyioHandleTable::HandleKind::Dict, close_dict);
-    });
+  dict_set_dict_checked(as_dict_dict(h, true), key, value);
+}
+
+extern "C" DLLEXPORT void
+styio_dict_set_dict_keyid(int64_t h, int64_t key_id, int64_t value) {
+  dict_set_dict_checked(as_dict_dict(h, true), key_id, value);
+}
+
+extern "C" DLLEXPORT int64_t
+styio_idict_new_bool() {
+  return stash_dict(make_dict_storage_for_current_backend<StyioIntDictBool>());
+}
+
+extern "C" DLLEXPORT int64_t
+styio_idict_new_i64() {
+  return stash_dict(make_dict_storage_for_current_backend<StyioIntDictI64>());
+}
+
+extern "C" DLLEXPORT int64_t
+styio_idict_new_f64() {
+  return stash_dict(make_dict_storage_for_current_backend<StyioIntDictF64>());
+}
+
+extern "C" DLLEXPORT int64_t
+styio_idict_new_cstr() {
+  return stash_dict(make_dict_storage_for_current_backend<StyioIntDictString>());
+}
+
+extern "C" DLLEXPORT int64_t
+styio_idict_new_list() {
+  return stash_dict(make_dict_storage_for_current_backend<StyioIntDictListHandle>());
+}
+
+extern "C" DLLEXPORT int64_t
+styio_idict_new_dict() {
+  return stash_dict(make_dict_storage_for_current_backend<StyioIntDictDictHandle>());
+}
+
+extern "C" DLLEXPORT int64_t
+styio_idict_get_bool(int64_t h, int64_t key) {
+  return dict_get_checked(as_dict_storage<StyioIntDictBool>(h, true), key, int64_t(0), [](int64_t value) {
+    return value != 0 ? int64_t(1) : int64_t(0);
+  });
 }
 
+extern "C" DLLEXPORT int64_t
+styio_idict_get_i64(int64_t h, int64_t key) {
+  return dict_get_checked(as_dict_storage<StyioIntDictI64>(h, true), key, int64_t(0), [](int64_t value) { return value; });
+}
+
+extern "C" DLLEXPORT double
+styio_idict_get_f64(int64_t h, int64_t key) {
+  return dict_get_checked(as_dict_storage<StyioIntDictF64>(h, true), key, 0.0, [](double value) { return value; });
+}
+
+extern "C" DLLEXPORT const char*
+styio_idict_get_cstr(int64_t h, int64_t key) {
+  return dict_get_checked(
+    as_dict_storage<StyioIntDictString>(h, true), key, static_cast<const char*>(nullptr),
+    [](const std::string& value) { return copy_to_owned_cstr(value); });
+}
+
+extern "C" DLLEXPORT int64_t
+styio_idict_get_list(int64_t h, int64_t key) {
+  return dict_get_checked(as_dict_storage<StyioIntDictListHandle>(h, true), key, int64_t(0), clone_list_handle_value);
+}
+
+extern "C" DLLEXPORT int64_t
+styio_idict_get_dict(int64_t h, int64_t key) {
+  return dict_get_checked(as_dict_storage<StyioIntDictDictHandle>(h, true), key, int64_t(0), clone_dict_handle_value);
+}
+
+extern "C" DLLEXPORT void
+styio_idict_set_bool(int64_t h, int64_t key, int64_t value) {
+  dict_set_checked(as_dict_storage<StyioIntDictBool>(h, true), key, value != 0 ? int64_t(1) : int64_t(0));
+}
+
+extern "C" DLLEXPORT void
+styio_idict_set_i64(int64_t h, int64_t key, int64_t value) {
+  dict_set_checked(as_dict_storage<StyioIntDictI64>(h, true), key, value);
+}
+
+extern "C" DLLEXPORT void
+styio_idict_set_f64(int64_t h, int64_t key, double value) {
+  dict_set_checked(as_dict_storage<StyioIntDictF64>(h, true), key, value);
+}
+
+extern "C" DLLEXPORT void
+styio_idict_set_cstr(int64_t h, int64_t key, const char* value) {
+  dict_set_checked(as_dict_storage<StyioIntDictString>(h, true), key, value == nullptr ? std::string() : std::string(value));
+}
+
+extern "C" DLLEXPORT void
+styio_idict_set_list(int64_t h, int64_t key, int64_t value) {
+  dict_set_list_checked(as_dict_storage<StyioIntDictListHandle>(h, true), key, value);
+}
+
+extern "C" DLLEXPORT void
+styio_idict_set_dict(int64_t h, int64_t key, int64_t value) {
+  dict_set_dict_checked(as_dict_storage<StyioIntDictDictHandle>(h, true), key, value);
+}
+
+/* list[string] for string-keyed dicts, list[i64] for i64-keyed ones. */
 extern "C" DLLEXPORT int64_t
 styio_dict_keys(int64_t h) {
   StyioDictBase* dict = as_dict_base(h, true);
   if (dict == nullptr) {
     return 0;
   }
-  auto* keys = new StyioListString();
-  switch (dict->value_kind) {
-    case StyioDictValueKind::Bool:
-      keys->elems.reserve(static_cast<StyioDictBool*>(dict)->entries.size());
-      for (const auto& entry : static_cast<StyioDictBool*>(dict)->entries) {
-        keys->elems.push_back(entry.first);
-      }
-      break;
-    case StyioDictValueKind::I64:
-      keys->elems.reserve(static_cast<StyioDictI64*>(dict)->entries.size());
-      for (const auto& entry : static_cast<StyioDictI64*>(dict)->entries) {
-        keys->elems.push_back(entry.first);
-      }
-      break;
-    case StyioDictValueKind::F64:
-      keys->elems.reserve(static_cast<StyioDictF64*>(dict)->entries.size());
-      for (const auto& entry : static_cast<StyioDictF64*>(dict)->entries) {
-        keys->elems.push_back(entry.first);
-      }
-      break;
-    case StyioDictValueKind::String:
-      keys->elems.reserve(static_cast<StyioDictString*>(dict)->entries.size());
-      for (const auto& entry : static_cast<StyioDictString*>(dict)->entries) {
-        keys->elems.push_back(entry.first);
-      }
-      break;
-    case StyioDictValueKind::ListHandle:
-      keys->elems.reserve(static_cast<StyioDictListHandle*>(dict)->entries.size());
-      for (const auto& entry : static_cast<StyioDictListHandle*>(dict)->entries) {
-        keys->elems.push_back(entry.first);
-      }
-      break;
-    case StyioDictValueKind::DictHandle:
-      keys->elems.reserve(static_cast<StyioDictDictHandle*>(dict)->entries.size());
-      for (const auto& entry : static_cast<StyioDictDictHandle*>(dict)->entries) {
-        keys->elems.push_back(entry.first);
-      }
-      break;
-  }
-  return stash_list(keys);
+  return visit_dict(dict, [](auto* values) -> int64_t {
+    using DictT = std::remove_pointer_t<decltype(values)>;
+    using KeyListT = std::conditional_t<DictT::kKeyKind == StyioDictKeyKind::I64, StyioListI64, StyioListString>;
+    auto* keys = new KeyListT();
+    keys->elems.reserve(values->entries.size());
+    for (const auto& entry : values->entries) {
+      keys->elems.push_back(entry.first);
+    }
+    return stash_list(keys);
+  });
 }
 
 extern "C" DLLEXPORT int64_t
 styio_dict_values_bool(int64_t h) {
-  StyioDictBool* dict = as_dict_bool(h, true);
-  if (dict == nullptr) {
-    return 0;
-  }
-  auto* values = new StyioListBool();
-  values->elems.reserve(dict->entries.size());
-  for (const auto& entry : dict->entries) {
-    values->elems.push_back(entry.second);
-  }
-  return stash_list(values);
+  return dict_values_list<StyioListBool, StyioDictValueKind::Bool>(h, [](int64_t value) { return value; });
 }
 
 extern "C" DLLEXPORT int64_t
 styio_dict_values_i64(int64_t h) {
-  StyioDictI64* dict = as_dict_i64(h, true);
-  if (dict == nullptr) {
-    return 0;
-  }
-  auto* values = new StyioListI64();
-  values->elems.reserve(dict->entries.size());
-  for (const auto& entry : dict->entries) {
-    values->elems.push_back(entry.second);
-  }
-  return stash_list(values);
+  return dict_values_list<StyioListI64, StyioDictValueKind::I64>(h, [](int64_t value) { return value; });
 }
 
 extern "C" DLLEXPORT int64_t
 styio_dict_values_f64(int64_t h) {
-  StyioDictF64* dict = as_dict_f64(h, true);
-  if (dict == nullptr) {
-    return 0;
-  }
-  auto* values = new StyioListF64();
-  values->elems.reserve(dict->entries.size());
-  for (const auto& entry : dict->entries) {
-    values->elems.push_back(entry.second);
-  }
-  return stash_list(values);
+  return dict_values_list<StyioListF64, StyioDictValueKind::F64>(h, [](double value) { return value; });
 }
 
 extern "C" DLLEXPORT int64_t
 styio_dict_values_cstr(int64_t h) {
-  StyioDictString* dict = as_dict_string(h, true);
-  if (dict == nullptr) {
-    return 0;
-  }
-  auto* values = new StyioListString();
-  values->elems.reserve(dict->entries.size());
-  for (const auto& entry : dict->entries) {
-    values->elems.push_back(entry.second);
-  }
-  return stash_list(values);
+  return dict_values_list<StyioListString, StyioDictValueKind::String>(
+    h,
+    [](const std::string& value) { return value; });
 }
 
 extern "C" DLLEXPORT int64_t
 styio_dict_values_list(int64_t h) {
-  StyioDictListHandle* dict = as_dict_list(h, true);
-  if (dict == nullptr) {
-    return 0;
-  }
-  auto* values = new StyioListListHandle();
-  values->elems.reserve(dict->entries.size());
-  for (const auto& entry : dict->entries) {
-    values->elems.push_back(clone_list_handle_value(entry.second));
-  }
-  return stash_list(values);
+  return dict_values_list<StyioListListHandle, StyioDictValueKind::ListHandle>(h, clone_list_handle_value);
 }
 
 extern "C" DLLEXPORT int64_t
 styio_dict_values_dict(int64_t h) {
-  StyioDictDictHandle* dict = as_dict_dict(h, true);
-  if (dict == nullptr) {
-    return 0;
-  }
-  auto* values = new StyioListDictHandle();
-  values->elems.reserve(dict->entries.size());
-  for (const auto& entry : dict->entries) {
-    values->elems.push_back(clone_dict_handle_value(entry.second));
-  }
-  return stash_list(values);
+  return dict_values_list<StyioListDictHandle, StyioDictValueKind::DictHandle>(h, clone_dict_handle_value);
 }
 
 extern "C" DLLEXPORT const char*
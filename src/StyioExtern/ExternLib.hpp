@@ -12,14 +12,63 @@
 extern "C" DLLEXPORT int64_t styio_file_open(const char* path);
 extern "C" DLLEXPORT int64_t styio_file_open_auto(const char* path);
 extern "C" DLLEXPORT int64_t styio_file_open_write(const char* path);
+/* Cached append handle for `<< @file{...}`: one per path, buffered, valid until
+   styio_file_release_writes() (emitted after the outermost writing loop and at program end). */
+extern "C" DLLEXPORT int64_t styio_file_acquire_write(const char* path);
+extern "C" DLLEXPORT void styio_file_release_writes();
 extern "C" DLLEXPORT void styio_file_close(int64_t h);
 extern "C" DLLEXPORT void styio_file_rewind(int64_t h);
-/* Borrowed pointer backed by thread-local buffers; valid until next read call on this thread. */
+/* Borrowed pointer into the handle's block buffer (no line-length limit, trailing CR/LF
+   stripped); valid until the next read or rewind on the same handle. */
 /* Caller must NOT pass the return value to styio_free_cstr. */
 extern "C" DLLEXPORT const char* styio_file_read_line(int64_t h);
 extern "C" DLLEXPORT void styio_file_write_cstr(int64_t h, const char* data);
 extern "C" DLLEXPORT int64_t styio_cstr_to_i64(const char* s);
+/* Out-of-line strtoll path behind the inlinable styio_cstr_to_i64 fast path. */
+extern "C" DLLEXPORT int64_t styio_cstr_to_i64_slow(const char* s);
 extern "C" DLLEXPORT double styio_cstr_to_f64(const char* s);
+/*
+  Fused line read + parse for numeric line streams. Returns the same borrowed line as
+  styio_file_read_line (null at end of input); `*parsed` is 1 when the whole line is a
+  plain decimal and `*value` holds it. On 0 the caller falls back to styio_cstr_to_i64 /
+  styio_cstr_to_f64 on the returned line, which accepts or diagnoses the remaining forms.
+*/
+extern "C" DLLEXPORT const char* styio_file_read_i64(int64_t h, int64_t* value, int64_t* parsed);
+extern "C" DLLEXPORT const char* styio_file_read_f64(int64_t h, double* value, int64_t* parsed);
+/* Parse up to `cap` lines into `dst`; returns how many were stored (0 at end of input).
+   Stops early on the first line that does not parse, with the runtime error set. */
+extern "C" DLLEXPORT int64_t styio_file_read_i64_batch(int64_t h, int64_t* dst, int64_t cap);
+extern "C" DLLEXPORT int64_t styio_file_read_f64_batch(int64_t h, double* dst, int64_t cap);
+
+/*
+  Columnar CSV source for `#(row: csv)` loops. `columns` lists the projected header
+  columns, one "<i64|f64|str>:<name>" per line; the column index is the line number.
+  styio_csv_next_batch() parses the next batch and returns its row count (0 at end);
+  the column arrays hold that many entries and stay valid until the next batch.
+*/
+extern "C" DLLEXPORT int64_t styio_csv_open(const char* path, const char* columns);
+extern "C" DLLEXPORT int64_t styio_csv_next_batch(int64_t h);
+extern "C" DLLEXPORT const int64_t* styio_csv_column_i64(int64_t h, int64_t col);
+extern "C" DLLEXPORT const double* styio_csv_column_f64(int64_t h, int64_t col);
+extern "C" DLLEXPORT const char* const* styio_csv_column_cstr(int64_t h, int64_t col);
+extern "C" DLLEXPORT void styio_csv_close(int64_t h);
+
+/*
+  `@col{...}` typed columnar files (see StyioRuntime/ColumnarFile.hpp). Column specs are
+  "<i64|f64|bool|str>:<name>" lines. A reader is mapped once; styio_col_data() points at
+  the values of bound column `col` (for str: uint64_t offsets into styio_col_strings()).
+  Writers are cached per path and write their file in styio_file_release_writes().
+*/
+extern "C" DLLEXPORT int64_t styio_col_open(const char* path, const char* columns);
+extern "C" DLLEXPORT int64_t styio_col_rows(int64_t h);
+extern "C" DLLEXPORT const void* styio_col_data(int64_t h, int64_t col);
+extern "C" DLLEXPORT const char* styio_col_strings(int64_t h, int64_t col);
+extern "C" DLLEXPORT void styio_col_close(int64_t h);
+extern "C" DLLEXPORT int64_t styio_col_acquire_write(const char* path, const char* columns);
+extern "C" DLLEXPORT void styio_col_write_i64(int64_t h, int64_t col, int64_t value);
+extern "C" DLLEXPORT void styio_col_write_f64(int64_t h, int64_t col, double value);
+extern "C" DLLEXPORT void styio_col_write_bool(int64_t h, int64_t col, int64_t value);
+extern "C" DLLEXPORT void styio_col_write_cstr(int64_t h, int64_t col, const char* value);
 
 /* M7: first line of file as integer; string concat (malloc result). */
 extern "C" DLLEXPORT int64_t styio_read_file_i64line(const char* path);
@@ -31,13 +80,34 @@ extern "C" DLLEXPORT void styio_free_cstr(const char* s);
 extern "C" DLLEXPORT const char* styio_i64_dec_cstr(int64_t v);
 extern "C" DLLEXPORT const char* styio_f64_dec_cstr(double v);
 extern "C" DLLEXPORT int styio_runtime_has_error();
+/*
+  Address of the calling thread's error flag (non-zero once a helper failed). Generated
+  code fetches it once per function and tests it after each helper call, instead of
+  calling styio_runtime_has_error() every time. Valid for the lifetime of the thread.
+*/
+extern "C" DLLEXPORT int32_t* styio_runtime_error_word();
 /* Borrowed pointer to last runtime error message; null when no runtime error is set. */
 extern "C" DLLEXPORT const char* styio_runtime_last_error();
 /* Borrowed pointer to last runtime error subcode; null when no runtime error is set. */
 extern "C" DLLEXPORT const char* styio_runtime_last_error_subcode();
 extern "C" DLLEXPORT void styio_runtime_clear_error();
+/* Close every file/list/dict handle, free styio-owned strings and clear the error state.
+   Invalidates all handles and borrowed pointers handed out so far on this thread. */
+extern "C" DLLEXPORT void styio_runtime_reset();
 using StyioRuntimeLogSink = void (*)(const char* stream, const char* message);
 extern "C" DLLEXPORT void styio_runtime_set_log_sink(StyioRuntimeLogSink sink);
+/* Select when styio_stdout_write_cstr / styio_stderr_write_cstr flush: "line" (default),
+   "block:<bytes>", "interval:<ms>" or "exit". Returns 0 and keeps the current policy when
+   the text is not one of those. Output is flushed on runtime error, reset and exit. */
+extern "C" DLLEXPORT int styio_runtime_set_output_flush(const char* policy);
+extern "C" DLLEXPORT void styio_runtime_flush_output();
+/* How styio_file_open reads regular files: "auto" (default; memory-map files of 4 MiB or
+   more), "stream" (block reader) or "mmap" (map whenever possible). Pipes and devices
+   always stream. Returns 0 and keeps the current mode for any other text. */
+extern "C" DLLEXPORT int styio_runtime_set_file_source(const char* mode);
+/* AOT entry epilogue: flush output, print a pending runtime error as "[RuntimeError] ..." on stderr,
+   and return the driver's exit code for it (0 or 5). */
+extern "C" DLLEXPORT int styio_runtime_report_exit();
 
 /* M9+: write to stdout / stderr */
 extern "C" DLLEXPORT void styio_stdout_write_cstr(const char* s);
@@ -85,6 +155,18 @@ extern "C" DLLEXPORT void styio_list_pop(int64_t h);
 extern "C" DLLEXPORT const char* styio_list_to_cstr(int64_t h);
 extern "C" DLLEXPORT void styio_list_release(int64_t h);
 extern "C" DLLEXPORT int64_t styio_list_active_count();
+/*
+  Borrowed element storage of a list[i64] / list[f64] / list[bool] (bools as 0/1 int64),
+  with the length stored to `*len`. The span stays valid until the thread's list epoch
+  changes: any push, insert or pop on a list, or a list release. Returns nullptr (and
+  `*len` = 0) for an invalid handle or another element kind, without raising an error;
+  an empty list yields a non-null pointer. These only read runtime state and write `*len`.
+*/
+extern "C" DLLEXPORT const int64_t* styio_list_span_i64(int64_t h, int64_t* len);
+extern "C" DLLEXPORT const double* styio_list_span_f64(int64_t h, int64_t* len);
+extern "C" DLLEXPORT const int64_t* styio_list_span_bool(int64_t h, int64_t* len);
+/* Address of the calling thread's list epoch (see above). Valid for the lifetime of the thread. */
+extern "C" DLLEXPORT const uint64_t* styio_list_epoch_word();
 
 extern "C" DLLEXPORT int64_t styio_dict_new_bool();
 extern "C" DLLEXPORT int64_t styio_dict_new_i64();
@@ -106,6 +188,46 @@ extern "C" DLLEXPORT void styio_dict_set_f64(int64_t h, const char* key, double
 extern "C" DLLEXPORT void styio_dict_set_cstr(int64_t h, const char* key, const char* value);
 extern "C" DLLEXPORT void styio_dict_set_list(int64_t h, const char* key, int64_t value);
 extern "C" DLLEXPORT void styio_dict_set_dict(int64_t h, const char* key, int64_t value);
+/*
+  Stable id (> 0) for `key`, with its hash computed once; the same text always gets the
+  same id on a thread. Generated code interns literal dict keys at the top of `main` and
+  calls the *_keyid variants below, which behave like the const char* ones.
+*/
+extern "C" DLLEXPORT int64_t styio_key_intern(const char* key);
+extern "C" DLLEXPORT int64_t styio_dict_get_bool_keyid(int64_t h, int64_t key_id);
+extern "C" DLLEXPORT int64_t styio_dict_get_i64_keyid(int64_t h, int64_t key_id);
+extern "C" DLLEXPORT double styio_dict_get_f64_keyid(int64_t h, int64_t key_id);
+extern "C" DLLEXPORT const char* styio_dict_get_cstr_keyid(int64_t h, int64_t key_id);
+extern "C" DLLEXPORT int64_t styio_dict_get_list_keyid(int64_t h, int64_t key_id);
+extern "C" DLLEXPORT int64_t styio_dict_get_dict_keyid(int64_t h, int64_t key_id);
+extern "C" DLLEXPORT void styio_dict_set_bool_keyid(int64_t h, int64_t key_id, int64_t value);
+extern "C" DLLEXPORT void styio_dict_set_i64_keyid(int64_t h, int64_t key_id, int64_t value);
+extern "C" DLLEXPORT void styio_dict_set_f64_keyid(int64_t h, int64_t key_id, double value);
+extern "C" DLLEXPORT void styio_dict_set_cstr_keyid(int64_t h, int64_t key_id, const char* value);
+extern "C" DLLEXPORT void styio_dict_set_list_keyid(int64_t h, int64_t key_id, int64_t value);
+extern "C" DLLEXPORT void styio_dict_set_dict_keyid(int64_t h, int64_t key_id, int64_t value);
+/*
+  dict[i64, V]: same storage backends and handle entry points (len, keys, values, clone,
+  release, to_cstr) as string-keyed dicts; keys are passed and stored as integers.
+*/
+extern "C" DLLEXPORT int64_t styio_idict_new_bool();
+extern "C" DLLEXPORT int64_t styio_idict_new_i64();
+extern "C" DLLEXPORT int64_t styio_idict_new_f64();
+extern "C" DLLEXPORT int64_t styio_idict_new_cstr();
+extern "C" DLLEXPORT int64_t styio_idict_new_list();
+extern "C" DLLEXPORT int64_t styio_idict_new_dict();
+extern "C" DLLEXPORT int64_t styio_idict_get_bool(int64_t h, int64_t key);
+extern "C" DLLEXPORT int64_t styio_idict_get_i64(int64_t h, int64_t key);
+extern "C" DLLEXPORT double styio_idict_get_f64(int64_t h, int64_t key);
+extern "C" DLLEXPORT const char* styio_idict_get_cstr(int64_t h, int64_t key);
+extern "C" DLLEXPORT int64_t styio_idict_get_list(int64_t h, int64_t key);
+extern "C" DLLEXPORT int64_t styio_idict_get_dict(int64_t h, int64_t key);
+extern "C" DLLEXPORT void styio_idict_set_bool(int64_t h, int64_t key, int64_t value);
+extern "C" DLLEXPORT void styio_idict_set_i64(int64_t h, int64_t key, int64_t value);
+extern "C" DLLEXPORT void styio_idict_set_f64(int64_t h, int64_t key, double value);
+extern "C" DLLEXPORT void styio_idict_set_cstr(int64_t h, int64_t key, const char* value);
+extern "C" DLLEXPORT void styio_idict_set_list(int64_t h, int64_t key, int64_t value);
+extern "C" DLLEXPORT void styio_idict_set_dict(int64_t h, int64_t key, int64_t value);
 extern "C" DLLEXPORT int64_t styio_dict_keys(int64_t h);
 extern "C" DLLEXPORT int64_t styio_dict_values_bool(int64_t h);
 extern "C" DLLEXPORT int64_t styio_dict_values_i64(int64_t h);
@@ -480,13 +480,19 @@ public:
 
   std::vector<Entry> entries;
   std::string value_type = "i64";
+  /* "string" or "i64"; i64 keys lower to the styio_idict_* helpers. */
+  std::string key_type = "string";
 
-  SGDictLiteral(std::vector<Entry> e, std::string vt) :
-      entries(std::move(e)), value_type(std::move(vt)) {
+  SGDictLiteral(std::vector<Entry> e, std::string vt, std::string kt) :
+      entries(std::move(e)), value_type(std::move(vt)), key_type(std::move(kt)) {
   }
 
-  static SGDictLiteral* Create(std::vector<Entry> e, std::string value_type = "i64") {
-    return new SGDictLiteral(std::move(e), std::move(value_type));
+  static SGDictLiteral* Create(
+    std::vector<Entry> e,
+    std::string value_type = "i64",
+    std::string key_type = "string"
+  ) {
+    return new SGDictLiteral(std::move(e), std::move(value_type), std::move(key_type));
   }
 };
 
@@ -807,16 +813,19 @@ class SGFileLineIter : public StyioIRTraits<SGFileLineIter>
 public:
   bool from_path = true;
   StyioIR* path_expr = nullptr;
+  /* `@{...}`: opened with styio_file_open_auto, which decompresses gzip/zstd input. */
+  bool is_auto = false;
   std::string handle_var;
   std::string line_var;
   SGBlock* body = nullptr;
   std::unique_ptr<SGPulsePlan> pulse_plan;
   int pulse_region_id = -1;
 
-  static SGFileLineIter* CreateFromPath(StyioIR* path, std::string line, SGBlock* b) {
+  static SGFileLineIter* CreateFromPath(StyioIR* path, std::string line, SGBlock* b, bool is_auto = false) {
     auto* r = new SGFileLineIter();
     r->from_path = true;
     r->path_expr = path;
+    r->is_auto = is_auto;
     r->line_var = std::move(line);
     r->body = b;
     return r;
@@ -839,6 +848,105 @@ private:
   SGFileLineIter() = default;
 };
 
+/*
+  `@file{...} >> #(row: csv) => {...}`: rows come from columnar batches (styio_csv_*).
+  `columns` is the projection type inference collected from `row["..."]` in the body,
+  in column index order; numeric columns are parsed to f64 by the runtime, the rest
+  are handed out as strings.
+*/
+class SGCsvIter : public StyioIRTraits<SGCsvIter>
+{
+public:
+  struct Column
+  {
+    std::string name;
+    /* "i64", "f64" or "str": how the runtime parses the cells. */
+    std::string type;
+  };
+
+  StyioIR* path_expr = nullptr;
+  std::string row_var;
+  std::vector<Column> columns;
+  SGBlock* body = nullptr;
+
+  SGCsvIter(StyioIR* path, std::string row, std::vector<Column> cols, SGBlock* b) :
+      path_expr(path), row_var(std::move(row)), columns(std::move(cols)), body(b) {
+  }
+
+  static SGCsvIter* Create(StyioIR* path, std::string row, std::vector<Column> cols, SGBlock* b) {
+    return new SGCsvIter(path, std::move(row), std::move(cols), b);
+  }
+};
+
+/* `row["name"]` in an SGCsvIter body: the current row's cell of projected column `column`. */
+class SGCsvField : public StyioIRTraits<SGCsvField>
+{
+public:
+  std::string row_var;
+  int column = 0;
+  /* The column's SGCsvIter::Column::type. */
+  std::string type;
+
+  SGCsvField(std::string row, int col, std::string ty) :
+      row_var(std::move(row)), column(col), type(std::move(ty)) {
+  }
+
+  static SGCsvField* Create(std::string row, int col, std::string ty) {
+    return new SGCsvField(std::move(row), col, std::move(ty));
+  }
+};
+
+/*
+  `@col{...} >> #(a: i64, b: str) => {...}`: each parameter is the file column of the
+  same name (see styio_col_open), read in place from the mapped file. `type` is the
+  columnar type name: "i64", "f64", "bool" or "str".
+*/
+class SGColumnarIter : public StyioIRTraits<SGColumnarIter>
+{
+public:
+  struct Column
+  {
+    std::string name;
+    std::string type;
+  };
+
+  StyioIR* path_expr = nullptr;
+  std::vector<Column> columns;
+  SGBlock* body = nullptr;
+
+  SGColumnarIter(StyioIR* path, std::vector<Column> cols, SGBlock* b) :
+      path_expr(path), columns(std::move(cols)), body(b) {
+  }
+
+  static SGColumnarIter* Create(StyioIR* path, std::vector<Column> cols, SGBlock* b) {
+    return new SGColumnarIter(path, std::move(cols), b);
+  }
+};
+
+/* `expr << @col{...}`: appends one row. A `dict{"name": v, ...}` literal gives one column
+   per key; any other value is the single column "value". */
+class SGColumnarWrite : public StyioIRTraits<SGColumnarWrite>
+{
+public:
+  struct Column
+  {
+    std::string name;
+    std::string type;
+    StyioIR* value = nullptr;
+  };
+
+  StyioIR* path_expr = nullptr;
+  std::vector<Column> columns;
+
+  SGColumnarWrite(StyioIR* path, std::vector<Column> cols) :
+      path_expr(path), columns(std::move(cols)) {
+  }
+
+  static SGColumnarWrite* Create(StyioIR* path, std::vector<Column> cols) {
+    return new SGColumnarWrite(path, std::move(cols));
+  }
+};
+
 class SGStreamZip : public StyioIRTraits<SGStreamZip>
 {
 public:
@@ -1048,13 +1156,19 @@ public:
   StyioIR* dict = nullptr;
   StyioIR* key = nullptr;
   std::string value_type = "i64";
+  std::string key_type = "string";
 
-  SGDictGet(StyioIR* d, StyioIR* k, std::string vt) :
-      dict(d), key(k), value_type(std::move(vt)) {
+  SGDictGet(StyioIR* d, StyioIR* k, std::string vt, std::string kt) :
+      dict(d), key(k), value_type(std::move(vt)), key_type(std::move(kt)) {
   }
 
-  static SGDictGet* Create(StyioIR* d, StyioIR* k, std::string value_type = "i64") {
-    return new SGDictGet(d, k, std::move(value_type));
+  static SGDictGet* Create(
+    StyioIR* d,
+    StyioIR* k,
+    std::string value_type = "i64",
+    std::string key_type = "string"
+  ) {
+    return new SGDictGet(d, k, std::move(value_type), std::move(key_type));
   }
 };
 
@@ -1065,13 +1179,20 @@ public:
   StyioIR* key = nullptr;
   StyioIR* value = nullptr;
   std::string value_type = "i64";
+  std::string key_type = "string";
 
-  SGDictSet(StyioIR* d, StyioIR* k, StyioIR* v, std::string vt) :
-      dict(d), key(k), value(v), value_type(std::move(vt)) {
+  SGDictSet(StyioIR* d, StyioIR* k, StyioIR* v, std::string vt, std::string kt) :
+      dict(d), key(k), value(v), value_type(std::move(vt)), key_type(std::move(kt)) {
   }
 
-  static SGDictSet* Create(StyioIR* d, StyioIR* k, StyioIR* v, std::string value_type = "i64") {
-    return new SGDictSet(d, k, v, std::move(value_type));
+  static SGDictSet* Create(
+    StyioIR* d,
+    StyioIR* k,
+    StyioIR* v,
+    std::string value_type = "i64",
+    std::string key_type = "string"
+  ) {
+    return new SGDictSet(d, k, v, std::move(value_type), std::move(key_type));
   }
 };
 
@@ -73,6 +73,10 @@ class SGEqProbe;
 
 class SGHandleAcquire;
 class SGFileLineIter;
+class SGCsvIter;
+class SGCsvField;
+class SGColumnarIter;
+class SGColumnarWrite;
 class SGStreamZip;
 class SGSnapshotDecl;
 class SGSnapshotShadowLoad;
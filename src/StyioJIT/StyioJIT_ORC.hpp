@@ -1,52 +1,128 @@
 #ifndef STYIO_LLVM_EXECUTIONENGINE_ORC_JIT_H
 #define STYIO_LLVM_EXECUTIONENGINE_ORC_JIT_H
 
+#include <cstdlib>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "../StyioExtern/ExternLib.hpp"
+#include "StyioPerfMapListener.hpp"
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/ExecutionEngine/JITEventListener.h"
 #include "llvm/ExecutionEngine/JITSymbol.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/ExecutionEngine/Orc/CompileOnDemandLayer.h"
 #include "llvm/ExecutionEngine/Orc/CompileUtils.h"
 #include "llvm/ExecutionEngine/Orc/Core.h"
 #include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
 #include "llvm/ExecutionEngine/Orc/ExecutorProcessControl.h"
 #include "llvm/ExecutionEngine/Orc/IRCompileLayer.h"
+#include "llvm/ExecutionEngine/Orc/IndirectionUtils.h"
 #include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/ExecutionEngine/Orc/LazyReexports.h"
 #include "llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h"
 #include "llvm/ExecutionEngine/Orc/Shared/ExecutorSymbolDef.h"
+#include "llvm/ExecutionEngine/Orc/TaskDispatch.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+
+/* CPU / feature overrides for JIT code generation. Empty fields keep the detected host values. */
+struct StyioJITTargetOptions
+{
+  std::string cpu;      /* e.g. "skylake-avx512"; "native" means the host CPU */
+  std::string features; /* comma separated, e.g. "+avx2,-avx512f" */
+};
+
+/*
+  Eager compiles every function of an added module before the first lookup returns.
+  Lazy hands modules to a CompileOnDemandLayer: each function is compiled the first
+  time it is called, through a lazy reexport stub.
+*/
+enum class StyioJITCompileMode
+{
+  Eager,
+  Lazy,
+};
+
+/*
+  Opt-in profiler integration for JITted code. PerfMap appends function ranges to
+  /tmp/perf-<pid>.map; JITDump registers LLVM's perf listener, which writes a
+  jit-<pid>.dump for `perf inject --jit` (only when LLVM was built with LLVM_USE_PERF).
+*/
+enum class StyioJITProfiler
+{
+  None,
+  PerfMap,
+  JITDump,
+};
 
 class StyioJIT_ORC
 {
 private:
   std::unique_ptr<llvm::orc::ExecutionSession> ES;
 
+  llvm::orc::JITTargetMachineBuilder TargetBuilder;
   llvm::DataLayout DL;
   llvm::orc::MangleAndInterner Mangle;
 
   llvm::orc::RTDyldObjectLinkingLayer ObjectLayer;
   llvm::orc::IRCompileLayer CompileLayer;
 
+  /* Lazy mode only; the call-through manager must outlive the layer using it. */
+  std::unique_ptr<llvm::orc::LazyCallThroughManager> LCTMgr;
+  std::unique_ptr<llvm::orc::CompileOnDemandLayer> CODLayer;
+
   llvm::orc::JITDylib &MainJD;
 
+  unsigned CompileThreads = 1;
+
+  /* Must outlive ES->endSession(), which notifies listeners as objects are freed. */
+  std::unique_ptr<StyioPerfMapListener> PerfMap;
+
+  /* Reached through a lazy stub when the function behind it failed to materialize. */
+  static void handleLazyCompileFailure() {
+    llvm::errs() << "styio: lazy JIT compilation failed\n";
+    std::abort();
+  }
+
 public:
   StyioJIT_ORC(
     std::unique_ptr<llvm::orc::ExecutionSession> ES,
     llvm::orc::JITTargetMachineBuilder JTMB,
-    llvm::DataLayout DL
+    llvm::DataLayout DL,
+    llvm::ObjectCache *ObjCache = nullptr,
+    std::unique_ptr<llvm::orc::LazyCallThroughManager> LCTMgr = nullptr,
+    unsigned CompileThreads = 1
   ) :
       ES(std::move(ES)),
+      TargetBuilder(JTMB),
       DL(std::move(DL)),
       Mangle(*this->ES, this->DL),
       ObjectLayer(*this->ES, []()
                   {
                     return std::make_unique<llvm::SectionMemoryManager>();
                   }),
-      CompileLayer(*this->ES, ObjectLayer, std::make_unique<llvm::orc::ConcurrentIRCompiler>(std::move(JTMB))),
-      MainJD(this->ES->createBareJITDylib("<main>")) {
+      CompileLayer(*this->ES, ObjectLayer, std::make_unique<llvm::orc::ConcurrentIRCompiler>(std::move(JTMB), ObjCache)),
+      LCTMgr(std::move(LCTMgr)),
+      MainJD(this->ES->createBareJITDylib("<main>")),
+      CompileThreads(CompileThreads) {
+    if (this->LCTMgr) {
+      CODLayer = std::make_unique<llvm::orc::CompileOnDemandLayer>(
+        *this->ES,
+        CompileLayer,
+        *this->LCTMgr,
+        llvm::orc::createLocalIndirectStubsManagerBuilder(TargetBuilder.getTargetTriple()));
+      /* One partition per requested function; uncalled functions are never compiled. */
+      CODLayer->setPartitionFunction(llvm::orc::CompileOnDemandLayer::compileRequested);
+    }
+
     MainJD.addGenerator(llvm::cantFail(llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(DL.getGlobalPrefix())));
 
     llvm::orc::SymbolMap runtime_symbols;
@@ -62,22 +138,51 @@ public:
     add_symbol("styio_file_open", &styio_file_open);
     add_symbol("styio_file_open_auto", &styio_file_open_auto);
     add_symbol("styio_file_open_write", &styio_file_open_write);
+    add_symbol("styio_file_acquire_write", &styio_file_acquire_write);
+    add_symbol("styio_file_release_writes", &styio_file_release_writes);
     add_symbol("styio_file_close", &styio_file_close);
     add_symbol("styio_file_rewind", &styio_file_rewind);
     add_symbol("styio_file_read_line", &styio_file_read_line);
     add_symbol("styio_file_write_cstr", &styio_file_write_cstr);
     add_symbol("styio_cstr_to_i64", &styio_cstr_to_i64);
+    add_symbol("styio_cstr_to_i64_slow", &styio_cstr_to_i64_slow);
     add_symbol("styio_cstr_to_f64", &styio_cstr_to_f64);
+    add_symbol("styio_file_read_i64", &styio_file_read_i64);
+    add_symbol("styio_file_read_f64", &styio_file_read_f64);
+    add_symbol("styio_file_read_i64_batch", &styio_file_read_i64_batch);
+    add_symbol("styio_file_read_f64_batch", &styio_file_read_f64_batch);
+    add_symbol("styio_csv_open", &styio_csv_open);
+    add_symbol("styio_csv_next_batch", &styio_csv_next_batch);
+    add_symbol("styio_csv_column_i64", &styio_csv_column_i64);
+    add_symbol("styio_csv_column_f64", &styio_csv_column_f64);
+    add_symbol("styio_csv_column_cstr", &styio_csv_column_cstr);
+    add_symbol("styio_csv_close", &styio_csv_close);
+    add_symbol("styio_col_open", &styio_col_open);
+    add_symbol("styio_col_rows", &styio_col_rows);
+    add_symbol("styio_col_data", &styio_col_data);
+    add_symbol("styio_col_strings", &styio_col_strings);
+    add_symbol("styio_col_close", &styio_col_close);
+    add_symbol("styio_col_acquire_write", &styio_col_acquire_write);
+    add_symbol("styio_col_write_i64", &styio_col_write_i64);
+    add_symbol("styio_col_write_f64", &styio_col_write_f64);
+    add_symbol("styio_col_write_bool", &styio_col_write_bool);
+    add_symbol("styio_col_write_cstr", &styio_col_write_cstr);
     add_symbol("styio_read_file_i64line", &styio_read_file_i64line);
     add_symbol("styio_strcat_ab", &styio_strcat_ab);
     add_symbol("styio_free_cstr", &styio_free_cstr);
     add_symbol("styio_i64_dec_cstr", &styio_i64_dec_cstr);
     add_symbol("styio_f64_dec_cstr", &styio_f64_dec_cstr);
     add_symbol("styio_runtime_has_error", &styio_runtime_has_error);
+    add_symbol("styio_runtime_error_word", &styio_runtime_error_word);
     add_symbol("styio_runtime_last_error", &styio_runtime_last_error);
     add_symbol("styio_runtime_last_error_subcode", &styio_runtime_last_error_subcode);
     add_symbol("styio_runtime_clear_error", &styio_runtime_clear_error);
     add_symbol("styio_runtime_set_log_sink", &styio_runtime_set_log_sink);
+    add_symbol("styio_runtime_set_output_flush", &styio_runtime_set_output_flush);
+    add_symbol("styio_runtime_flush_output", &styio_runtime_flush_output);
+    add_symbol("styio_runtime_set_file_source", &styio_runtime_set_file_source);
+    add_symbol("styio_runtime_report_exit", &styio_runtime_report_exit);
+    add_symbol("styio_runtime_reset", &styio_runtime_reset);
     add_symbol("styio_stdout_write_cstr", &styio_stdout_write_cstr);
     add_symbol("styio_stderr_write_cstr", &styio_stderr_write_cstr);
     add_symbol("styio_stdin_read_line", &styio_stdin_read_line);
@@ -120,6 +225,10 @@ public:
     add_symbol("styio_list_to_cstr", &styio_list_to_cstr);
     add_symbol("styio_list_release", &styio_list_release);
     add_symbol("styio_list_active_count", &styio_list_active_count);
+    add_symbol("styio_list_span_i64", &styio_list_span_i64);
+    add_symbol("styio_list_span_f64", &styio_list_span_f64);
+    add_symbol("styio_list_span_bool", &styio_list_span_bool);
+    add_symbol("styio_list_epoch_word", &styio_list_epoch_word);
 
     add_symbol("styio_dict_new_bool", &styio_dict_new_bool);
     add_symbol("styio_dict_new_i64", &styio_dict_new_i64);
@@ -141,6 +250,37 @@ public:
     add_symbol("styio_dict_set_cstr", &styio_dict_set_cstr);
     add_symbol("styio_dict_set_list", &styio_dict_set_list);
     add_symbol("styio_dict_set_dict", &styio_dict_set_dict);
+    add_symbol("styio_key_intern", &styio_key_intern);
+    add_symbol("styio_dict_get_bool_keyid", &styio_dict_get_bool_keyid);
+    add_symbol("styio_dict_get_i64_keyid", &styio_dict_get_i64_keyid);
+    add_symbol("styio_dict_get_f64_keyid", &styio_dict_get_f64_keyid);
+    add_symbol("styio_dict_get_cstr_keyid", &styio_dict_get_cstr_keyid);
+    add_symbol("styio_dict_get_list_keyid", &styio_dict_get_list_keyid);
+    add_symbol("styio_dict_get_dict_keyid", &styio_dict_get_dict_keyid);
+    add_symbol("styio_dict_set_bool_keyid", &styio_dict_set_bool_keyid);
+    add_symbol("styio_dict_set_i64_keyid", &styio_dict_set_i64_keyid);
+    add_symbol("styio_dict_set_f64_keyid", &styio_dict_set_f64_keyid);
+    add_symbol("styio_dict_set_cstr_keyid", &styio_dict_set_cstr_keyid);
+    add_symbol("styio_dict_set_list_keyid", &styio_dict_set_list_keyid);
+    add_symbol("styio_dict_set_dict_keyid", &styio_dict_set_dict_keyid);
+    add_symbol("styio_idict_new_bool", &styio_idict_new_bool);
+    add_symbol("styio_idict_new_i64", &styio_idict_new_i64);
+    add_symbol("styio_idict_new_f64", &styio_idict_new_f64);
+    add_symbol("styio_idict_new_cstr", &styio_idict_new_cstr);
+    add_symbol("styio_idict_new_list", &styio_idict_new_list);
+    add_symbol("styio_idict_new_dict", &styio_idict_new_dict);
+    add_symbol("styio_idict_get_bool", &styio_idict_get_bool);
+    add_symbol("styio_idict_get_i64", &styio_idict_get_i64);
+    add_symbol("styio_idict_get_f64", &styio_idict_get_f64);
+    add_symbol("styio_idict_get_cstr", &styio_idict_get_cstr);
+    add_symbol("styio_idict_get_list", &styio_idict_get_list);
+    add_symbol("styio_idict_get_dict", &styio_idict_get_dict);
+    add_symbol("styio_idict_set_bool", &styio_idict_set_bool);
+    add_symbol("styio_idict_set_i64", &styio_idict_set_i64);
+    add_symbol("styio_idict_set_f64", &styio_idict_set_f64);
+    add_symbol("styio_idict_set_cstr", &styio_idict_set_cstr);
+    add_symbol("styio_idict_set_list", &styio_idict_set_list);
+    add_symbol("styio_idict_set_dict", &styio_idict_set_dict);
     add_symbol("styio_dict_keys", &styio_dict_keys);
     add_symbol("styio_dict_values_bool", &styio_dict_values_bool);
     add_symbol("styio_dict_values_i64", &styio_dict_values_i64);
@@ -169,7 +309,7 @@ public:
     //   DL.getGlobalPrefix(),
     //   [&](const llvm::orc::SymbolStringPtr &S) { return AllowList.count(S); })));
 
-    if (JTMB.getTargetTriple().isOSBinFormatCOFF()) {
+    if (TargetBuilder.getTargetTriple().isOSBinFormatCOFF()) {
       ObjectLayer.setOverrideObjectFlagsWithResponsibilityFlags(true);
       ObjectLayer.setAutoClaimResponsibilityForObjectSymbols(true);
     }
@@ -180,20 +320,124 @@ public:
       ES->reportError(std::move(Err));
   }
 
-  static llvm::Expected<std::unique_ptr<StyioJIT_ORC>> Create() {
-    auto EPC = llvm::orc::SelfExecutorProcessControl::Create();
+  /* Host CPU and features by default; an explicit CPU drops the host feature set so it is not mixed into another CPU's defaults. */
+  static llvm::Expected<llvm::orc::JITTargetMachineBuilder> makeTargetMachineBuilder(const StyioJITTargetOptions &Options) {
+    auto JTMB = llvm::orc::JITTargetMachineBuilder::detectHost();
+    if (!JTMB)
+      return JTMB.takeError();
+
+    if (!Options.cpu.empty() && Options.cpu != "native") {
+      JTMB->setCPU(Options.cpu);
+      JTMB->setFeatures("");
+    }
+
+    if (!Options.features.empty()) {
+      std::vector<std::string> Features;
+      size_t Begin = 0;
+      while (Begin <= Options.features.size()) {
+        size_t End = Options.features.find(',', Begin);
+        if (End == std::string::npos)
+          End = Options.features.size();
+        if (End > Begin)
+          Features.push_back(Options.features.substr(Begin, End - Begin));
+        Begin = End + 1;
+      }
+      JTMB->addFeatures(Features);
+    }
+
+    return JTMB;
+  }
+
+  /*
+    ObjCache (optional, not owned) must outlive the JIT. CompileThreads > 1 dispatches
+    materialization tasks to worker threads instead of running them in place, so modules
+    added separately (see getCompileThreads) are compiled concurrently.
+  */
+  static llvm::Expected<std::unique_ptr<StyioJIT_ORC>> Create(
+    const StyioJITTargetOptions &Options = {},
+    llvm::ObjectCache *ObjCache = nullptr,
+    StyioJITCompileMode Mode = StyioJITCompileMode::Eager,
+    unsigned CompileThreads = 1
+  ) {
+    std::unique_ptr<llvm::orc::TaskDispatcher> Dispatcher;
+#if LLVM_ENABLE_THREADS
+    if (CompileThreads > 1)
+      Dispatcher = std::make_unique<llvm::orc::DynamicThreadPoolTaskDispatcher>();
+#else
+    CompileThreads = 1;
+#endif
+    auto EPC = llvm::orc::SelfExecutorProcessControl::Create(nullptr, std::move(Dispatcher));
     if (!EPC)
       return EPC.takeError();
 
     auto ES = std::make_unique<llvm::orc::ExecutionSession>(std::move(*EPC));
 
-    llvm::orc::JITTargetMachineBuilder JTMB(ES->getExecutorProcessControl().getTargetTriple());
+    auto JTMB = makeTargetMachineBuilder(Options);
+    if (!JTMB)
+      return JTMB.takeError();
 
-    auto DL = JTMB.getDefaultDataLayoutForTarget();
+    auto DL = JTMB->getDefaultDataLayoutForTarget();
     if (!DL)
       return DL.takeError();
 
-    return std::make_unique<StyioJIT_ORC>(std::move(ES), std::move(JTMB), std::move(*DL));
+    std::unique_ptr<llvm::orc::LazyCallThroughManager> LCTMgr;
+    if (Mode == StyioJITCompileMode::Lazy) {
+      auto LCTMgrOrErr = llvm::orc::createLocalLazyCallThroughManager(
+        JTMB->getTargetTriple(),
+        *ES,
+        llvm::orc::ExecutorAddr::fromPtr(&handleLazyCompileFailure));
+      if (!LCTMgrOrErr)
+        return LCTMgrOrErr.takeError();
+      LCTMgr = std::move(*LCTMgrOrErr);
+    }
+
+    return std::make_unique<StyioJIT_ORC>(
+      std::move(ES), std::move(*JTMB), std::move(*DL), ObjCache, std::move(LCTMgr), CompileThreads);
+  }
+
+  /* Register a profiler listener; call before adding modules, objects linked earlier are not reported. */
+  llvm::Error enableProfiler(StyioJITProfiler Profiler) {
+    switch (Profiler) {
+      case StyioJITProfiler::None:
+        return llvm::Error::success();
+      case StyioJITProfiler::PerfMap:
+        if (!PerfMap) {
+          PerfMap = std::make_unique<StyioPerfMapListener>(DL.getGlobalPrefix());
+          if (!PerfMap->isOpen()) {
+            PerfMap.reset();
+            return llvm::createStringError(llvm::inconvertibleErrorCode(), "cannot open /tmp/perf-<pid>.map for writing");
+          }
+          ObjectLayer.registerJITEventListener(*PerfMap);
+        }
+        return llvm::Error::success();
+      case StyioJITProfiler::JITDump:
+        /* A process-wide static owned by LLVM; null when LLVM lacks perf support. */
+        if (llvm::JITEventListener *Listener = llvm::JITEventListener::createPerfJITEventListener()) {
+          ObjectLayer.registerJITEventListener(*Listener);
+          return llvm::Error::success();
+        }
+        return llvm::createStringError(
+          llvm::inconvertibleErrorCode(), "this LLVM build has no perf JIT event listener (LLVM_USE_PERF=OFF)");
+    }
+    return llvm::Error::success();
+  }
+
+  /* How many independently compiled modules the caller should split a program into. */
+  unsigned getCompileThreads() const {
+    return CompileThreads;
+  }
+
+  bool isLazy() const {
+    return CODLayer != nullptr;
+  }
+
+  const llvm::orc::JITTargetMachineBuilder &getTargetMachineBuilder() const {
+    return TargetBuilder;
+  }
+
+  /* A TargetMachine matching the JIT's code generator, for target-aware optimization (TTI). */
+  llvm::Expected<std::unique_ptr<llvm::TargetMachine>> createTargetMachine() {
+    return TargetBuilder.createTargetMachine();
   }
 
   const llvm::DataLayout &getDataLayout() const {
@@ -207,9 +451,31 @@ public:
   llvm::Error addModule(llvm::orc::ThreadSafeModule TSM, llvm::orc::ResourceTrackerSP RT = nullptr) {
     if (!RT)
       RT = MainJD.getDefaultResourceTracker();
+    if (CODLayer)
+      return CODLayer->add(RT, std::move(TSM));
     return CompileLayer.add(RT, std::move(TSM));
   }
 
+  /* Link an already compiled object (e.g. an object cache hit) without any IR. */
+  llvm::Error addObjectFile(std::unique_ptr<llvm::MemoryBuffer> Obj, llvm::orc::ResourceTrackerSP RT = nullptr) {
+    if (!RT)
+      RT = MainJD.getDefaultResourceTracker();
+    return ObjectLayer.add(RT, std::move(Obj));
+  }
+
+  /* Resolve all Names in one session lookup, so the modules defining them materialize together. */
+  llvm::Error materialize(llvm::ArrayRef<std::string> Names) {
+    llvm::orc::SymbolLookupSet Symbols;
+    for (const std::string &Name : Names)
+      Symbols.add(Mangle(Name));
+    auto Result = ES->lookup(
+      llvm::orc::makeJITDylibSearchOrder(&MainJD, llvm::orc::JITDylibLookupFlags::MatchAllSymbols),
+      std::move(Symbols));
+    if (!Result)
+      return Result.takeError();
+    return llvm::Error::success();
+  }
+
   llvm::Expected<llvm::orc::ExecutorSymbolDef> lookup(llvm::StringRef Name) {
     return ES->lookup({&MainJD}, Mangle(Name.str()));
   }
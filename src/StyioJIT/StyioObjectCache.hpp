@@ -0,0 +1,111 @@
+#ifndef STYIO_JIT_OBJECT_CACHE_H
+#define STYIO_JIT_OBJECT_CACHE_H
+
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Process.h"
+
+/*
+  On-disk object cache for the ORC IRCompileLayer.
+
+  Objects are stored as <dir>/<key>.<module>.o, where <key> is a fingerprint the
+  driver computes from everything that can change the generated code (source,
+  dict impl, opt level, target, compiler build). The cache never invalidates by
+  itself: a different fingerprint simply selects a different file.
+*/
+class StyioObjectCache : public llvm::ObjectCache
+{
+public:
+  /* hit, path */
+  using LookupCallback = std::function<void(bool, const std::string&)>;
+
+private:
+  std::filesystem::path Dir;
+  std::string Key;
+  LookupCallback OnLookup;
+  /* Parallel JIT compiles query the cache from worker threads. */
+  std::mutex CallbackMutex;
+
+public:
+  StyioObjectCache(std::filesystem::path Dir, std::string Key) :
+      Dir(std::move(Dir)), Key(std::move(Key)) {
+  }
+
+  void setLookupCallback(LookupCallback Callback) {
+    OnLookup = std::move(Callback);
+  }
+
+  const std::filesystem::path &getDir() const {
+    return Dir;
+  }
+
+  const std::string &getKey() const {
+    return Key;
+  }
+
+  std::filesystem::path pathForModule(const std::string &ModuleID) const {
+    std::string Name = ModuleID;
+    for (char &C : Name) {
+      const bool Safe = (C >= 'a' && C <= 'z') || (C >= 'A' && C <= 'Z') || (C >= '0' && C <= '9') || C == '-' || C == '_';
+      if (!Safe)
+        C = '_';
+    }
+    return Dir / (Key + "." + Name + ".o");
+  }
+
+  /* Read a cached object without going through the compile layer (warm-start fast path). */
+  std::unique_ptr<llvm::MemoryBuffer> load(const std::string &ModuleID) const {
+    const std::filesystem::path Path = pathForModule(ModuleID);
+    auto Buffer = llvm::MemoryBuffer::getFile(Path.string(), /*IsText*/ false, /*RequiresNullTerminator*/ false);
+    if (!Buffer)
+      return nullptr;
+    return std::move(*Buffer);
+  }
+
+  void notifyObjectCompiled(const llvm::Module *M, llvm::MemoryBufferRef Obj) override {
+    std::error_code EC;
+    std::filesystem::create_directories(Dir, EC);
+    if (EC)
+      return;
+
+    /* Write-then-rename so concurrent runs never observe a torn object. */
+    const std::filesystem::path Path = pathForModule(M->getModuleIdentifier());
+    std::filesystem::path Tmp = Path;
+    Tmp += ".tmp." + std::to_string(llvm::sys::Process::getProcessId());
+    {
+      std::ofstream Out(Tmp, std::ios::binary | std::ios::trunc);
+      if (!Out)
+        return;
+      Out.write(Obj.getBufferStart(), static_cast<std::streamsize>(Obj.getBufferSize()));
+      if (!Out) {
+        Out.close();
+        std::filesystem::remove(Tmp, EC);
+        return;
+      }
+    }
+    std::filesystem::rename(Tmp, Path, EC);
+    if (EC)
+      std::filesystem::remove(Tmp, EC);
+  }
+
+  std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module *M) override {
+    const std::string ModuleID = M->getModuleIdentifier();
+    auto Buffer = load(ModuleID);
+    if (OnLookup) {
+      std::lock_guard<std::mutex> Lock(CallbackMutex);
+      OnLookup(Buffer != nullptr, pathForModule(ModuleID).string());
+    }
+    return Buffer;
+  }
+};
+
+#endif  // STYIO_JIT_OBJECT_CACHE_H
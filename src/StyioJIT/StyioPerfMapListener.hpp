@@ -0,0 +1,100 @@
+#ifndef STYIO_JIT_PERF_MAP_LISTENER_H
+#define STYIO_JIT_PERF_MAP_LISTENER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+
+#include "llvm/ExecutionEngine/JITEventListener.h"
+#include "llvm/ExecutionEngine/RuntimeDyld.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Object/SymbolSize.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/Process.h"
+
+/*
+  Appends every function of each object the JIT links to /tmp/perf-<pid>.map, the
+  text format `perf report` / `perf top` read for anonymous executable memory:
+
+    <start hex> <size hex> styio:<name>
+
+  Names are the symbols codegen emitted, which are the Styio source function names
+  (plus `main` for the top-level program and its inlined pulse regions). Entries
+  are never retracted: perf only reads the map after the process has exited.
+*/
+class StyioPerfMapListener : public llvm::JITEventListener
+{
+  std::FILE *Out = nullptr;
+  char GlobalPrefix = '\0';
+  std::mutex Mutex;
+
+public:
+  explicit StyioPerfMapListener(char GlobalPrefix) :
+      GlobalPrefix(GlobalPrefix) {
+    const std::string Path = "/tmp/perf-" + std::to_string(llvm::sys::Process::getProcessId()) + ".map";
+    Out = std::fopen(Path.c_str(), "a");
+  }
+
+  ~StyioPerfMapListener() override {
+    if (Out != nullptr)
+      std::fclose(Out);
+  }
+
+  StyioPerfMapListener(const StyioPerfMapListener &) = delete;
+  StyioPerfMapListener &operator=(const StyioPerfMapListener &) = delete;
+
+  bool isOpen() const {
+    return Out != nullptr;
+  }
+
+  void notifyObjectLoaded(
+    ObjectKey,
+    const llvm::object::ObjectFile &Obj,
+    const llvm::RuntimeDyld::LoadedObjectInfo &L
+  ) override {
+    if (Out == nullptr)
+      return;
+
+    /* The debug copy has its sections relocated to their load addresses. */
+    llvm::object::OwningBinary<llvm::object::ObjectFile> DebugObjOwner = L.getObjectForDebug(Obj);
+    const llvm::object::ObjectFile *DebugObj = DebugObjOwner.getBinary();
+    if (DebugObj == nullptr)
+      return;
+
+    /* Parallel JIT compiles link objects from worker threads. */
+    std::lock_guard<std::mutex> Lock(Mutex);
+    for (const auto &[Sym, Size] : llvm::object::computeSymbolSizes(*DebugObj)) {
+      auto Type = Sym.getType();
+      if (!Type) {
+        llvm::consumeError(Type.takeError());
+        continue;
+      }
+      if (*Type != llvm::object::SymbolRef::ST_Function || Size == 0)
+        continue;
+      auto Name = Sym.getName();
+      if (!Name) {
+        llvm::consumeError(Name.takeError());
+        continue;
+      }
+      auto Addr = Sym.getAddress();
+      if (!Addr) {
+        llvm::consumeError(Addr.takeError());
+        continue;
+      }
+      llvm::StringRef Plain = *Name;
+      if (GlobalPrefix != '\0' && !Plain.empty() && Plain.front() == GlobalPrefix)
+        Plain = Plain.drop_front();
+      std::fprintf(
+        Out,
+        "%llx %llx styio:%.*s\n",
+        static_cast<unsigned long long>(*Addr),
+        static_cast<unsigned long long>(Size),
+        static_cast<int>(Plain.size()),
+        Plain.data());
+    }
+    std::fflush(Out);
+  }
+};
+
+#endif  // STYIO_JIT_PERF_MAP_LISTENER_H
@@ -1701,8 +1701,16 @@ parse_stmt_subset_impl_nightly(StyioContext& context) {
       context.skip();
       TypeAST* ty = parse_styio_type(context);
       context.skip();
+      if (context.cur_tok_type() == StyioTokenType::TOK_EQUAL) {
+        /* `x: T = v` is a flexible binding that keeps its declared type. */
+        context.move_forward(1, "new_stmt:typed_flex_bind");
+        context.skip();
+        return FlexBindAST::Create(
+          VarAST::Create(NameAST::Create(id), ty),
+          parse_expr_subset_nightly(context));
+      }
       if (context.cur_tok_type() != StyioTokenType::WALRUS) {
-        throw StyioSyntaxError("expected ':=' after type in nightly parser subset");
+        throw StyioSyntaxError("expected ':=' or '=' after type in nightly parser subset");
       }
       context.move_forward(1, "new_stmt:final_bind_walrus");
       context.skip();
@@ -1851,6 +1859,11 @@ parse_stmt_subset_impl_nightly(StyioContext& context) {
 
 } // namespace
 
+DictAST*
+parse_dict_literal_nightly(StyioContext& context) {
+  return parse_dict_literal_nightly_draft(context);
+}
+
 StyioAST*
 parse_stmt_subset_nightly(StyioContext& context) {
   return parse_stmt_subset_impl_nightly(context);
@@ -58,6 +58,10 @@ parse_expr_subset_nightly(StyioContext& context);
 StyioAST*
 parse_stmt_subset_nightly(StyioContext& context);
 
+/* `dict{k: v, ...}` with the cursor on `{`; the legacy parser borrows it so both engines build the same DictAST. */
+DictAST*
+parse_dict_literal_nightly(StyioContext& context);
+
 ParseAttempt<StyioAST>
 try_parse_stmt_subset_nightly(StyioContext& context);
 
@@ -344,6 +344,10 @@ parse_name_and_following_unsafe(StyioContext& context) {
   StyioAST* output = name;
 
   context.skip_spaces_no_linebreak();
+  if (name->getAsStr() == "dict" && context.check(StyioTokenType::TOK_LCURBRAC)) {
+    delete name;
+    return parse_dict_literal_nightly(context);
+  }
   switch (context.cur_tok_type()) {
     /* + */
     case StyioTokenType::TOK_PLUS: {
@@ -896,6 +900,12 @@ parse_after_at_common(StyioContext& context, bool file_only_resource) {
     StyioAST* path = parse_braced_string_path(context);
     return FileResourceAST::Create(path, false);
   }
+  if (context.check(StyioTokenType::NAME) && context.cur_tok()->original == "col") {
+    context.move_forward(1, "@col");
+    context.skip();
+    StyioAST* path = parse_braced_string_path(context);
+    return FileResourceAST::Create(path, false, true);
+  }
   /* M9: @stdout / @stderr / @stdin */
   if (context.check(StyioTokenType::NAME) && context.cur_tok()->original == "stdout") {
     context.move_forward(1, "@stdout");
@@ -0,0 +1,449 @@
+#pragma once
+#ifndef STYIO_RUNTIME_COLUMNAR_FILE_HPP_
+#define STYIO_RUNTIME_COLUMNAR_FILE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+  Typed columnar interchange file behind `@col{...}`: one stage writes it with `<<`, the
+  next maps it and reads the columns in place, with no text formatting or parsing.
+
+    header     magic "STYIOCOL", u32 version, u32 column count, u64 row count, u64 file bytes
+    directory  per column: u32 type, u32 name bytes, u64 name offset, u64 data offset,
+               u64 data bytes
+    names      NUL-terminated
+    data       one 8-byte aligned block per column: i64 / f64 values, bool as one byte
+               per row, string as u64 offsets[rows + 1] into a blob of NUL-terminated
+               strings that follows them (so a cell is a C string inside the mapping)
+
+  Integers are in host byte order; a file from a host of the other byte order fails the
+  version check instead of being misread.
+*/
+enum class StyioColumnarType : uint32_t
+{
+  I64 = 1,
+  F64 = 2,
+  Bool = 3,
+  String = 4,
+};
+
+inline const char*
+styio_columnar_type_name(StyioColumnarType type) {
+  switch (type) {
+    case StyioColumnarType::I64:    return "i64";
+    case StyioColumnarType::F64:    return "f64";
+    case StyioColumnarType::Bool:   return "bool";
+    case StyioColumnarType::String: return "str";
+  }
+  return "?";
+}
+
+/* Inverse of styio_columnar_type_name; false for an unknown name. */
+inline bool
+styio_columnar_type_from_name(const std::string& name, StyioColumnarType& out) {
+  for (auto type : {StyioColumnarType::I64, StyioColumnarType::F64, StyioColumnarType::Bool, StyioColumnarType::String}) {
+    if (name == styio_columnar_type_name(type)) {
+      out = type;
+      return true;
+    }
+  }
+  return false;
+}
+
+struct StyioColumnarLayout
+{
+  static constexpr char kMagic[8] = {'S', 'T', 'Y', 'I', 'O', 'C', 'O', 'L'};
+  static constexpr uint32_t kVersion = 1;
+  static constexpr size_t kHeaderBytes = 32;
+  static constexpr size_t kDirectoryEntryBytes = 32;
+
+  static constexpr uint64_t align8(uint64_t n) {
+    return (n + 7) & ~uint64_t(7);
+  }
+};
+
+/*
+  Read side: validates a mapped image once in open(), then hands out pointers into it.
+  The image must stay mapped (and 8-byte aligned) for as long as the reader is used.
+*/
+class StyioColumnarReader
+{
+public:
+  struct Column
+  {
+    std::string name;
+    StyioColumnarType type = StyioColumnarType::I64;
+    const unsigned char* data = nullptr;
+    uint64_t bytes = 0;
+  };
+
+private:
+  std::vector<Column> columns_;
+  uint64_t rows_ = 0;
+  std::string error_;
+
+  static uint32_t load_u32(const unsigned char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+  }
+
+  static uint64_t load_u64(const unsigned char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+  }
+
+  bool fail(std::string message) {
+    error_ = std::move(message);
+    columns_.clear();
+    rows_ = 0;
+    return false;
+  }
+
+  bool check_strings(const Column& col) {
+    if (rows_ >= col.bytes / sizeof(uint64_t)) {
+      return fail("columnar string column '" + col.name + "' is truncated");
+    }
+    const uint64_t table = (rows_ + 1) * sizeof(uint64_t);
+    const uint64_t blob = col.bytes - table;
+    const uint64_t* offsets = reinterpret_cast<const uint64_t*>(col.data);
+    /* Every cell starts inside the blob and the blob ends with a NUL, so each cell is a
+       terminated string within the mapping. */
+    if (rows_ > 0 && (blob == 0 || col.data[table + blob - 1] != '\0' || offsets[rows_] != blob)) {
+      return fail("columnar string column '" + col.name + "' is corrupt");
+    }
+    for (uint64_t r = 0; r < rows_; ++r) {
+      if (offsets[r] >= blob) {
+        return fail("columnar string column '" + col.name + "' is corrupt");
+      }
+    }
+    return true;
+  }
+
+public:
+  const std::string& error() const {
+    return error_;
+  }
+
+  uint64_t rows() const {
+    return rows_;
+  }
+
+  size_t column_count() const {
+    return columns_.size();
+  }
+
+  const Column& column(size_t index) const {
+    return columns_[index];
+  }
+
+  /* Index of the column called `name`, or -1. */
+  int find(const std::string& name) const {
+    for (size_t c = 0; c < columns_.size(); ++c) {
+      if (columns_[c].name == name) {
+        return static_cast<int>(c);
+      }
+    }
+    return -1;
+  }
+
+  bool open(const void* image, size_t size) {
+    const auto* base = static_cast<const unsigned char*>(image);
+    if (reinterpret_cast<uintptr_t>(base) % 8 != 0) {
+      return fail("columnar image is not 8-byte aligned");
+    }
+    if (size < StyioColumnarLayout::kHeaderBytes
+        || std::memcmp(base, StyioColumnarLayout::kMagic, sizeof(StyioColumnarLayout::kMagic)) != 0) {
+      return fail("not a styio columnar file");
+    }
+    if (load_u32(base + 8) != StyioColumnarLayout::kVersion) {
+      return fail("unsupported columnar file version " + std::to_string(load_u32(base + 8)));
+    }
+    const uint32_t ncols = load_u32(base + 12);
+    rows_ = load_u64(base + 16);
+    if (load_u64(base + 24) != size) {
+      return fail("columnar file is truncated");
+    }
+    if (ncols > (size - StyioColumnarLayout::kHeaderBytes) / StyioColumnarLayout::kDirectoryEntryBytes) {
+      return fail("columnar directory is truncated");
+    }
+
+    columns_.clear();
+    columns_.reserve(ncols);
+    for (uint32_t c = 0; c < ncols; ++c) {
+      const unsigned char* entry =
+        base + StyioColumnarLayout::kHeaderBytes + size_t(c) * StyioColumnarLayout::kDirectoryEntryBytes;
+      const uint32_t type = load_u32(entry);
+      const uint32_t name_bytes = load_u32(entry + 4);
+      const uint64_t name_offset = load_u64(entry + 8);
+      const uint64_t data_offset = load_u64(entry + 16);
+      const uint64_t data_bytes = load_u64(entry + 24);
+      if (name_offset > size || name_bytes > size - name_offset
+          || data_offset > size || data_bytes > size - data_offset || data_offset % 8 != 0) {
+        return fail("columnar column " + std::to_string(c) + " lies outside the file");
+      }
+      Column col;
+      col.name.assign(reinterpret_cast<const char*>(base + name_offset), name_bytes);
+      col.data = base + data_offset;
+      col.bytes = data_bytes;
+      switch (type) {
+        case uint32_t(StyioColumnarType::I64):
+        case uint32_t(StyioColumnarType::F64):
+          col.type = static_cast<StyioColumnarType>(type);
+          if (data_bytes / 8 < rows_) {
+            return fail("columnar column '" + col.name + "' is truncated");
+          }
+          break;
+        case uint32_t(StyioColumnarType::Bool):
+          col.type = StyioColumnarType::Bool;
+          if (data_bytes < rows_) {
+            return fail("columnar column '" + col.name + "' is truncated");
+          }
+          break;
+        case uint32_t(StyioColumnarType::String):
+          col.type = StyioColumnarType::String;
+          if (!check_strings(col)) {
+            return false;
+          }
+          break;
+        default:
+          return fail("columnar column '" + col.name + "' has unknown type " + std::to_string(type));
+      }
+      columns_.push_back(std::move(col));
+    }
+    error_.clear();
+    return true;
+  }
+
+  const int64_t* i64(size_t c) const {
+    return reinterpret_cast<const int64_t*>(columns_[c].data);
+  }
+
+  const double* f64(size_t c) const {
+    return reinterpret_cast<const double*>(columns_[c].data);
+  }
+
+  const uint8_t* bools(size_t c) const {
+    return columns_[c].data;
+  }
+
+  const uint64_t* string_offsets(size_t c) const {
+    return reinterpret_cast<const uint64_t*>(columns_[c].data);
+  }
+
+  const char* string_blob(size_t c) const {
+    return reinterpret_cast<const char*>(columns_[c].data + (rows_ + 1) * sizeof(uint64_t));
+  }
+
+  const char* string(size_t c, uint64_t row) const {
+    return string_blob(c) + string_offsets(c)[row];
+  }
+};
+
+/*
+  Write side: values are appended per column in memory and the whole file is produced by
+  write(); every column must hold the same number of rows by then.
+*/
+class StyioColumnarWriter
+{
+public:
+  struct Column
+  {
+    std::string name;
+    StyioColumnarType type = StyioColumnarType::I64;
+    std::vector<int64_t> i64;
+    std::vector<double> f64;
+    std::vector<uint8_t> bools;
+    std::vector<uint64_t> str_offsets;
+    std::string str_blob;
+
+    uint64_t rows() const {
+      switch (type) {
+        case StyioColumnarType::I64:    return i64.size();
+        case StyioColumnarType::F64:    return f64.size();
+        case StyioColumnarType::Bool:   return bools.size();
+        case StyioColumnarType::String: return str_offsets.size();
+      }
+      return 0;
+    }
+  };
+
+private:
+  std::vector<Column> columns_;
+
+public:
+  size_t add_column(std::string name, StyioColumnarType type) {
+    Column col;
+    col.name = std::move(name);
+    col.type = type;
+    columns_.push_back(std::move(col));
+    return columns_.size() - 1;
+  }
+
+  size_t column_count() const {
+    return columns_.size();
+  }
+
+  const Column& column(size_t index) const {
+    return columns_[index];
+  }
+
+  void append_i64(size_t c, int64_t value) {
+    columns_[c].i64.push_back(value);
+  }
+
+  void append_f64(size_t c, double value) {
+    columns_[c].f64.push_back(value);
+  }
+
+  void append_bool(size_t c, bool value) {
+    columns_[c].bools.push_back(value ? 1 : 0);
+  }
+
+  void append_string(size_t c, const char* data, size_t size) {
+    Column& col = columns_[c];
+    col.str_offsets.push_back(col.str_blob.size());
+    col.str_blob.append(data, size);
+    col.str_blob.push_back('\0');
+  }
+
+  /* Append every row of `reader`, whose columns must match this writer's one for one. */
+  void append_rows(const StyioColumnarReader& reader) {
+    for (size_t c = 0; c < columns_.size(); ++c) {
+      const uint64_t rows = reader.rows();
+      switch (columns_[c].type) {
+        case StyioColumnarType::I64:
+          columns_[c].i64.insert(columns_[c].i64.end(), reader.i64(c), reader.i64(c) + rows);
+          break;
+        case StyioColumnarType::F64:
+          columns_[c].f64.insert(columns_[c].f64.end(), reader.f64(c), reader.f64(c) + rows);
+          break;
+        case StyioColumnarType::Bool:
+          columns_[c].bools.insert(columns_[c].bools.end(), reader.bools(c), reader.bools(c) + rows);
+          break;
+        case StyioColumnarType::String:
+          for (uint64_t r = 0; r < rows; ++r) {
+            const char* cell = reader.string(c, r);
+            append_string(c, cell, std::strlen(cell));
+          }
+          break;
+      }
+    }
+  }
+
+  /* Row count shared by all columns, or -1 when they differ. */
+  int64_t rows() const {
+    if (columns_.empty()) {
+      return 0;
+    }
+    const uint64_t rows = columns_[0].rows();
+    for (const auto& col : columns_) {
+      if (col.rows() != rows) {
+        return -1;
+      }
+    }
+    return static_cast<int64_t>(rows);
+  }
+
+  /*
+    Emit the file through `sink(const void* data, size_t size)`, which returns false on a
+    write error. Fails when the columns hold different numbers of rows.
+  */
+  template <typename Sink>
+  bool write(Sink&& sink) const {
+    const int64_t rows = this->rows();
+    if (rows < 0) {
+      return false;
+    }
+
+    uint64_t offset = StyioColumnarLayout::kHeaderBytes
+                      + columns_.size() * StyioColumnarLayout::kDirectoryEntryBytes;
+    std::vector<uint64_t> name_offsets;
+    for (const auto& col : columns_) {
+      name_offsets.push_back(offset);
+      offset += col.name.size() + 1;
+    }
+    std::vector<uint64_t> data_offsets;
+    std::vector<uint64_t> data_bytes;
+    for (const auto& col : columns_) {
+      offset = StyioColumnarLayout::align8(offset);
+      uint64_t bytes = 0;
+      switch (col.type) {
+        case StyioColumnarType::I64:    bytes = col.i64.size() * sizeof(int64_t); break;
+        case StyioColumnarType::F64:    bytes = col.f64.size() * sizeof(double); break;
+        case StyioColumnarType::Bool:   bytes = col.bools.size(); break;
+        case StyioColumnarType::String: bytes = (uint64_t(rows) + 1) * sizeof(uint64_t) + col.str_blob.size(); break;
+      }
+      data_offsets.push_back(offset);
+      data_bytes.push_back(bytes);
+      offset += bytes;
+    }
+    const uint64_t file_bytes = offset;
+
+    std::string head(StyioColumnarLayout::kHeaderBytes, '\0');
+    auto put_u32 = [](std::string& out, size_t at, uint32_t v) { std::memcpy(&out[at], &v, sizeof(v)); };
+    auto put_u64 = [](std::string& out, size_t at, uint64_t v) { std::memcpy(&out[at], &v, sizeof(v)); };
+    std::memcpy(&head[0], StyioColumnarLayout::kMagic, sizeof(StyioColumnarLayout::kMagic));
+    put_u32(head, 8, StyioColumnarLayout::kVersion);
+    put_u32(head, 12, static_cast<uint32_t>(columns_.size()));
+    put_u64(head, 16, static_cast<uint64_t>(rows));
+    put_u64(head, 24, file_bytes);
+    for (size_t c = 0; c < columns_.size(); ++c) {
+      std::string entry(StyioColumnarLayout::kDirectoryEntryBytes, '\0');
+      put_u32(entry, 0, static_cast<uint32_t>(columns_[c].type));
+      put_u32(entry, 4, static_cast<uint32_t>(columns_[c].name.size()));
+      put_u64(entry, 8, name_offsets[c]);
+      put_u64(entry, 16, data_offsets[c]);
+      put_u64(entry, 24, data_bytes[c]);
+      head += entry;
+    }
+    for (const auto& col : columns_) {
+      head.append(col.name);
+      head.push_back('\0');
+    }
+    if (!sink(head.data(), head.size())) {
+      return false;
+    }
+
+    static const char kPad[8] = {};
+    uint64_t written = head.size();
+    for (size_t c = 0; c < columns_.size(); ++c) {
+      if (!sink(kPad, data_offsets[c] - written)) {
+        return false;
+      }
+      const Column& col = columns_[c];
+      bool ok = true;
+      switch (col.type) {
+        case StyioColumnarType::I64:
+          ok = sink(col.i64.data(), data_bytes[c]);
+          break;
+        case StyioColumnarType::F64:
+          ok = sink(col.f64.data(), data_bytes[c]);
+          break;
+        case StyioColumnarType::Bool:
+          ok = sink(col.bools.data(), data_bytes[c]);
+          break;
+        case StyioColumnarType::String: {
+          const uint64_t end = col.str_blob.size();
+          ok = sink(col.str_offsets.data(), col.str_offsets.size() * sizeof(uint64_t))
+               && sink(&end, sizeof(end))
+               && sink(col.str_blob.data(), col.str_blob.size());
+          break;
+        }
+      }
+      if (!ok) {
+        return false;
+      }
+      written = data_offsets[c] + data_bytes[c];
+    }
+    return true;
+  }
+};
+
+#endif // STYIO_RUNTIME_COLUMNAR_FILE_HPP_
@@ -0,0 +1,423 @@
+#pragma once
+#ifndef STYIO_RUNTIME_CSV_READER_HPP_
+#define STYIO_RUNTIME_CSV_READER_HPP_
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+/*
+  Columnar CSV reader behind `@file{...} >> #(row: csv) => {...}`.
+
+  The first record is the header. Only the projected columns (add_column) are
+  materialized: next_batch() parses up to `batch_rows` records into one typed array per
+  column, so generated code indexes plain memory instead of calling back per field, and
+  fields past the last projected one are never split.
+
+  Record ends are found with memchr for '\n'; only a record that contains a '"' is
+  rescanned quote-aware (RFC 4180 quoting, "" escapes, newlines inside quotes). Fields
+  are split with memchr for the delimiter. Both scans run on the C library's vectorized
+  memchr. String cells are copied into a per-batch arena.
+
+  Column arrays stay valid until the next call to next_batch().
+*/
+class StyioCsvReader
+{
+public:
+  enum class ColumnType
+  {
+    I64,
+    F64,
+    String,
+  };
+
+  struct Column
+  {
+    std::string name;
+    ColumnType type = ColumnType::String;
+    size_t field = 0;
+    std::vector<int64_t> i64;
+    std::vector<double> f64;
+    std::vector<const char*> str;
+    std::vector<size_t> str_offsets;
+  };
+
+  static constexpr size_t kDefaultBatchRows = 4096;
+  static constexpr size_t kDefaultBlockBytes = size_t(1) << 20;
+
+private:
+  std::vector<Column> columns_;
+  /* Header field index -> projected column, or -1. */
+  std::vector<int> field_column_;
+  size_t last_field_ = 0;
+  char delim_;
+  size_t batch_rows_;
+  size_t block_bytes_;
+
+  std::unique_ptr<char[]> buf_;
+  size_t capacity_ = 0;
+  size_t begin_ = 0;
+  size_t end_ = 0;
+  bool eof_ = false;
+
+  size_t row_ = 0;
+  std::string arena_;
+  std::string quoted_;
+  std::string error_;
+  bool parse_failed_ = false;
+
+  /* Next record as [data, data + size), without its line terminator; false at end of input. */
+  template <typename Fill>
+  bool next_record(Fill& fill, const char*& data, size_t& size) {
+    size_t scanned = begin_;
+    bool in_quotes = false;
+    while (true) {
+      const char* base = buf_.get();
+      while (scanned < end_) {
+        if (in_quotes) {
+          auto* q = static_cast<const char*>(std::memchr(base + scanned, '"', end_ - scanned));
+          if (q == nullptr) {
+            scanned = end_;
+            break;
+          }
+          scanned = static_cast<size_t>(q - base) + 1;
+          in_quotes = false;
+          continue;
+        }
+        auto* nl = static_cast<const char*>(std::memchr(base + scanned, '\n', end_ - scanned));
+        const size_t stop = nl != nullptr ? static_cast<size_t>(nl - base) : end_;
+        auto* q = static_cast<const char*>(std::memchr(base + scanned, '"', stop - scanned));
+        if (q != nullptr) {
+          scanned = static_cast<size_t>(q - base) + 1;
+          in_quotes = true;
+          continue;
+        }
+        if (nl != nullptr) {
+          data = base + begin_;
+          size = strip_cr(data, stop - begin_);
+          begin_ = stop + 1;
+          return true;
+        }
+        scanned = end_;
+      }
+
+      if (eof_) {
+        if (begin_ == end_) {
+          return false;
+        }
+        /* Last record without a trailing newline (or with an unterminated quote). */
+        data = base + begin_;
+        size = strip_cr(data, end_ - begin_);
+        begin_ = end_;
+        return true;
+      }
+
+      /* Keep the partial record; grow only when less than half a block fits. */
+      if (begin_ > 0) {
+        std::memmove(buf_.get(), buf_.get() + begin_, end_ - begin_);
+        end_ -= begin_;
+        scanned -= begin_;
+        begin_ = 0;
+      }
+      const size_t min_free = block_bytes_ > 1 ? block_bytes_ / 2 : 1;
+      if (capacity_ - end_ < min_free) {
+        size_t grown = capacity_ == 0 ? block_bytes_ : capacity_ * 2;
+        while (grown - end_ < min_free) {
+          grown *= 2;
+        }
+        std::unique_ptr<char[]> next_buf(new char[grown]);
+        if (end_ > 0) {
+          std::memcpy(next_buf.get(), buf_.get(), end_);
+        }
+        buf_ = std::move(next_buf);
+        capacity_ = grown;
+      }
+      const size_t got = fill(buf_.get() + end_, capacity_ - end_);
+      if (got == 0) {
+        eof_ = true;
+      }
+      else {
+        end_ += got;
+      }
+    }
+  }
+
+  static size_t strip_cr(const char* data, size_t size) {
+    while (size > 0 && data[size - 1] == '\r') {
+      size -= 1;
+    }
+    return size;
+  }
+
+  /*
+    Calls `on_field(index, data, size)` for each field of the record up to `max_field`,
+    with quotes removed and "" unescaped. Returns the number of fields visited.
+  */
+  template <typename OnField>
+  size_t split_record(const char* data, size_t size, size_t max_field, OnField&& on_field) {
+    const char* p = data;
+    const char* end = data + size;
+    size_t field = 0;
+    while (true) {
+      const char* next = end;
+      if (p < end && *p == '"') {
+        quoted_.clear();
+        const char* q = p + 1;
+        while (true) {
+          auto* c = static_cast<const char*>(std::memchr(q, '"', static_cast<size_t>(end - q)));
+          if (c == nullptr) {
+            quoted_.append(q, static_cast<size_t>(end - q));
+            break;
+          }
+          quoted_.append(q, static_cast<size_t>(c - q));
+          if (c + 1 < end && c[1] == '"') {
+            quoted_.push_back('"');
+            q = c + 2;
+            continue;
+          }
+          /* Anything between the closing quote and the delimiter is dropped. */
+          auto* d = static_cast<const char*>(std::memchr(c + 1, delim_, static_cast<size_t>(end - c - 1)));
+          next = d != nullptr ? d : end;
+          break;
+        }
+        if (!on_field(field, quoted_.data(), quoted_.size())) {
+          return field;
+        }
+      }
+      else {
+        auto* d = static_cast<const char*>(std::memchr(p, delim_, static_cast<size_t>(end - p)));
+        next = d != nullptr ? d : end;
+        if (!on_field(field, p, static_cast<size_t>(next - p))) {
+          return field;
+        }
+      }
+      field += 1;
+      if (field > max_field || next == end) {
+        return field;
+      }
+      p = next + 1;
+    }
+  }
+
+  static std::pair<const char*, const char*> trim(const char* data, size_t size) {
+    const char* b = data;
+    const char* e = data + size;
+    while (b < e && (*b == ' ' || *b == '\t')) {
+      b += 1;
+    }
+    while (e > b && (e[-1] == ' ' || e[-1] == '\t')) {
+      e -= 1;
+    }
+    return {b, e};
+  }
+
+  bool store(Column& col, const char* data, size_t size) {
+    switch (col.type) {
+      case ColumnType::String:
+        col.str_offsets.push_back(arena_.size());
+        arena_.append(data, size);
+        arena_.push_back('\0');
+        return true;
+      case ColumnType::I64: {
+        auto [b, e] = trim(data, size);
+        int64_t value = 0;
+        auto res = std::from_chars(b, e, value);
+        if (b == e || res.ec != std::errc() || res.ptr != e) {
+          return parse_error("integer", col, data, size);
+        }
+        col.i64.push_back(value);
+        return true;
+      }
+      case ColumnType::F64: {
+        auto [b, e] = trim(data, size);
+        double value = 0.0;
+        auto res = std::from_chars(b, e, value);
+        if (b == e || res.ec != std::errc() || res.ptr != e) {
+          return parse_error("float", col, data, size);
+        }
+        col.f64.push_back(value);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /* Drop the cells a rejected record already stored, so every column holds `rows` values. */
+  void truncate_columns(size_t rows) {
+    for (auto& col : columns_) {
+      col.i64.resize(std::min(col.i64.size(), rows));
+      col.f64.resize(std::min(col.f64.size(), rows));
+      col.str_offsets.resize(std::min(col.str_offsets.size(), rows));
+    }
+  }
+
+  bool parse_error(const char* what, const Column& col, const char* data, size_t size) {
+    parse_failed_ = true;
+    error_ = std::string("cannot parse ") + what + " from csv field '" + std::string(data, size)
+             + "' (column '" + col.name + "', row " + std::to_string(row_) + ")";
+    return false;
+  }
+
+public:
+  explicit StyioCsvReader(
+    char delim = ',',
+    size_t batch_rows = kDefaultBatchRows,
+    size_t block_bytes = kDefaultBlockBytes
+  ) :
+      delim_(delim),
+      batch_rows_(batch_rows == 0 ? kDefaultBatchRows : batch_rows),
+      block_bytes_(block_bytes == 0 ? kDefaultBlockBytes : block_bytes) {
+  }
+
+  StyioCsvReader(const StyioCsvReader&) = delete;
+  StyioCsvReader& operator=(const StyioCsvReader&) = delete;
+
+  /* Project a header column; call before open(). Returns the column index. */
+  size_t add_column(std::string name, ColumnType type) {
+    Column col;
+    col.name = std::move(name);
+    col.type = type;
+    columns_.push_back(std::move(col));
+    return columns_.size() - 1;
+  }
+
+  size_t column_count() const {
+    return columns_.size();
+  }
+
+  const Column& column(size_t index) const {
+    return columns_[index];
+  }
+
+  /* Set when open() or next_batch() failed. */
+  const std::string& error() const {
+    return error_;
+  }
+
+  /* The failure was a numeric cell that did not parse (rather than a missing column). */
+  bool parse_failed() const {
+    return parse_failed_;
+  }
+
+  /*
+    Read the header and resolve the projection. `fill` has the StyioLineReader contract:
+    bytes stored, 0 at end of input. Fails (see error()) when a projected column is not
+    in the header; an empty input has no rows and no columns to check.
+  */
+  template <typename Fill>
+  bool open(Fill&& fill) {
+    const char* data = nullptr;
+    size_t size = 0;
+    if (!next_record(fill, data, size)) {
+      return true;
+    }
+    /* Tolerate a UTF-8 byte order mark in front of the first header name. */
+    if (size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0) {
+      data += 3;
+      size -= 3;
+    }
+    std::vector<std::string> header;
+    split_record(data, size, SIZE_MAX, [&](size_t, const char* cell, size_t len) {
+      header.emplace_back(cell, len);
+      return true;
+    });
+
+    field_column_.assign(header.size(), -1);
+    last_field_ = 0;
+    for (size_t c = 0; c < columns_.size(); ++c) {
+      size_t field = 0;
+      while (field < header.size() && header[field] != columns_[c].name) {
+        field += 1;
+      }
+      if (field == header.size()) {
+        error_ = "csv column not found: '" + columns_[c].name + "'";
+        return false;
+      }
+      columns_[c].field = field;
+      if (field_column_[field] < 0) {
+        field_column_[field] = static_cast<int>(c);
+      }
+      last_field_ = std::max(last_field_, field);
+    }
+    return true;
+  }
+
+  /*
+    Parse the next batch; returns its row count, 0 at end of input. A record that fails
+    (bad numeric cell, missing field) ends the batch early: the rows before it are
+    returned with error() set, and every later call returns 0.
+  */
+  template <typename Fill>
+  size_t next_batch(Fill&& fill) {
+    arena_.clear();
+    for (auto& col : columns_) {
+      col.i64.clear();
+      col.f64.clear();
+      col.str.clear();
+      col.str_offsets.clear();
+    }
+    if (!error_.empty()) {
+      return 0;
+    }
+
+    size_t rows = 0;
+    const char* data = nullptr;
+    size_t size = 0;
+    while (rows < batch_rows_ && next_record(fill, data, size)) {
+      if (size == 0) {
+        continue;
+      }
+      row_ += 1;
+      bool ok = true;
+      const size_t fields = split_record(data, size, last_field_, [&](size_t field, const char* cell, size_t len) {
+        if (field < field_column_.size() && field_column_[field] >= 0) {
+          Column& col = columns_[static_cast<size_t>(field_column_[field])];
+          ok = store(col, cell, len);
+          /* Duplicate projections of one field copy the first one's value. */
+          for (size_t c = static_cast<size_t>(field_column_[field]) + 1; ok && c < columns_.size(); ++c) {
+            if (columns_[c].field == field) {
+              ok = store(columns_[c], cell, len);
+            }
+          }
+        }
+        return ok;
+      });
+      for (size_t c = 0; ok && c < columns_.size(); ++c) {
+        Column& col = columns_[c];
+        if (col.field < fields) {
+          continue;
+        }
+        if (col.type != ColumnType::String) {
+          error_ = "csv row " + std::to_string(row_) + " has no field for column '" + col.name + "'";
+          ok = false;
+          break;
+        }
+        store(col, "", 0);
+      }
+      if (!ok) {
+        truncate_columns(rows);
+        break;
+      }
+      rows += 1;
+    }
+
+    for (auto& col : columns_) {
+      if (col.type == ColumnType::String) {
+        col.str.reserve(col.str_offsets.size());
+        for (size_t off : col.str_offsets) {
+          col.str.push_back(arena_.data() + off);
+        }
+      }
+    }
+    return rows;
+  }
+};
+
+#endif // STYIO_RUNTIME_CSV_READER_HPP_
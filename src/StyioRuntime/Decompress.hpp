@@ -0,0 +1,278 @@
+#pragma once
+#ifndef STYIO_RUNTIME_DECOMPRESS_HPP_
+#define STYIO_RUNTIME_DECOMPRESS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+
+#if defined(STYIO_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+#if defined(STYIO_HAVE_ZSTD)
+#include <zstd.h>
+#endif
+
+/*
+  Streaming decompression behind `@{...}` inputs.
+
+  styio_file_open_auto sniffs the first bytes of a file; for a gzip or zstd stream the
+  handle reads through a StyioDecompressor instead of the raw descriptor. Compressed
+  bytes are pulled a block at a time through `source` and inflated straight into the
+  caller's buffer, so a line loop over `feed.gz` never holds more than one compressed
+  and one decompressed block. Concatenated members (`cat a.gz b.gz`, multi-frame zstd)
+  are read back to back, as gzip(1) and zstd(1) do.
+
+  Each codec is compiled in only when its library is (STYIO_HAVE_ZLIB, STYIO_HAVE_ZSTD);
+  available() lets the caller report a missing codec instead of handing out raw bytes.
+*/
+class StyioDecompressor
+{
+public:
+  enum class Codec
+  {
+    None,
+    Gzip,
+    Zstd,
+  };
+
+  /* Same contract as the StyioLineReader fill: bytes stored, 0 at end of input. */
+  using Source = std::function<size_t(char*, size_t)>;
+
+  static constexpr size_t kDefaultBlockBytes = size_t(256) << 10;
+  /* Bytes detect() needs to tell every codec apart. */
+  static constexpr size_t kMagicBytes = 4;
+
+  static Codec detect(const unsigned char* head, size_t size) {
+    if (size >= 2 && head[0] == 0x1f && head[1] == 0x8b) {
+      return Codec::Gzip;
+    }
+    if (size >= 4 && head[0] == 0x28 && head[1] == 0xb5 && head[2] == 0x2f && head[3] == 0xfd) {
+      return Codec::Zstd;
+    }
+    return Codec::None;
+  }
+
+  static const char* name(Codec codec) {
+    switch (codec) {
+      case Codec::Gzip:
+        return "gzip";
+      case Codec::Zstd:
+        return "zstd";
+      case Codec::None:
+        break;
+    }
+    return "none";
+  }
+
+  static bool available(Codec codec) {
+    switch (codec) {
+      case Codec::Gzip:
+#if defined(STYIO_HAVE_ZLIB)
+        return true;
+#else
+        return false;
+#endif
+      case Codec::Zstd:
+#if defined(STYIO_HAVE_ZSTD)
+        return true;
+#else
+        return false;
+#endif
+      case Codec::None:
+        break;
+    }
+    return false;
+  }
+
+private:
+  Codec codec_;
+  Source source_;
+  size_t block_bytes_;
+  std::unique_ptr<char[]> in_;
+  size_t in_pos_ = 0;
+  size_t in_end_ = 0;
+  bool in_eof_ = false;
+  /* Inside a member/frame: end of input here means the stream was cut short. */
+  bool in_member_ = false;
+  bool done_ = false;
+  std::string error_;
+
+#if defined(STYIO_HAVE_ZLIB)
+  z_stream zs_{};
+  bool zs_ready_ = false;
+#endif
+#if defined(STYIO_HAVE_ZSTD)
+  ZSTD_DCtx* zd_ = nullptr;
+#endif
+
+  /* Refill the compressed block once it is drained; false at end of input. */
+  bool refill() {
+    if (in_pos_ < in_end_) {
+      return true;
+    }
+    if (in_eof_) {
+      return false;
+    }
+    in_pos_ = 0;
+    in_end_ = source_(in_.get(), block_bytes_);
+    if (in_end_ == 0) {
+      in_eof_ = true;
+      return false;
+    }
+    return true;
+  }
+
+  size_t fail(std::string message) {
+    error_ = std::string(name(codec_)) + ": " + std::move(message);
+    done_ = true;
+    return 0;
+  }
+
+#if defined(STYIO_HAVE_ZLIB)
+  size_t read_gzip(char* dst, size_t cap) {
+    if (!zs_ready_) {
+      /* 16 + MAX_WBITS: gzip wrapper only, so a raw zlib stream is not accepted by accident. */
+      if (inflateInit2(&zs_, 16 + MAX_WBITS) != Z_OK) {
+        return fail("cannot initialize inflate");
+      }
+      zs_ready_ = true;
+    }
+    zs_.next_out = reinterpret_cast<Bytef*>(dst);
+    zs_.avail_out = static_cast<uInt>(cap > UINT32_MAX ? UINT32_MAX : cap);
+    const uInt out_cap = zs_.avail_out;
+    while (zs_.avail_out == out_cap) {
+      if (!refill()) {
+        if (in_member_) {
+          return fail("truncated stream");
+        }
+        done_ = true;
+        break;
+      }
+      zs_.next_in = reinterpret_cast<Bytef*>(in_.get() + in_pos_);
+      zs_.avail_in = static_cast<uInt>(in_end_ - in_pos_);
+      in_member_ = true;
+      const int rc = inflate(&zs_, Z_NO_FLUSH);
+      in_pos_ = in_end_ - zs_.avail_in;
+      if (rc == Z_STREAM_END) {
+        in_member_ = false;
+        inflateReset(&zs_);
+        if (zs_.avail_out != out_cap) {
+          break;
+        }
+        continue;
+      }
+      if (rc != Z_OK && rc != Z_BUF_ERROR) {
+        return fail(zs_.msg != nullptr ? zs_.msg : "corrupt stream");
+      }
+    }
+    return out_cap - zs_.avail_out;
+  }
+#endif
+
+#if defined(STYIO_HAVE_ZSTD)
+  size_t read_zstd(char* dst, size_t cap) {
+    if (zd_ == nullptr) {
+      zd_ = ZSTD_createDCtx();
+      if (zd_ == nullptr) {
+        return fail("cannot create decompression context");
+      }
+    }
+    ZSTD_outBuffer out{dst, cap, 0};
+    while (out.pos == 0) {
+      if (!refill()) {
+        if (in_member_) {
+          return fail("truncated stream");
+        }
+        done_ = true;
+        break;
+      }
+      ZSTD_inBuffer in{in_.get() + in_pos_, in_end_ - in_pos_, 0};
+      const size_t rc = ZSTD_decompressStream(zd_, &out, &in);
+      in_pos_ += in.pos;
+      if (ZSTD_isError(rc)) {
+        return fail(ZSTD_getErrorName(rc));
+      }
+      /* 0 means a frame just ended; a later frame starts fresh on the same context. */
+      in_member_ = rc != 0;
+    }
+    return out.pos;
+  }
+#endif
+
+public:
+  StyioDecompressor(Codec codec, Source source, size_t block_bytes = kDefaultBlockBytes) :
+      codec_(codec),
+      source_(std::move(source)),
+      block_bytes_(block_bytes == 0 ? kDefaultBlockBytes : block_bytes),
+      in_(new char[block_bytes_]) {
+  }
+
+  ~StyioDecompressor() {
+#if defined(STYIO_HAVE_ZLIB)
+    if (zs_ready_) {
+      inflateEnd(&zs_);
+    }
+#endif
+#if defined(STYIO_HAVE_ZSTD)
+    ZSTD_freeDCtx(zd_);
+#endif
+  }
+
+  StyioDecompressor(const StyioDecompressor&) = delete;
+  StyioDecompressor& operator=(const StyioDecompressor&) = delete;
+
+  Codec codec() const {
+    return codec_;
+  }
+
+  /* Set when the stream was corrupt or cut short; read() returns 0 from then on. */
+  const std::string& error() const {
+    return error_;
+  }
+
+  /* Decompress up to `cap` bytes into `dst`; 0 at end of input or on error (see error()). */
+  size_t read(char* dst, size_t cap) {
+    if (done_ || cap == 0) {
+      return 0;
+    }
+    switch (codec_) {
+#if defined(STYIO_HAVE_ZLIB)
+      case Codec::Gzip:
+        return read_gzip(dst, cap);
+#endif
+#if defined(STYIO_HAVE_ZSTD)
+      case Codec::Zstd:
+        return read_zstd(dst, cap);
+#endif
+      default:
+        break;
+    }
+    return fail("codec not available in this build");
+  }
+
+  /* Start over, e.g. after the underlying file was rewound. */
+  void reset() {
+    in_pos_ = 0;
+    in_end_ = 0;
+    in_eof_ = false;
+    in_member_ = false;
+    done_ = false;
+    error_.clear();
+#if defined(STYIO_HAVE_ZLIB)
+    if (zs_ready_) {
+      inflateReset(&zs_);
+    }
+#endif
+#if defined(STYIO_HAVE_ZSTD)
+    if (zd_ != nullptr) {
+      ZSTD_DCtx_reset(zd_, ZSTD_reset_session_only);
+    }
+#endif
+  }
+};
+
+#endif // STYIO_RUNTIME_DECOMPRESS_HPP_
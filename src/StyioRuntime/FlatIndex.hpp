@@ -0,0 +1,194 @@
+#pragma once
+#ifndef STYIO_RUNTIME_FLAT_INDEX_HPP_
+#define STYIO_RUNTIME_FLAT_INDEX_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string_view>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*
+  Open-addressing index behind the `flat-hash` dict backend.
+
+  The index maps a key hash to a position in the owner's dense entry array; it never
+  stores keys, so each key lives once (in the entry) and insertion order is the entry
+  order. Slots are probed sixteen at a time: a control byte per slot holds the low seven
+  bits of the hash (or kEmpty), one SSE2 compare finds the candidates of a whole group,
+  and only those are checked against the full hash kept inline in the slot before the
+  caller compares keys. A group with an empty byte ends the probe. Groups are visited in
+  triangular order, which reaches every group of a power-of-two table.
+
+  Entries are never erased (dicts only grow or are dropped whole), so there are no
+  tombstones; the table doubles at 7/8 load and rehashes from the stored hashes. String-
+  and i64-keyed dicts share it; hash_key has an overload for each key type.
+*/
+class StyioFlatIndex
+{
+public:
+  static constexpr uint32_t kNotFound = UINT32_MAX;
+  static constexpr size_t kGroupWidth = 16;
+
+  static uint64_t hash_key(std::string_view key) {
+    /* std::hash may be the identity on some libraries; fold it so both halves are mixed. */
+    return mix(static_cast<uint64_t>(std::hash<std::string_view>{}(key)));
+  }
+
+  /* Integer keys are mixed directly: dense ids would otherwise all land in one group. */
+  static uint64_t hash_key(int64_t key) {
+    return mix(static_cast<uint64_t>(key));
+  }
+
+private:
+  static constexpr uint8_t kEmpty = 0x80;
+
+  struct Slot
+  {
+    uint64_t hash;
+    uint32_t entry;
+  };
+
+  std::unique_ptr<uint8_t[]> ctrl_;
+  std::unique_ptr<Slot[]> slots_;
+  size_t group_mask_ = 0;
+  size_t capacity_ = 0;
+  size_t size_ = 0;
+
+  static uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+  static uint8_t h2(uint64_t hash) {
+    return static_cast<uint8_t>(hash & 0x7f);
+  }
+
+  static size_t h1(uint64_t hash) {
+    return static_cast<size_t>(hash >> 7);
+  }
+
+  /* Bit i set when control byte i of the group equals `byte`. */
+  static uint32_t match_byte(const uint8_t* group, uint8_t byte) {
+#if defined(__SSE2__)
+    const __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(static_cast<char>(byte)))));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < kGroupWidth; ++i) {
+      mask |= static_cast<uint32_t>(group[i] == byte) << i;
+    }
+    return mask;
+#endif
+  }
+
+  static unsigned lowest_bit(uint32_t mask) {
+    return static_cast<unsigned>(__builtin_ctz(mask));
+  }
+
+  void place(uint64_t hash, uint32_t entry) {
+    size_t group = h1(hash) & group_mask_;
+    for (size_t step = 1;; ++step) {
+      const uint8_t* ctrl = ctrl_.get() + group * kGroupWidth;
+      const uint32_t empty = match_byte(ctrl, kEmpty);
+      if (empty != 0) {
+        const size_t at = group * kGroupWidth + lowest_bit(empty);
+        ctrl_[at] = h2(hash);
+        slots_[at] = Slot{hash, entry};
+        return;
+      }
+      group = (group + step) & group_mask_;
+    }
+  }
+
+  void rehash(size_t capacity) {
+    std::unique_ptr<uint8_t[]> old_ctrl = std::move(ctrl_);
+    std::unique_ptr<Slot[]> old_slots = std::move(slots_);
+    const size_t old_capacity = capacity_;
+
+    ctrl_.reset(new uint8_t[capacity]);
+    std::memset(ctrl_.get(), kEmpty, capacity);
+    slots_.reset(new Slot[capacity]);
+    capacity_ = capacity;
+    group_mask_ = capacity / kGroupWidth - 1;
+    for (size_t i = 0; i < old_capacity; ++i) {
+      if (old_ctrl[i] != kEmpty) {
+        place(old_slots[i].hash, old_slots[i].entry);
+      }
+    }
+  }
+
+  static size_t capacity_for(size_t count) {
+    size_t capacity = kGroupWidth;
+    while (count > capacity - capacity / 8) {
+      capacity *= 2;
+    }
+    return capacity;
+  }
+
+public:
+  StyioFlatIndex() = default;
+  StyioFlatIndex(const StyioFlatIndex&) = delete;
+  StyioFlatIndex& operator=(const StyioFlatIndex&) = delete;
+
+  size_t size() const {
+    return size_;
+  }
+
+  void clear() {
+    ctrl_.reset();
+    slots_.reset();
+    group_mask_ = 0;
+    capacity_ = 0;
+    size_ = 0;
+  }
+
+  void reserve(size_t count) {
+    const size_t capacity = capacity_for(count);
+    if (capacity > capacity_) {
+      rehash(capacity);
+    }
+  }
+
+  /* Entry whose hash is `hash` and for which `same_key(entry)` holds, or kNotFound. */
+  template <typename SameKey>
+  uint32_t find(uint64_t hash, SameKey&& same_key) const {
+    if (size_ == 0) {
+      return kNotFound;
+    }
+    const uint8_t tag = h2(hash);
+    size_t group = h1(hash) & group_mask_;
+    for (size_t step = 1;; ++step) {
+      const uint8_t* ctrl = ctrl_.get() + group * kGroupWidth;
+      for (uint32_t hits = match_byte(ctrl, tag); hits != 0; hits &= hits - 1) {
+        const Slot& slot = slots_[group * kGroupWidth + lowest_bit(hits)];
+        if (slot.hash == hash && same_key(slot.entry)) {
+          return slot.entry;
+        }
+      }
+      if (match_byte(ctrl, kEmpty) != 0) {
+        return kNotFound;
+      }
+      group = (group + step) & group_mask_;
+    }
+  }
+
+  /* Record `entry` under `hash`; the caller has checked with find() that the key is new. */
+  void insert(uint64_t hash, uint32_t entry) {
+    if (size_ + 1 > capacity_ - capacity_ / 8) {
+      rehash(capacity_for(size_ + 1));
+    }
+    place(hash, entry);
+    size_ += 1;
+  }
+};
+
+#endif // STYIO_RUNTIME_FLAT_INDEX_HPP_
@@ -5,20 +5,39 @@
 #include <cstddef>
 #include <cstdint>
 #include <utility>
-#include <unordered_map>
-
+#include <vector>
+
+/*
+  Slab of runtime handles (files, lists, dicts, ...).
+
+  A handle is `generation << 32 | (slot index + 1)`: lookup is an index into `slots_`
+  plus a compare of the generation stored there, so a handle that outlived its release
+  (its slot reused or still free) is rejected without a hash probe. Released slots go
+  on a LIFO free list and come back with the next generation; a slot whose generation
+  would overflow is retired instead of reused. The low word is never 0, so 0 stays the
+  "no handle" value, and the first handles of a fresh table are 1, 2, 3, ...
+*/
 class StyioHandleTable
 {
 public:
   using HandleId = int64_t;
 
-  enum class HandleKind
+  /* One byte, so the kind check on lookup is a byte compare. */
+  enum class HandleKind : uint8_t
   {
     File = 0,
     Resource = 1,
     List = 2,
     Dict = 3,
     Unknown = 4,
+    /* Read-only memory-mapped regular file; shares the file handle entry points. */
+    MappedFile = 5,
+    /* Columnar `#(row: csv)` reader over a File or MappedFile handle it owns. */
+    Csv = 6,
+    /* Mapped `@col{...}` file being read. */
+    Columnar = 7,
+    /* Buffered `<< @col{...}` columns, written out on release. */
+    ColumnarWriter = 8,
   };
 
   struct Entry
@@ -29,28 +48,105 @@ public:
   };
 
 private:
-  std::unordered_map<HandleId, Entry> entries_;
-  HandleId next_handle_ = 1;
+  static constexpr uint32_t kNoFreeSlot = UINT32_MAX;
+  /* Generations stay below 2^31 so every handle is a positive int64. */
+  static constexpr uint32_t kMaxGeneration = (uint32_t(1) << 31) - 1;
+
+  struct Slot
+  {
+    Entry entry;
+    uint32_t generation = 0;
+    /* Next free slot while this one is on the free list. */
+    uint32_t next_free = kNoFreeSlot;
+    /* Live entry or reserved stub, as opposed to free or retired. */
+    bool occupied = false;
+  };
+
+  std::vector<Slot> slots_;
+  uint32_t free_head_ = kNoFreeSlot;
+  size_t occupied_ = 0;
+
+  static HandleId encode(uint32_t index, uint32_t generation) {
+    return static_cast<HandleId>((static_cast<uint64_t>(generation) << 32) | (static_cast<uint64_t>(index) + 1));
+  }
+
+  /* Occupied slot `id` refers to (stubs included), or nullptr for 0, stale and foreign ids. */
+  Slot* slot_of(HandleId id) {
+    const uint64_t bits = static_cast<uint64_t>(id);
+    const uint32_t low = static_cast<uint32_t>(bits);
+    if (id <= 0 || low == 0 || low > slots_.size()) {
+      return nullptr;
+    }
+    Slot& slot = slots_[low - 1];
+    if (!slot.occupied || slot.generation != static_cast<uint32_t>(bits >> 32)) {
+      return nullptr;
+    }
+    return &slot;
+  }
+
+  const Slot* slot_of(HandleId id) const {
+    return const_cast<StyioHandleTable*>(this)->slot_of(id);
+  }
+
+  HandleId place(Entry entry) {
+    uint32_t index = free_head_;
+    if (index != kNoFreeSlot) {
+      free_head_ = slots_[index].next_free;
+    }
+    else {
+      if (slots_.size() >= UINT32_MAX - 1) {
+        return 0;
+      }
+      index = static_cast<uint32_t>(slots_.size());
+      slots_.emplace_back();
+    }
+    Slot& slot = slots_[index];
+    slot.entry = entry;
+    slot.next_free = kNoFreeSlot;
+    slot.occupied = true;
+    occupied_ += 1;
+    return encode(index, slot.generation);
+  }
+
+  void free_slot(Slot& slot) {
+    slot.entry = Entry{};
+    slot.occupied = false;
+    occupied_ -= 1;
+    if (slot.generation == kMaxGeneration) {
+      return;
+    }
+    slot.generation += 1;
+    slot.next_free = free_head_;
+    free_head_ = static_cast<uint32_t>(&slot - slots_.data());
+  }
 
 public:
   HandleId acquire(HandleKind kind, void* ptr) {
     if (ptr == nullptr) {
       return 0;
     }
-    const HandleId id = next_handle_++;
-    entries_[id] = Entry{kind, ptr, true};
-    return id;
+    return place(Entry{kind, ptr, true});
   }
 
   void* lookup(HandleId id, HandleKind expected_kind = HandleKind::Unknown) const {
-    auto it = entries_.find(id);
-    if (it == entries_.end() || !it->second.valid) {
+    const Slot* slot = slot_of(id);
+    if (slot == nullptr || !slot->entry.valid) {
       return nullptr;
     }
-    if (expected_kind != HandleKind::Unknown && it->second.kind != expected_kind) {
+    if (expected_kind != HandleKind::Unknown && slot->entry.kind != expected_kind) {
       return nullptr;
     }
-    return it->second.ptr;
+    return slot->entry.ptr;
+  }
+
+  /* Live entry for `id`, or nullptr; lets callers dispatch on the kind with one lookup.
+     The pointer is into the slab, so it is only good until the next acquire. */
+  const Entry* lookup_entry(HandleId id) const {
+    const Slot* slot = slot_of(id);
+    if (slot == nullptr || !slot->entry.valid) {
+      return nullptr;
+    }
+    return &slot->entry;
   }
 
   template <typename T>
@@ -60,15 +156,15 @@ public:
 
   template <typename Closer>
   bool release(HandleId id, HandleKind expected_kind, Closer&& closer) {
-    auto it = entries_.find(id);
-    if (it == entries_.end() || !it->second.valid) {
+    Slot* slot = slot_of(id);
+    if (slot == nullptr || !slot->entry.valid) {
       return false;
     }
-    if (expected_kind != HandleKind::Unknown && it->second.kind != expected_kind) {
+    if (expected_kind != HandleKind::Unknown && slot->entry.kind != expected_kind) {
       return false;
     }
-    void* raw = it->second.ptr;
-    entries_.erase(it);
+    void* raw = slot->entry.ptr;
+    free_slot(*slot);
     if (raw != nullptr) {
       std::forward<Closer>(closer)(raw);
     }
@@ -79,22 +175,30 @@ public:
     return release(id, expected_kind, [](void*) {});
   }
 
+  /*
+    Release every live entry of `expected_kind` (all kinds for Unknown) and drop every stub.
+    Closers may release or acquire other handles: slots are revisited by index, and a slot
+    freed by a closer is simply skipped.
+  */
   template <typename Closer>
   size_t release_all(HandleKind expected_kind, Closer&& closer) {
     size_t released = 0;
-    for (auto it = entries_.begin(); it != entries_.end();) {
-      if (!it->second.valid) {
-        it = entries_.erase(it);
+    for (size_t i = 0; i < slots_.size(); ++i) {
+      Slot& slot = slots_[i];
+      if (!slot.occupied) {
+        continue;
+      }
+      if (!slot.entry.valid) {
+        free_slot(slot);
         continue;
       }
-      if (expected_kind != HandleKind::Unknown && it->second.kind != expected_kind) {
-        ++it;
+      if (expected_kind != HandleKind::Unknown && slot.entry.kind != expected_kind) {
         continue;
       }
-      void* raw = it->second.ptr;
-      it = entries_.erase(it);
+      void* raw = slot.entry.ptr;
+      free_slot(slot);
       if (raw != nullptr) {
-        std::forward<Closer>(closer)(raw);
+        closer(raw);
       }
       ++released;
     }
@@ -102,24 +206,21 @@ public:
   }
 
   HandleId reserve_stub(HandleKind kind) {
-    const HandleId id = next_handle_++;
-    entries_[id] = Entry{kind, nullptr, false};
-    return id;
+    return place(Entry{kind, nullptr, false});
   }
 
   bool contains(HandleId id) const {
-    return entries_.find(id) != entries_.end();
+    return slot_of(id) != nullptr;
   }
 
   void invalidate(HandleId id) {
-    auto it = entries_.find(id);
-    if (it != entries_.end()) {
-      entries_.erase(it);
+    if (Slot* slot = slot_of(id)) {
+      free_slot(*slot);
     }
   }
 
   size_t size() const {
-    return entries_.size();
+    return occupied_;
   }
 };
 
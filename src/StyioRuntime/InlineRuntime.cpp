@@ -0,0 +1,40 @@
+/*
+  Inlinable twins of hot runtime helpers.
+
+  This file is never linked into a binary. The build compiles it to LLVM bitcode
+  and embeds the result in the compiler (see InlineRuntimeBitcode.hpp), and
+  StyioToLLVM links the definitions into optimized modules as
+  available_externally so the inliner can see through them. Calls that survive
+  optimization still resolve to ExternLib.cpp, which stays the single source of
+  truth for runtime state.
+
+  Every definition here must behave exactly like its ExternLib.cpp counterpart
+  and may only touch its arguments or call other exported helpers: runtime state
+  (handle table, error flag, owned strings) is thread_local inside ExternLib.cpp
+  and not addressable from generated code.
+*/
+
+#include "StyioExtern/ExternLib.hpp"
+
+extern "C" DLLEXPORT int64_t
+styio_cstr_to_i64(const char* s) {
+  /* Plain decimal that cannot overflow; everything else takes the strtoll path. */
+  if (s != nullptr) {
+    const char* p = s;
+    const bool negative = (*p == '-');
+    if (negative) {
+      ++p;
+    }
+    int64_t value = 0;
+    int digits = 0;
+    while (*p >= '0' && *p <= '9' && digits < 18) {
+      value = value * 10 + (*p - '0');
+      ++p;
+      ++digits;
+    }
+    if (digits > 0 && *p == '\0') {
+      return negative ? -value : value;
+    }
+  }
+  return styio_cstr_to_i64_slow(s);
+}
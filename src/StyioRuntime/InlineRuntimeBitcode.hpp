@@ -0,0 +1,13 @@
+#pragma once
+#ifndef STYIO_RUNTIME_INLINE_RUNTIME_BITCODE_HPP_
+#define STYIO_RUNTIME_INLINE_RUNTIME_BITCODE_HPP_
+
+#include <cstddef>
+
+/* Bitcode of src/StyioRuntime/InlineRuntime.cpp, generated at build time.
+   Empty when the build had no compatible clang; callers must treat size 0 as
+   "nothing to inline". */
+extern const unsigned char styio_inline_runtime_bitcode[];
+extern const size_t styio_inline_runtime_bitcode_size;
+
+#endif // STYIO_RUNTIME_INLINE_RUNTIME_BITCODE_HPP_
@@ -0,0 +1,135 @@
+#pragma once
+#ifndef STYIO_RUNTIME_LINE_READER_HPP_
+#define STYIO_RUNTIME_LINE_READER_HPP_
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+/*
+  Block reader behind `@file{...}` / `@stdin` line iteration.
+
+  Input is pulled in large blocks through a fill callback and split with memchr. Each
+  line is terminated in place (the '\n', and any '\r' before it, become '\0'), so the
+  returned slice is both length-delimited and a valid C string without a copy. A line
+  longer than the buffer grows it; there is no line-length limit.
+
+  A slice stays valid until the next call to next() or reset() on the same reader.
+*/
+class StyioLineReader
+{
+public:
+  static constexpr size_t kDefaultBlockBytes = size_t(1) << 20;
+
+  struct Line
+  {
+    const char* data = nullptr;
+    size_t size = 0;
+  };
+
+private:
+  std::unique_ptr<char[]> buf_;
+  size_t capacity_ = 0;
+  size_t block_bytes_ = kDefaultBlockBytes;
+  /* Unconsumed bytes are [begin_, end_); [begin_, scanned_) is known to hold no '\n'. */
+  size_t begin_ = 0;
+  size_t scanned_ = 0;
+  size_t end_ = 0;
+
+  static size_t strip_cr(char* data, size_t size) {
+    while (size > 0 && data[size - 1] == '\r') {
+      data[--size] = '\0';
+    }
+    return size;
+  }
+
+public:
+  explicit StyioLineReader(size_t block_bytes = kDefaultBlockBytes) :
+      block_bytes_(block_bytes == 0 ? kDefaultBlockBytes : block_bytes) {
+  }
+
+  StyioLineReader(const StyioLineReader&) = delete;
+  StyioLineReader& operator=(const StyioLineReader&) = delete;
+
+  /* Drop buffered input, e.g. after the underlying stream was rewound. */
+  void reset() {
+    begin_ = 0;
+    scanned_ = 0;
+    end_ = 0;
+  }
+
+  /* Bytes read from the source but not yet returned as lines. */
+  std::pair<const char*, size_t> buffered() const {
+    return {buf_.get() + begin_, end_ - begin_};
+  }
+
+  void consume_buffered() {
+    reset();
+  }
+
+  /*
+    `fill(char* dst, size_t cap)` returns the number of bytes stored (0 at end of input).
+    It may return fewer than `cap` bytes, e.g. whatever a pipe has available, so
+    interactive input is never held back waiting for a full block.
+  */
+  template <typename Fill>
+  bool next(Line& out, Fill&& fill) {
+    while (true) {
+      if (scanned_ < end_) {
+        char* base = buf_.get();
+        auto* nl = static_cast<char*>(std::memchr(base + scanned_, '\n', end_ - scanned_));
+        if (nl != nullptr) {
+          char* data = base + begin_;
+          *nl = '\0';
+          out.data = data;
+          out.size = strip_cr(data, static_cast<size_t>(nl - data));
+          begin_ = static_cast<size_t>(nl - base) + 1;
+          scanned_ = begin_;
+          return true;
+        }
+        scanned_ = end_;
+      }
+
+      /* Keep the partial line; grow only when less than half a block (plus the terminator) fits. */
+      if (begin_ > 0) {
+        std::memmove(buf_.get(), buf_.get() + begin_, end_ - begin_);
+        end_ -= begin_;
+        scanned_ = end_;
+        begin_ = 0;
+      }
+      const size_t min_free = (block_bytes_ > 1 ? block_bytes_ / 2 : 1) + 1;
+      if (capacity_ - end_ < min_free) {
+        size_t grown = capacity_ == 0 ? block_bytes_ + 1 : capacity_ * 2;
+        while (grown - end_ < min_free) {
+          grown *= 2;
+        }
+        std::unique_ptr<char[]> next_buf(new char[grown]);
+        if (end_ > 0) {
+          std::memcpy(next_buf.get(), buf_.get(), end_);
+        }
+        buf_ = std::move(next_buf);
+        capacity_ = grown;
+      }
+
+      const size_t got = fill(buf_.get() + end_, capacity_ - end_ - 1);
+      if (got == 0) {
+        if (begin_ == end_) {
+          reset();
+          return false;
+        }
+        /* Last line without a trailing newline. */
+        char* data = buf_.get() + begin_;
+        buf_[end_] = '\0';
+        out.data = data;
+        out.size = strip_cr(data, end_ - begin_);
+        begin_ = end_;
+        scanned_ = end_;
+        return true;
+      }
+      end_ += got;
+    }
+  }
+};
+
+#endif // STYIO_RUNTIME_LINE_READER_HPP_
@@ -0,0 +1,129 @@
+#pragma once
+#ifndef STYIO_RUNTIME_READ_AHEAD_HPP_
+#define STYIO_RUNTIME_READ_AHEAD_HPP_
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/*
+  Double-buffered read-ahead for one input source.
+
+  A worker thread reads the next block into `slot_` while the consumer parses the block
+  it took last (held in its own StyioLineReader buffer), so a stream loop overlaps disk
+  reads with the JITted body instead of stalling in the loop header. Each file handle
+  owns its worker, so the two inputs of a zip are prefetched concurrently.
+
+  Only meant for sources whose reads always complete (regular files): stop() joins the
+  worker, which would hang on a pipe nobody writes to.
+*/
+class StyioReadAhead
+{
+public:
+  /* Same contract as the StyioLineReader fill: bytes stored, 0 at end of input. */
+  using Source = std::function<size_t(char*, size_t)>;
+
+  static constexpr size_t kDefaultBlockBytes = size_t(1) << 20;
+
+private:
+  Source source_;
+  size_t block_bytes_;
+  std::unique_ptr<char[]> slot_;
+  size_t slot_size_ = 0;
+  size_t slot_pos_ = 0;
+  bool slot_full_ = false;
+  bool stopping_ = false;
+  bool running_ = false;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread worker_;
+
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      cv_.wait(lock, [this] { return stopping_ || !slot_full_; });
+      if (stopping_) {
+        return;
+      }
+      lock.unlock();
+      size_t got = 0;
+      while (got < block_bytes_) {
+        const size_t n = source_(slot_.get() + got, block_bytes_ - got);
+        if (n == 0) {
+          break;
+        }
+        got += n;
+      }
+      lock.lock();
+      slot_size_ = got;
+      slot_pos_ = 0;
+      slot_full_ = true;
+      cv_.notify_all();
+      if (got == 0) {
+        /* End of input: the empty slot stays full, so take() keeps returning 0. */
+        return;
+      }
+    }
+  }
+
+public:
+  explicit StyioReadAhead(Source source, size_t block_bytes = kDefaultBlockBytes) :
+      source_(std::move(source)), block_bytes_(block_bytes == 0 ? kDefaultBlockBytes : block_bytes) {
+  }
+
+  ~StyioReadAhead() {
+    stop();
+  }
+
+  StyioReadAhead(const StyioReadAhead&) = delete;
+  StyioReadAhead& operator=(const StyioReadAhead&) = delete;
+
+  /* Copy up to `cap` prefetched bytes into `dst`, waiting for the worker if needed. */
+  size_t take(char* dst, size_t cap) {
+    if (!running_) {
+      if (!slot_) {
+        slot_.reset(new char[block_bytes_]);
+      }
+      running_ = true;
+      worker_ = std::thread([this] { run(); });
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return slot_full_; });
+    const size_t n = std::min(cap, slot_size_ - slot_pos_);
+    if (n == 0) {
+      return 0;
+    }
+    std::memcpy(dst, slot_.get() + slot_pos_, n);
+    slot_pos_ += n;
+    if (slot_pos_ == slot_size_) {
+      slot_full_ = false;
+      cv_.notify_all();
+    }
+    return n;
+  }
+
+  /* Join the worker and drop the prefetched block, e.g. before the source is rewound.
+     The next take() starts over from the source's current position. */
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) {
+      worker_.join();
+    }
+    stopping_ = false;
+    running_ = false;
+    slot_full_ = false;
+    slot_size_ = 0;
+    slot_pos_ = 0;
+  }
+};
+
+#endif // STYIO_RUNTIME_READ_AHEAD_HPP_
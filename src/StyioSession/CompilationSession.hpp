@@ -2,6 +2,9 @@
 #ifndef STYIO_COMPILATION_SESSION_HPP_
 #define STYIO_COMPILATION_SESSION_HPP_
 
+#include <chrono>
+#include <cstdint>
+#include <ctime>
 #include <stdexcept>
 #include <string>
 #include <utility>
@@ -25,6 +28,18 @@ enum class CompilationPhase
   Failed,
 };
 
+/* One phase transition as seen by --time-report: cost since the previous transition. */
+struct CompilationPhaseTiming
+{
+  CompilationPhase from = CompilationPhase::Empty;
+  CompilationPhase to = CompilationPhase::Empty;
+  const char* operation = "";
+  std::uint64_t wall_us = 0;
+  std::uint64_t cpu_us = 0;
+  std::size_t token_arena_bytes = 0;
+  std::size_t ast_arena_bytes = 0;
+};
+
 /**
  * Checkpoint C.1/C.2 shell:
  * Own compiler graph lifetimes in one place so each migration step can be merged safely.
@@ -41,6 +56,10 @@ private:
   styio::session_alloc::SessionArena* previous_ast_arena_ = nullptr;
   styio::session_alloc::SessionArena* previous_token_arena_ = nullptr;
   CompilationPhase phase_ = CompilationPhase::Empty;
+  bool phase_timing_enabled_ = false;
+  std::chrono::steady_clock::time_point phase_wall_mark_;
+  std::clock_t phase_cpu_mark_ = 0;
+  std::vector<CompilationPhaseTiming> phase_timings_;
 
   static int phase_rank(CompilationPhase phase) {
     switch (phase) {
@@ -109,7 +128,32 @@ private:
         + " -> "
         + phase_name(next));
     }
+    const CompilationPhase previous = phase_;
     phase_ = next;
+    if (phase_timing_enabled_) {
+      record_phase_timing(previous, operation);
+    }
+  }
+
+  void record_phase_timing(CompilationPhase previous, const char* operation) {
+    const auto wall_now = std::chrono::steady_clock::now();
+    const std::clock_t cpu_now = std::clock();
+    CompilationPhaseTiming timing;
+    timing.from = previous;
+    timing.to = phase_;
+    timing.operation = operation;
+    timing.wall_us = static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(wall_now - phase_wall_mark_).count());
+    /* std::clock is process CPU time, so parallel JIT workers are included. */
+    timing.cpu_us = cpu_now >= phase_cpu_mark_
+      ? static_cast<std::uint64_t>(
+          static_cast<double>(cpu_now - phase_cpu_mark_) * 1000000.0 / CLOCKS_PER_SEC)
+      : 0;
+    timing.token_arena_bytes = token_arena_.bytes_used();
+    timing.ast_arena_bytes = ast_arena_.bytes_used();
+    phase_timings_.push_back(timing);
+    phase_wall_mark_ = wall_now;
+    phase_cpu_mark_ = cpu_now;
   }
 
   void activate_session_arenas() {
@@ -168,6 +212,24 @@ public:
     ast_arena_.release();
     token_arena_.release();
     phase_ = CompilationPhase::Empty;
+    phase_timings_.clear();
+    if (phase_timing_enabled_) {
+      enable_phase_timing();
+    }
+  }
+
+  /**
+   * Start recording one CompilationPhaseTiming per transition. Work done before the
+   * first transition (tokenizing) is charged to it, so enable before starting.
+   */
+  void enable_phase_timing() {
+    phase_timing_enabled_ = true;
+    phase_wall_mark_ = std::chrono::steady_clock::now();
+    phase_cpu_mark_ = std::clock();
+  }
+
+  const std::vector<CompilationPhaseTiming>& phase_timings() const {
+    return phase_timings_;
   }
 
   void adopt_tokens(std::vector<StyioToken*>&& tokens) {
@@ -0,0 +1,154 @@
+#include "StyioSession/PreparedProgram.hpp"
+
+#include <exception>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "StyioAnalyzer/ASTAnalyzer.hpp"
+#include "StyioCodeGen/CodeGenVisitor.hpp"
+#include "StyioException/Exception.hpp"
+#include "StyioExtern/ExternLib.hpp"
+#include "StyioJIT/StyioJIT_ORC.hpp"
+#include "StyioParser/Parser.hpp"
+#include "StyioParser/Tokenizer.hpp"
+#include "StyioSession/CompilationSession.hpp"
+
+#include "llvm/Support/Error.h"
+#include "llvm/Support/TargetSelect.h"
+
+namespace styio {
+
+struct PreparedProgram::Impl
+{
+  std::unique_ptr<StyioJIT_ORC> jit;
+  StyioJITProgram program;
+
+  ~Impl() {
+    if (program.tracker) {
+      if (llvm::Error err = program.tracker->remove()) {
+        llvm::consumeError(std::move(err));
+      }
+    }
+  }
+};
+
+namespace {
+
+/* Same text/line layout the CLI builds when it reads a file line by line. */
+void
+split_source_lines(
+  const std::string& source_text,
+  std::string& code_text,
+  std::vector<std::pair<size_t, size_t>>& line_seps
+) {
+  size_t begin = 0;
+  while (begin < source_text.size()) {
+    size_t end = source_text.find('\n', begin);
+    if (end == std::string::npos) {
+      end = source_text.size();
+    }
+    line_seps.emplace_back(code_text.size(), end - begin);
+    code_text.append(source_text, begin, end - begin);
+    code_text.push_back('\n');
+    begin = end + 1;
+  }
+}
+
+std::string
+llvm_error_message(llvm::Error err) {
+  std::string message;
+  llvm::handleAllErrors(std::move(err), [&](const llvm::ErrorInfoBase& e) { message = e.message(); });
+  return message;
+}
+
+} // namespace
+
+PreparedProgram::PreparedProgram(std::unique_ptr<Impl> impl) :
+    impl_(std::move(impl)) {
+}
+
+PreparedProgram::~PreparedProgram() = default;
+
+std::unique_ptr<PreparedProgram>
+PreparedProgram::compile(
+  const std::string& source_text,
+  const std::string& file_name,
+  const PreparedProgramOptions& options,
+  std::string& error_message
+) {
+  std::string code_text;
+  std::vector<std::pair<size_t, size_t>> line_seps;
+  split_source_lines(source_text, code_text, line_seps);
+
+  CompilationSession session;
+  try {
+    session.adopt_tokens(StyioTokenizer::tokenize(code_text));
+    session.attach_context(StyioContext::Create(file_name, code_text, line_seps, session.tokens(), false));
+    session.attach_ast(parse_main_block_with_engine_latest(*session.context(), StyioParserEngine::Nightly, nullptr));
+    StyioAnalyzer analyzer;
+    analyzer.typeInfer(session.ast());
+    session.mark_type_checked();
+    session.attach_ir(analyzer.toStyioIR(session.ast()));
+  } catch (const std::exception& ex) {
+    error_message = ex.what();
+    return nullptr;
+  }
+
+  llvm::InitializeNativeTarget();
+  llvm::InitializeNativeTargetAsmPrinter();
+  llvm::InitializeNativeTargetAsmParser();
+
+  StyioJITTargetOptions target_options;
+  target_options.cpu = options.target_cpu;
+  target_options.features = options.target_features;
+  auto jit_or_err = StyioJIT_ORC::Create(
+    target_options,
+    nullptr,
+    options.lazy ? StyioJITCompileMode::Lazy : StyioJITCompileMode::Eager,
+    options.jit_threads);
+  if (!jit_or_err) {
+    error_message = llvm_error_message(jit_or_err.takeError());
+    return nullptr;
+  }
+
+  auto impl = std::make_unique<Impl>();
+  try {
+    StyioToLLVM generator(std::move(*jit_or_err));
+    session.ir()->toLLVMIR(&generator);
+    generator.optimize_module(options.opt_level);
+    session.mark_codegen_ready();
+    auto program = generator.load_program();
+    impl->jit = generator.release_jit();
+    if (!program) {
+      error_message = llvm_error_message(program.takeError());
+      return nullptr;
+    }
+    impl->program = std::move(*program);
+  } catch (const std::exception& ex) {
+    error_message = ex.what();
+    return nullptr;
+  }
+
+  return std::unique_ptr<PreparedProgram>(new PreparedProgram(std::move(impl)));
+}
+
+PreparedRunResult
+PreparedProgram::run() {
+  styio_runtime_reset();
+  impl_->program.entry();
+  /* Runs are independent: files this run wrote are complete when run() returns. */
+  styio_file_release_writes();
+
+  PreparedRunResult result;
+  if (styio_runtime_has_error()) {
+    const char* message = styio_runtime_last_error();
+    const char* subcode = styio_runtime_last_error_subcode();
+    result.exit_code = 5;
+    result.error_message = message != nullptr ? message : "runtime helper reported error";
+    result.error_subcode = subcode != nullptr ? subcode : "";
+  }
+  return result;
+}
+
+} // namespace styio
@@ -0,0 +1,60 @@
+#pragma once
+#ifndef STYIO_PREPARED_PROGRAM_HPP_
+#define STYIO_PREPARED_PROGRAM_HPP_
+
+#include <memory>
+#include <string>
+
+namespace styio {
+
+/* Compile-time knobs; the defaults match a plain `styio --file` run. */
+struct PreparedProgramOptions
+{
+  unsigned opt_level = 0;
+  std::string target_cpu;      /* empty: host CPU */
+  std::string target_features; /* comma separated LLVM features on top of the CPU defaults */
+  bool lazy = false;           /* compile functions on first call (--jit-mode=lazy) */
+  unsigned jit_threads = 1;    /* > 1 splits the module across compile threads (--jit-threads) */
+};
+
+/* Outcome of one run. exit_code follows the CLI: 0 on success, 5 on a runtime error. */
+struct PreparedRunResult
+{
+  int exit_code = 0;
+  std::string error_message;
+  std::string error_subcode;
+};
+
+/**
+ * A Styio program compiled once and kept loaded in its own JIT, for embedders that run the
+ * same program over many inputs. Each run() starts from fresh runtime state: the helper
+ * runtime (ExternLib) is reset, which closes every handle and clears the error flag, before
+ * `main` is called. Runtime state is thread_local, so run() affects the calling thread only.
+ * Destroying the object removes the program's code through its JIT resource tracker.
+ */
+class PreparedProgram
+{
+public:
+  /* nullptr on lex/parse/type/codegen/JIT failure, with the reason in error_message. */
+  static std::unique_ptr<PreparedProgram> compile(
+    const std::string& source_text,
+    const std::string& file_name,
+    const PreparedProgramOptions& options,
+    std::string& error_message);
+
+  PreparedProgram(const PreparedProgram&) = delete;
+  PreparedProgram& operator=(const PreparedProgram&) = delete;
+  ~PreparedProgram();
+
+  PreparedRunResult run();
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+
+  explicit PreparedProgram(std::unique_ptr<Impl> impl);
+};
+
+} // namespace styio
+
+#endif // STYIO_PREPARED_PROGRAM_HPP_
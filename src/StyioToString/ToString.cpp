@@ -485,6 +485,7 @@ StyioRepr::toString(FileResourceAST* ast, int indent) {
   return reprASTType(ast->getNodeType(), " ")
          + " {\n"
          + make_padding(indent) + "auto_detect: " + (ast->isAutoDetect() ? "true" : "false") + "\n"
+         + (ast->isColumnar() ? make_padding(indent) + "columnar: true\n" : std::string())
          + make_padding(indent) + "path: " + ast->getPath()->toString(this, indent + 1)
          + "}";
 }
@@ -1380,7 +1381,7 @@ std::string
 StyioRepr::toString(SGDictLiteral* node, int indent) {
   (void)indent;
   return std::string("styio.ir.dict_literal { entries=") + std::to_string(node->entries.size())
-    + ", value=" + node->value_type + " }";
+    + ", key_type=" + node->key_type + ", value=" + node->value_type + " }";
 }
 
 std::string
@@ -1486,6 +1487,9 @@ StyioRepr::toString(SGFileLineIter* node, int indent) {
   std::string s = "styio.ir.file_line_iter { ";
   if (node->from_path) {
     s += "path=" + (node->path_expr ? node->path_expr->toString(this, indent) : std::string("null"));
+    if (node->is_auto) {
+      s += ", auto=1";
+    }
   }
   else {
     s += "handle=" + node->handle_var;
@@ -1496,6 +1500,61 @@ StyioRepr::toString(SGFileLineIter* node, int indent) {
   return s;
 }
 
+std::string
+StyioRepr::toString(SGCsvIter* node, int indent) {
+  std::string s = "styio.ir.csv_iter { path=";
+  s += node->path_expr ? node->path_expr->toString(this, indent) : std::string("null");
+  s += ", row=" + node->row_var + ", columns=[";
+  for (size_t i = 0; i < node->columns.size(); ++i) {
+    if (i > 0) {
+      s += ", ";
+    }
+    s += node->columns[i].type + ":" + node->columns[i].name;
+  }
+  s += "], body=" + (node->body ? node->body->toString(this, indent) : std::string("{}"));
+  s += " }";
+  return s;
+}
+
+std::string
+StyioRepr::toString(SGCsvField* node, int indent) {
+  (void)indent;
+  return "styio.ir.csv_field { " + node->row_var + "[" + std::to_string(node->column) + "], "
+         + node->type + " }";
+}
+
+std::string
+StyioRepr::toString(SGColumnarIter* node, int indent) {
+  std::string s = "styio.ir.columnar_iter { path=";
+  s += node->path_expr ? node->path_expr->toString(this, indent) : std::string("null");
+  s += ", columns=[";
+  for (size_t i = 0; i < node->columns.size(); ++i) {
+    if (i > 0) {
+      s += ", ";
+    }
+    s += node->columns[i].type + ":" + node->columns[i].name;
+  }
+  s += "], body=" + (node->body ? node->body->toString(this, indent) : std::string("{}"));
+  s += " }";
+  return s;
+}
+
+std::string
+StyioRepr::toString(SGColumnarWrite* node, int indent) {
+  std::string s = "styio.ir.columnar_write { path=";
+  s += node->path_expr ? node->path_expr->toString(this, indent) : std::string("null");
+  s += ", columns=[";
+  for (size_t i = 0; i < node->columns.size(); ++i) {
+    if (i > 0) {
+      s += ", ";
+    }
+    s += node->columns[i].type + ":" + node->columns[i].name + "="
+         + (node->columns[i].value ? node->columns[i].value->toString(this, indent) : std::string("null"));
+  }
+  s += "] }";
+  return s;
+}
+
 std::string
 StyioRepr::toString(SGStreamZip* node, int indent) {
   (void)indent;
@@ -1579,7 +1638,7 @@ StyioRepr::toString(SGDictGet* node, int indent) {
   return std::string("styio.ir.dict_get { dict=")
     + (node->dict ? node->dict->toString(this, indent) : std::string("null"))
     + ", key=" + (node->key ? node->key->toString(this, indent) : std::string("null"))
-    + ", value=" + node->value_type + " }";
+    + ", key_type=" + node->key_type + ", value=" + node->value_type + " }";
 }
 
 std::string
@@ -1588,7 +1647,7 @@ StyioRepr::toString(SGDictSet* node, int indent) {
     + (node->dict ? node->dict->toString(this, indent) : std::string("null"))
     + ", key=" + (node->key ? node->key->toString(this, indent) : std::string("null"))
     + ", value=" + (node->value ? node->value->toString(this, indent) : std::string("null"))
-    + ", type=" + node->value_type + " }";
+    + ", key_type=" + node->key_type + ", type=" + node->value_type + " }";
 }
 
 std::string
@@ -378,6 +378,10 @@ public:
 
   std::string toString(SGHandleAcquire* node, int indent = 0);
   std::string toString(SGFileLineIter* node, int indent = 0);
+  std::string toString(SGCsvIter* node, int indent = 0);
+  std::string toString(SGCsvField* node, int indent = 0);
+  std::string toString(SGColumnarIter* node, int indent = 0);
+  std::string toString(SGColumnarWrite* node, int indent = 0);
   std::string toString(SGStreamZip* node, int indent = 0);
   std::string toString(SGSnapshotDecl* node, int indent = 0);
   std::string toString(SGSnapshotShadowLoad* node, int indent = 0);
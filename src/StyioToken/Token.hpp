@@ -930,6 +930,12 @@ styio_type_supports_runtime_dict_value(const StyioDataType& type) {
     || styio_value_family_is_runtime_handle(family);
 }
 
+/* dict[i64,V] is backed by integer-keyed runtime storage (styio_idict_*); any other key is a string. */
+inline bool
+styio_dict_has_i64_keys(const StyioDataType& type) {
+  return styio_dict_key_value_family(type) == StyioValueFamily::Integer;
+}
+
 inline StyioDataType
 styio_make_range_type(const std::string& elem_name = "i64") {
   return StyioDataType{
@@ -964,6 +970,12 @@ styio_make_file_handle_type(const std::string& elem_name = "i64") {
     StyioValueFamily::FileHandle};
 }
 
+/* Row parameter of a `#(row: csv)` loop; the only operation on it is `row["column"]`. */
+inline StyioDataType
+styio_make_csv_row_type() {
+  return StyioDataType{StyioDataTypeOption::Defined, "csv", 0};
+}
+
 inline StyioDataType
 styio_make_std_stream_type(
   StdStreamKind kind,
@@ -19,10 +19,12 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <optional>
 #include <regex>
 #include <set>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <type_traits>
 #include <unordered_map>
@@ -35,6 +37,7 @@
 #include "StyioCodeGen/CodeGenVisitor.hpp" /* StyioToLLVMIR Code Generator */
 #include "StyioException/Exception.hpp"
 #include "StyioExtern/ExternLib.hpp"
+#include "StyioJIT/StyioObjectCache.hpp"
 #include "StyioIR/StyioIR.hpp" /* StyioIR */
 #include "StyioParser/Parser.hpp"
 #include "StyioParser/Tokenizer.hpp"
@@ -56,6 +59,8 @@
 #include "llvm/Support/Error.h" /* ExitOnErr */
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/JSON.h"
+#include "llvm/Support/SHA256.h"
+#include "llvm/ADT/StringExtras.h" /* toHex */
 
 // [Styio LLVM ORC JIT]
 #include "StyioJIT/StyioJIT_ORC.hpp"
@@ -75,6 +80,14 @@
 #define STYIO_EDITION_MAX "2026"
 #endif
 
+#ifndef STYIO_RUNTIME_LIB_PATH
+#define STYIO_RUNTIME_LIB_PATH ""
+#endif
+
+#ifndef STYIO_RUNTIME_EXTRA_LIBS
+#define STYIO_RUNTIME_EXTRA_LIBS ""
+#endif
+
 #ifndef STYIO_LLVM_DIR
 #define STYIO_LLVM_DIR ""
 #endif
@@ -340,6 +353,11 @@ styio_nano_disabled_option_latest(int argc, char* argv[]) {
     if (styio_arg_matches_latest(argv[i], "--compile-plan")) {
       return "compile-plan consumer is only available in the full styio compiler";
     }
+    if (styio_arg_matches_latest(argv[i], "--emit-obj")
+        || styio_arg_matches_latest(argv[i], "--emit-exe")
+        || styio_arg_matches_latest(argv[i], "--runtime-lib")) {
+      return "ahead-of-time output is only available in the full styio compiler";
+    }
     if (styio_arg_matches_latest(argv[i], "--nano-create")
         || styio_arg_matches_latest(argv[i], "--nano-publish")
         || styio_arg_matches_latest(argv[i], "--nano-package-config")
@@ -417,6 +435,10 @@ struct StyioProjectConfigLatest
 {
   bool has_dict_impl = false;
   std::string dict_impl_raw;
+  bool has_output_flush = false;
+  std::string output_flush_raw;
+  bool has_file_source = false;
+  std::string file_source_raw;
   std::string loaded_from;
 };
 
@@ -427,6 +449,12 @@ struct StyioDictImplSelectionLatest
   std::string config_path;
 };
 
+struct StyioJITTargetSelectionLatest
+{
+  StyioJITTargetOptions options;
+  std::string source = "host";
+};
+
 struct StyioNanoPackageConfigLatest
 {
   bool has_mode = false;
@@ -639,26 +667,40 @@ styio_parse_project_config_latest(
     const std::string key = styio_trim_copy_latest(stripped.substr(0, eq));
     const std::string raw_value = stripped.substr(eq + 1);
 
-    bool interested = false;
-    if (section.empty() || section == "runtime") {
-      interested = key == "dict_impl" || key == "dictionary_impl";
-    }
-    else if (section == "dict" || section == "dictionary") {
-      interested = key == "impl";
-    }
-    if (!interested) {
+    /* Canonical setting name, for diagnostics, plus the fields it fills. */
+    const char* setting = nullptr;
+    bool* has_value = nullptr;
+    std::string* value = nullptr;
+    const bool runtime_section = section.empty() || section == "runtime";
+    if ((runtime_section && (key == "dict_impl" || key == "dictionary_impl"))
+        || ((section == "dict" || section == "dictionary") && key == "impl")) {
+      setting = "dict_impl";
+      has_value = &out_config.has_dict_impl;
+      value = &out_config.dict_impl_raw;
+    }
+    else if (runtime_section && key == "output_flush") {
+      setting = "output_flush";
+      has_value = &out_config.has_output_flush;
+      value = &out_config.output_flush_raw;
+    }
+    else if (runtime_section && key == "file_source") {
+      setting = "file_source";
+      has_value = &out_config.has_file_source;
+      value = &out_config.file_source_raw;
+    }
+    if (setting == nullptr) {
       continue;
     }
 
     std::string parsed_value;
     if (!styio_parse_config_scalar_latest(raw_value, parsed_value, error_message)) {
       error_message =
-        "invalid dict_impl value in config file: " + config_path.string() + ":"
+        std::string("invalid ") + setting + " value in config file: " + config_path.string() + ":"
         + std::to_string(line_no) + " (" + error_message + ")";
       return false;
     }
-    out_config.has_dict_impl = true;
-    out_config.dict_impl_raw = parsed_value;
+    *has_value = true;
+    *value = parsed_value;
     out_config.loaded_from = config_path.string();
   }
   return true;
@@ -2777,34 +2819,38 @@ styio_publish_nano_package_latest(
   return ok;
 }
 
+/* --config wins; otherwise the nearest styio.toml / .styio.toml above the entry file. */
 static bool
-styio_resolve_dict_impl_selection_latest(
+styio_load_project_config_latest(
   const cxxopts::ParseResult& cmlopts,
   const std::string& file_path,
-  StyioDictImplSelectionLatest& out_selection,
+  StyioProjectConfigLatest& out_config,
   std::string& error_message
 ) {
-  if (const char* current_name = styio_dict_runtime_get_impl_name()) {
-    out_selection.impl_name = current_name;
-  }
-
-  StyioProjectConfigLatest project_config;
   std::filesystem::path project_config_path;
-
   if (cmlopts.count("config")) {
     project_config_path = cmlopts["config"].as<std::string>();
     if (project_config_path.empty()) {
       error_message = "--config requires a non-empty path";
       return false;
     }
-    if (!styio_parse_project_config_latest(project_config_path, project_config, error_message)) {
-      return false;
-    }
+    return styio_parse_project_config_latest(project_config_path, out_config, error_message);
   }
-  else if (styio_find_project_config_latest(file_path, project_config_path)) {
-    if (!styio_parse_project_config_latest(project_config_path, project_config, error_message)) {
-      return false;
-    }
+  if (styio_find_project_config_latest(file_path, project_config_path)) {
+    return styio_parse_project_config_latest(project_config_path, out_config, error_message);
+  }
+  return true;
+}
+
+static bool
+styio_resolve_dict_impl_selection_latest(
+  const cxxopts::ParseResult& cmlopts,
+  const StyioProjectConfigLatest& project_config,
+  StyioDictImplSelectionLatest& out_selection,
+  std::string& error_message
+) {
+  if (const char* current_name = styio_dict_runtime_get_impl_name()) {
+    out_selection.impl_name = current_name;
   }
 
   if (project_config.has_dict_impl) {
@@ -2838,8 +2884,67 @@ styio_resolve_dict_impl_selection_latest(
   return true;
 }
 
+/* Precedence: CLI > project config > "line". The runtime validates the policy text. */
+static bool
+styio_apply_output_flush_latest(
+  const cxxopts::ParseResult& cmlopts,
+  const StyioProjectConfigLatest& project_config,
+  std::string& error_message
+) {
+  if (cmlopts.count("output-flush")) {
+    const std::string cli_raw = cmlopts["output-flush"].as<std::string>();
+    if (styio_runtime_set_output_flush(cli_raw.c_str()) == 0) {
+      error_message = "unsupported --output-flush: " + cli_raw;
+      return false;
+    }
+    return true;
+  }
+  if (project_config.has_output_flush) {
+    if (styio_runtime_set_output_flush(project_config.output_flush_raw.c_str()) == 0) {
+      error_message =
+        "unsupported output_flush in config file " + project_config.loaded_from + ": "
+        + project_config.output_flush_raw;
+      return false;
+    }
+    return true;
+  }
+  styio_runtime_set_output_flush("line");
+  return true;
+}
+
+/* Precedence: CLI > project config > "auto". */
+static bool
+styio_apply_file_source_latest(
+  const cxxopts::ParseResult& cmlopts,
+  const StyioProjectConfigLatest& project_config,
+  std::string& error_message
+) {
+  if (cmlopts.count("file-source")) {
+    const std::string cli_raw = cmlopts["file-source"].as<std::string>();
+    if (styio_runtime_set_file_source(cli_raw.c_str()) == 0) {
+      error_message = "unsupported --file-source: " + cli_raw;
+      return false;
+    }
+    return true;
+  }
+  if (project_config.has_file_source) {
+    if (styio_runtime_set_file_source(project_config.file_source_raw.c_str()) == 0) {
+      error_message =
+        "unsupported file_source in config file " + project_config.loaded_from + ": "
+        + project_config.file_source_raw;
+      return false;
+    }
+    return true;
+  }
+  styio_runtime_set_file_source("auto");
+  return true;
+}
+
 static void
-styio_emit_machine_info_json(const StyioDictImplSelectionLatest& dict_impl_selection) {
+styio_emit_machine_info_json(
+  const StyioDictImplSelectionLatest& dict_impl_selection,
+  const StyioJITTargetSelectionLatest& jit_target_selection
+) {
   const char* active_integration_phase =
 #if STYIO_NANO_BUILD
     "bootstrap-single-file";
@@ -2930,6 +3035,24 @@ styio_emit_machine_info_json(const StyioDictImplSelectionLatest& dict_impl_selec
   }
   std::cout
     << "}";
+  {
+    std::string triple;
+    std::string cpu = jit_target_selection.options.cpu;
+    auto jtmb = StyioJIT_ORC::makeTargetMachineBuilder(jit_target_selection.options);
+    if (jtmb) {
+      triple = jtmb->getTargetTriple().str();
+      cpu = jtmb->getCPU();
+    }
+    else {
+      llvm::consumeError(jtmb.takeError());
+    }
+    std::cout
+      << ",\"jit_target\":{\"triple\":\"" << styio_json_escape(triple)
+      << "\",\"cpu\":\"" << styio_json_escape(cpu)
+      << "\",\"features\":\"" << styio_json_escape(jit_target_selection.options.features)
+      << "\",\"source\":\"" << styio_json_escape(jit_target_selection.source)
+      << "\"}";
+  }
 #if STYIO_NANO_BUILD
   std::cout
     << ",\"nano_profile\":{\"name\":\"" << styio_json_escape(STYIO_NANO_PROFILE_NAME)
@@ -3298,6 +3421,124 @@ styio_emit_diagnostic(
   std::cerr << "[" << styio_category_name(category) << "] " << message << std::endl;
 }
 
+/*
+  --time-report: one JSONL record per session phase transition, per LLVM pass and for JIT
+  materialization. Records share the diagnostic envelope ("severity":"info",
+  "category":"TimeReport") so they land in the same stderr stream and diagnostics.jsonl
+  sink; benchmark/perf-report.py picks them out of route logs by that category.
+*/
+static void
+styio_emit_time_report_record_latest(const std::string& jsonl_line) {
+  styio_append_diagnostic_to_sink_latest(jsonl_line);
+  std::cerr << jsonl_line << "\n";
+}
+
+static void
+styio_emit_time_report_latest(
+  const CompilationSession& session,
+  const std::vector<StyioPassTiming>& pass_timings,
+  const std::optional<std::uint64_t>& jit_materialize_us,
+  const std::string& file_path,
+  const std::string& jit_mode,
+  unsigned jit_threads,
+  unsigned opt_level
+) {
+  const std::string envelope =
+    "{\"severity\":\"info\",\"category\":\"TimeReport\",\"file\":\"" + styio_json_escape(file_path) + "\"";
+  for (const CompilationPhaseTiming& timing : session.phase_timings()) {
+    std::ostringstream out;
+    out << envelope
+        << ",\"kind\":\"phase\""
+        << ",\"operation\":\"" << styio_json_escape(timing.operation) << "\""
+        << ",\"from\":\"" << styio_runtime_phase_name_latest(timing.from) << "\""
+        << ",\"to\":\"" << styio_runtime_phase_name_latest(timing.to) << "\""
+        << ",\"wall_us\":" << timing.wall_us
+        << ",\"cpu_us\":" << timing.cpu_us
+        << ",\"token_arena_bytes\":" << timing.token_arena_bytes
+        << ",\"ast_arena_bytes\":" << timing.ast_arena_bytes
+        << "}";
+    styio_emit_time_report_record_latest(out.str());
+  }
+  for (const StyioPassTiming& timing : pass_timings) {
+    std::ostringstream out;
+    out << envelope
+        << ",\"kind\":\"" << (timing.analysis ? "llvm_analysis" : "llvm_pass") << "\""
+        << ",\"pass\":\"" << styio_json_escape(timing.name) << "\""
+        << ",\"opt_level\":" << opt_level
+        << ",\"runs\":" << timing.runs
+        << ",\"wall_us\":" << timing.wall_us
+        << "}";
+    styio_emit_time_report_record_latest(out.str());
+  }
+  if (jit_materialize_us.has_value()) {
+    std::ostringstream out;
+    out << envelope
+        << ",\"kind\":\"jit_materialize\""
+        << ",\"jit_mode\":\"" << styio_json_escape(jit_mode) << "\""
+        << ",\"jit_threads\":" << jit_threads
+        << ",\"opt_level\":" << opt_level
+        << ",\"wall_us\":" << *jit_materialize_us
+        << "}";
+    styio_emit_time_report_record_latest(out.str());
+  }
+}
+
+/* Accepts 0..3 and the O0..O3 spelling used by other compiler drivers. */
+static bool
+styio_parse_opt_level_latest(const std::string& raw, unsigned& out) {
+  std::string digits = raw;
+  if (digits.size() == 2 && (digits[0] == 'O' || digits[0] == 'o')) {
+    digits = digits.substr(1);
+  }
+  if (digits.size() != 1 || digits[0] < '0' || digits[0] > '3') {
+    return false;
+  }
+  out = static_cast<unsigned>(digits[0] - '0');
+  return true;
+}
+
+static bool
+styio_parse_jit_mode_latest(const std::string& raw, StyioJITCompileMode& out) {
+  if (raw == "eager") {
+    out = StyioJITCompileMode::Eager;
+    return true;
+  }
+  if (raw == "lazy") {
+    out = StyioJITCompileMode::Lazy;
+    return true;
+  }
+  return false;
+}
+
+static bool
+styio_parse_jit_profiler_latest(const std::string& raw, StyioJITProfiler& out) {
+  if (raw == "none") {
+    out = StyioJITProfiler::None;
+    return true;
+  }
+  if (raw == "perf-map") {
+    out = StyioJITProfiler::PerfMap;
+    return true;
+  }
+  if (raw == "jitdump") {
+    out = StyioJITProfiler::JITDump;
+    return true;
+  }
+  return false;
+}
+
+/* A positive thread count, or 0 for one thread per hardware thread. */
+static bool
+styio_parse_jit_threads_latest(const std::string& raw, unsigned& out) {
+  if (raw.empty() || raw.size() > 4
+      || !std::all_of(raw.begin(), raw.end(), [](unsigned char c) { return std::isdigit(c) != 0; })) {
+    return false;
+  }
+  const unsigned requested = static_cast<unsigned>(std::stoul(raw));
+  out = requested != 0 ? requested : std::max(1u, std::thread::hardware_concurrency());
+  return true;
+}
+
 struct StyioCompilePlanRequestLatest
 {
   std::filesystem::path plan_path;
@@ -3315,6 +3556,9 @@ struct StyioCompilePlanRequestLatest
   bool emit_ast = false;
   bool emit_styio_ir = false;
   bool emit_llvm_ir = false;
+  std::optional<unsigned> opt_level;
+  std::string target_cpu;
+  std::string target_features;
 };
 
 static std::string
@@ -3611,9 +3855,23 @@ styio_parse_compile_plan_latest(
   }
 
   (void)toolchain;
-  (void)profile;
   (void)resolution;
 
+  if (profile->get("opt_level") != nullptr) {
+    const auto raw_opt_level = profile->getInteger("opt_level");
+    if (!raw_opt_level.has_value() || *raw_opt_level < 0 || *raw_opt_level > 3) {
+      error_message = "unsupported compile-plan profile.opt_level (expected integer 0..3)";
+      return false;
+    }
+    out_request.opt_level = static_cast<unsigned>(*raw_opt_level);
+  }
+  if (const auto target_cpu = profile->getString("target_cpu")) {
+    out_request.target_cpu = std::string(*target_cpu);
+  }
+  if (const auto target_features = profile->getString("target_features")) {
+    out_request.target_features = std::string(*target_features);
+  }
+
   if (plan_version != 1) {
     error_message = "unsupported compile-plan version: " + std::to_string(plan_version);
     return false;
@@ -3822,6 +4080,195 @@ styio_write_shadow_artifact_latest(
   }
 }
 
+/* $XDG_CACHE_HOME/styio/jit, else ~/.cache/styio/jit; empty when neither is usable. */
+static std::filesystem::path
+styio_default_jit_cache_dir_latest() {
+  const char* xdg_cache_home = std::getenv("XDG_CACHE_HOME");
+  if (xdg_cache_home != nullptr && xdg_cache_home[0] != '\0'
+      && std::filesystem::path(xdg_cache_home).is_absolute()) {
+    return std::filesystem::path(xdg_cache_home) / "styio" / "jit";
+  }
+  const char* home = std::getenv("HOME");
+  if (home != nullptr && home[0] != '\0') {
+    return std::filesystem::path(home) / ".cache" / "styio" / "jit";
+  }
+  return {};
+}
+
+/* Version plus the size/mtime of the running executable, so a rebuilt compiler never reuses stale objects. */
+static std::string
+styio_compiler_build_fingerprint_latest(const char* argv0) {
+  std::string fingerprint = STYIO_PROJECT_VERSION;
+  const std::string exe_path = llvm::sys::fs::getMainExecutable(
+    argv0,
+    reinterpret_cast<void*>(&styio_compiler_build_fingerprint_latest));
+  std::error_code ec;
+  const auto exe_size = std::filesystem::file_size(exe_path, ec);
+  if (!ec) {
+    fingerprint += ":" + std::to_string(exe_size);
+  }
+  const auto exe_mtime = std::filesystem::last_write_time(exe_path, ec);
+  if (!ec) {
+    fingerprint += ":" + std::to_string(exe_mtime.time_since_epoch().count());
+  }
+  return fingerprint;
+}
+
+static std::string
+styio_jit_cache_key_latest(
+  const std::string& source_text,
+  const std::string& dict_impl,
+  StyioParserEngine parser_engine,
+  unsigned opt_level,
+  const StyioJITTargetOptions& target_options,
+  unsigned jit_threads,
+  const std::string& compiler_fingerprint
+) {
+  std::string target_desc = target_options.cpu + "|" + target_options.features;
+  auto jtmb = StyioJIT_ORC::makeTargetMachineBuilder(target_options);
+  if (jtmb) {
+    target_desc = jtmb->getTargetTriple().str() + "|" + jtmb->getCPU() + "|" + jtmb->getFeatures().getString();
+  }
+  else {
+    llvm::consumeError(jtmb.takeError());
+  }
+
+  const std::string fields[] = {
+    source_text,
+    dict_impl,
+    styio_parser_engine_name_latest(parser_engine),
+    std::to_string(opt_level),
+    target_desc,
+    /* The thread count decides how the program is split into cached part objects. */
+    std::to_string(jit_threads),
+    compiler_fingerprint,
+  };
+  llvm::SHA256 hasher;
+  for (const std::string& field : fields) {
+    hasher.update(field);
+    hasher.update(llvm::StringRef("\0", 1));
+  }
+  return llvm::toHex(hasher.final(), /*LowerCase*/ true);
+}
+
+#if !STYIO_NANO_BUILD
+/* --runtime-lib, then <exe dir>/../lib/libstyio_runtime.a (build and install layout), then the configured build path. */
+static std::filesystem::path
+styio_find_runtime_lib_latest(const std::string& override_path, const char* argv0) {
+  if (!override_path.empty()) {
+    return std::filesystem::path(override_path);
+  }
+
+  std::error_code ec;
+  const std::string exe_path = llvm::sys::fs::getMainExecutable(
+    argv0,
+    reinterpret_cast<void*>(&styio_find_runtime_lib_latest));
+  if (!exe_path.empty()) {
+    const std::filesystem::path sibling =
+      std::filesystem::path(exe_path).parent_path().parent_path() / "lib" / "libstyio_runtime.a";
+    if (std::filesystem::exists(sibling, ec)) {
+      return sibling;
+    }
+  }
+  return std::filesystem::path(STYIO_RUNTIME_LIB_PATH);
+}
+
+/* AOT: emit the module as an object file and, for --emit-exe, link it against the static runtime. */
+static bool
+styio_emit_native_latest(
+  StyioToLLVM& generator,
+  const std::string& obj_path,
+  const std::string& exe_path,
+  const std::filesystem::path& runtime_lib,
+  std::string& error_message
+) {
+  const std::string object_out = !obj_path.empty() ? obj_path : exe_path + ".o";
+  if (!generator.emit_object_file(object_out, error_message)) {
+    return false;
+  }
+  if (exe_path.empty()) {
+    return true;
+  }
+
+  std::error_code ec;
+  if (runtime_lib.empty() || !std::filesystem::exists(runtime_lib, ec)) {
+    error_message = "styio runtime library not found (use --runtime-lib): " + runtime_lib.string();
+    return false;
+  }
+
+  const char* cxx = std::getenv("CXX");
+  const std::string linker = (cxx != nullptr && cxx[0] != '\0') ? cxx : "c++";
+  const std::string command = linker + " " + styio_shell_quote_latest(object_out)
+                              + " " + styio_shell_quote_latest(runtime_lib.string())
+                              /* The runtime's file read-ahead uses std::thread; compressed inputs
+                                 use whichever codecs it was built with. */
+                              + " -pthread" STYIO_RUNTIME_EXTRA_LIBS " -o " + styio_shell_quote_latest(exe_path);
+  const bool linked = styio_run_shell_command_latest(command, "linking " + exe_path, error_message);
+  if (obj_path.empty()) {
+    std::filesystem::remove(object_out, ec);
+  }
+  return linked;
+}
+#endif
+
+/*
+  Warm start: link a cached object for an unchanged program and run it without
+  tokenizing, parsing or generating IR. std::nullopt means the object could not be
+  used and the caller should fall back to a full compile.
+*/
+static std::optional<int>
+styio_run_cached_object_latest(
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> objects,
+  const StyioJITTargetOptions& target_options,
+  StyioJITProfiler jit_profiler,
+  const std::string& error_format,
+  const std::string& fpath
+) {
+  llvm::InitializeNativeTarget();
+  llvm::InitializeNativeTargetAsmPrinter();
+  llvm::InitializeNativeTargetAsmParser();
+
+  auto jit_or_err = StyioJIT_ORC::Create(target_options);
+  if (!jit_or_err) {
+    llvm::consumeError(jit_or_err.takeError());
+    return std::nullopt;
+  }
+  std::unique_ptr<StyioJIT_ORC> jit = std::move(*jit_or_err);
+  if (llvm::Error err = jit->enableProfiler(jit_profiler)) {
+    styio_emit_diagnostic(error_format, StyioErrorCategory::RuntimeError, fpath, llvm::toString(std::move(err)));
+    return styio_exit_code(StyioErrorCategory::RuntimeError);
+  }
+  for (auto& object : objects) {
+    if (llvm::Error err = jit->addObjectFile(std::move(object))) {
+      llvm::consumeError(std::move(err));
+      return std::nullopt;
+    }
+  }
+  auto entry_symbol = jit->lookup("main");
+  if (!entry_symbol) {
+    llvm::consumeError(entry_symbol.takeError());
+    return std::nullopt;
+  }
+
+  styio_runtime_clear_error();
+  int (*entry)() = entry_symbol->getAddress().toPtr<int (*)()>();
+  entry();
+  styio_file_release_writes();
+  styio_runtime_flush_output();
+  if (styio_runtime_has_error()) {
+    const char* runtime_err = styio_runtime_last_error();
+    const char* runtime_subcode = styio_runtime_last_error_subcode();
+    styio_emit_diagnostic(
+      error_format,
+      StyioErrorCategory::RuntimeError,
+      fpath,
+      runtime_err ? runtime_err : "runtime helper reported error",
+      runtime_subcode ? runtime_subcode : "");
+    return styio_exit_code(StyioErrorCategory::RuntimeError);
+  }
+  return static_cast<int>(StyioExitCode::Success);
+}
+
 int
 main(
   int argc,
@@ -3865,11 +4312,44 @@ main(
     "config", "Read project configuration from the given file. When omitted, styio.toml or .styio.toml is auto-discovered upward from --file.",
     cxxopts::value<std::string>()
   )(
-    "dict-impl", "Dictionary backend selector (ordered-hash|linear). Accepts aliases v2 and v1.",
+    "dict-impl", "Dictionary backend selector (ordered-hash|linear|flat-hash). Accepts aliases v2, v1 and v3.",
     cxxopts::value<std::string>()
   )(
     "error-format", "Diagnostic output format: text|jsonl",
     cxxopts::value<std::string>()->default_value("text")
+  )(
+    "opt-level", "LLVM optimization level applied before JIT execution and --llvm-ir output: 0|1|2|3 (O0..O3 accepted).",
+    cxxopts::value<std::string>()->default_value("0")
+  )(
+    "target-cpu", "CPU the JIT generates code for (default: the host CPU; \"native\" is the same).",
+    cxxopts::value<std::string>()
+  )(
+    "target-features", "Comma separated LLVM target features added on top of the CPU defaults, e.g. +avx2,-avx512f.",
+    cxxopts::value<std::string>()
+  )(
+    "jit-mode", "JIT compilation strategy: eager (compile the whole program before running) | lazy (compile each function on its first call; disables the JIT object cache).",
+    cxxopts::value<std::string>()->default_value("eager")
+  )(
+    "jit-threads", "Threads compiling the program in eager JIT mode; the module is split into that many parts (0 = one per hardware thread).",
+    cxxopts::value<std::string>()->default_value("1")
+  )(
+    "jit-profile", "Expose JITted Styio functions to Linux profilers: none | perf-map (append to /tmp/perf-<pid>.map) | jitdump (LLVM perf listener, for perf inject --jit).",
+    cxxopts::value<std::string>()->default_value("none")
+  )(
+    "output-flush", "When program output written through >_ / @stderr is flushed: line (default) | block:<bytes> | interval:<ms> | exit. Overrides [runtime] output_flush in styio.toml; output is always flushed on runtime error and exit.",
+    cxxopts::value<std::string>()
+  )(
+    "file-source", "How @file{...} inputs are read: auto (default; memory-map regular files of 4 MiB or more) | stream (block reader) | mmap (map every regular file). Pipes and devices always stream. Overrides [runtime] file_source in styio.toml.",
+    cxxopts::value<std::string>()
+  )(
+    "jit-cache-dir", "Directory for cached JIT objects (default: $XDG_CACHE_HOME/styio/jit or ~/.cache/styio/jit).",
+    cxxopts::value<std::string>()
+  )(
+    "no-jit-cache", "Neither read nor write cached JIT objects.",
+    cxxopts::value<bool>()->default_value("false")
+  )(
+    "time-report", "Write JSONL timing records to stderr: wall/CPU time and arena bytes per compilation phase, LLVM pass times and JIT materialization time.",
+    cxxopts::value<bool>()->default_value("false")
   );
 
 #if !STYIO_NANO_BUILD
@@ -3877,6 +4357,18 @@ main(
     "compile-plan",
     "Read a versioned compile-plan JSON and treat it as the full compiler request envelope.",
     cxxopts::value<std::string>()
+  )(
+    "emit-obj",
+    "Compile ahead of time: write a native object file (links against libstyio_runtime.a) instead of running.",
+    cxxopts::value<std::string>()
+  )(
+    "emit-exe",
+    "Compile ahead of time: write a standalone executable linked with the static styio runtime instead of running.",
+    cxxopts::value<std::string>()
+  )(
+    "runtime-lib",
+    "Static styio runtime library used by --emit-exe (default: ../lib/libstyio_runtime.a next to the compiler).",
+    cxxopts::value<std::string>()
   )(
     "nano-create",
     "Materialize a styio-nano package using a local-subset profile or a cloud repository/package source.",
@@ -4098,9 +4590,16 @@ main(
     fpath = cmlopts["file"].as<std::string>();
   }
 
+  StyioProjectConfigLatest project_config;
+  std::string project_config_error;
+  if (!styio_load_project_config_latest(cmlopts, fpath, project_config, project_config_error)) {
+    std::cerr << "[CliError] " << project_config_error << std::endl;
+    return static_cast<int>(StyioExitCode::CliError);
+  }
+
   StyioDictImplSelectionLatest dict_impl_selection;
   std::string dict_impl_error;
-  if (!styio_resolve_dict_impl_selection_latest(cmlopts, fpath, dict_impl_selection, dict_impl_error)) {
+  if (!styio_resolve_dict_impl_selection_latest(cmlopts, project_config, dict_impl_selection, dict_impl_error)) {
     std::cerr << "[CliError] " << dict_impl_error << std::endl;
     return static_cast<int>(StyioExitCode::CliError);
   }
@@ -4108,6 +4607,33 @@ main(
     std::cerr << "[CliError] failed to apply dict implementation selector" << std::endl;
     return static_cast<int>(StyioExitCode::CliError);
   }
+  std::string output_flush_error;
+  if (!styio_apply_output_flush_latest(cmlopts, project_config, output_flush_error)) {
+    std::cerr << "[CliError] " << output_flush_error << std::endl;
+    return static_cast<int>(StyioExitCode::CliError);
+  }
+  std::string file_source_error;
+  if (!styio_apply_file_source_latest(cmlopts, project_config, file_source_error)) {
+    std::cerr << "[CliError] " << file_source_error << std::endl;
+    return static_cast<int>(StyioExitCode::CliError);
+  }
+
+  /* Precedence: CLI > compile-plan profile > detected host. */
+  StyioJITTargetSelectionLatest jit_target_selection;
+  if (compile_plan_request.has_value()
+      && (!compile_plan_request->target_cpu.empty() || !compile_plan_request->target_features.empty())) {
+    jit_target_selection.options.cpu = compile_plan_request->target_cpu;
+    jit_target_selection.options.features = compile_plan_request->target_features;
+    jit_target_selection.source = "compile-plan";
+  }
+  if (cmlopts.count("target-cpu")) {
+    jit_target_selection.options.cpu = cmlopts["target-cpu"].as<std::string>();
+    jit_target_selection.source = "cli";
+  }
+  if (cmlopts.count("target-features")) {
+    jit_target_selection.options.features = cmlopts["target-features"].as<std::string>();
+    jit_target_selection.source = "cli";
+  }
 
 #if STYIO_NANO_ENABLE_MACHINE_INFO
   if (cmlopts.count("machine-info")) {
@@ -4116,7 +4642,7 @@ main(
       std::cerr << "[CliError] unsupported --machine-info format: " << machine_info_format << std::endl;
       return static_cast<int>(StyioExitCode::CliError);
     }
-    styio_emit_machine_info_json(dict_impl_selection);
+    styio_emit_machine_info_json(dict_impl_selection, jit_target_selection);
     return static_cast<int>(StyioExitCode::Success);
   }
 #endif
@@ -4148,6 +4674,42 @@ main(
     std::cerr << "[CliError] unsupported --error-format: " << error_format << std::endl;
     return static_cast<int>(StyioExitCode::CliError);
   }
+  unsigned opt_level = 0;
+  const std::string opt_level_raw = cmlopts["opt-level"].as<std::string>();
+  if (!styio_parse_opt_level_latest(opt_level_raw, opt_level)) {
+    std::cerr << "[CliError] unsupported --opt-level: " << opt_level_raw << std::endl;
+    return static_cast<int>(StyioExitCode::CliError);
+  }
+  StyioJITCompileMode jit_mode = StyioJITCompileMode::Eager;
+  const std::string jit_mode_raw = cmlopts["jit-mode"].as<std::string>();
+  if (!styio_parse_jit_mode_latest(jit_mode_raw, jit_mode)) {
+    std::cerr << "[CliError] unsupported --jit-mode: " << jit_mode_raw << std::endl;
+    return static_cast<int>(StyioExitCode::CliError);
+  }
+  unsigned jit_threads = 1;
+  const std::string jit_threads_raw = cmlopts["jit-threads"].as<std::string>();
+  if (!styio_parse_jit_threads_latest(jit_threads_raw, jit_threads)) {
+    std::cerr << "[CliError] unsupported --jit-threads: " << jit_threads_raw << std::endl;
+    return static_cast<int>(StyioExitCode::CliError);
+  }
+  StyioJITProfiler jit_profiler = StyioJITProfiler::None;
+  const std::string jit_profile_raw = cmlopts["jit-profile"].as<std::string>();
+  if (!styio_parse_jit_profiler_latest(jit_profile_raw, jit_profiler)) {
+    std::cerr << "[CliError] unsupported --jit-profile: " << jit_profile_raw << std::endl;
+    return static_cast<int>(StyioExitCode::CliError);
+  }
+  const bool time_report = cmlopts["time-report"].as<bool>();
+
+#if !STYIO_NANO_BUILD
+  const std::string emit_obj_path = cmlopts.count("emit-obj") ? cmlopts["emit-obj"].as<std::string>() : "";
+  const std::string emit_exe_path = cmlopts.count("emit-exe") ? cmlopts["emit-exe"].as<std::string>() : "";
+  const std::string runtime_lib_override =
+    cmlopts.count("runtime-lib") ? cmlopts["runtime-lib"].as<std::string>() : "";
+#else
+  const std::string emit_obj_path;
+  const std::string emit_exe_path;
+#endif
+  const bool emit_native = !emit_obj_path.empty() || !emit_exe_path.empty();
 
 #if STYIO_NANO_ENABLE_LEGACY_PARSER
   std::string parser_engine_raw = cmlopts["parser-engine"].as<std::string>();
@@ -4174,6 +4736,10 @@ main(
     show_styio_ir = show_styio_ir || compile_plan_request->emit_styio_ir;
     show_llvm_ir = show_llvm_ir || compile_plan_request->emit_llvm_ir;
     error_format = compile_plan_request->error_format;
+    /* An explicit --opt-level still wins over the plan's profile. */
+    if (compile_plan_request->opt_level.has_value() && cmlopts.count("opt-level") == 0) {
+      opt_level = *compile_plan_request->opt_level;
+    }
   }
 
   if (fpath.empty()) {
@@ -4334,11 +4900,90 @@ main(
     show_code_with_linenum(styio_code);
   }
 
+  /* Lazy mode compiles per-function partitions on demand, so there is no whole-program object to cache. */
+  std::unique_ptr<StyioObjectCache> jit_object_cache;
+  if (!cmlopts["no-jit-cache"].as<bool>() && jit_mode == StyioJITCompileMode::Eager) {
+    const std::filesystem::path jit_cache_dir =
+      cmlopts.count("jit-cache-dir")
+        ? std::filesystem::path(cmlopts["jit-cache-dir"].as<std::string>())
+        : styio_default_jit_cache_dir_latest();
+    if (!jit_cache_dir.empty()) {
+      jit_object_cache = std::make_unique<StyioObjectCache>(
+        jit_cache_dir,
+        styio_jit_cache_key_latest(
+          styio_code.code_text,
+          dict_impl_selection.impl_name,
+          parser_engine,
+          opt_level,
+          jit_target_selection.options,
+          jit_threads,
+          styio_compiler_build_fingerprint_latest(argc > 0 ? argv[0] : "styio")));
+    }
+  }
+  /* Anything that must observe the front end (dumps, artifacts, shadow compare) takes the full path. */
+  const bool jit_cache_fast_path =
+    jit_object_cache != nullptr
+    && !compile_plan_request.has_value()
+    && !show_styio_ast
+    && !show_styio_ir
+    && !show_llvm_ir
+    && !is_debug_mode
+    && !parser_shadow_compare
+    && !time_report
+    && !emit_native;
+  if (jit_cache_fast_path) {
+    /* A split program is cached as styio.part0..N without gaps (see StyioToLLVM::execute). */
+    std::vector<std::unique_ptr<llvm::MemoryBuffer>> cached_objects;
+    if (jit_threads <= 1) {
+      if (auto cached_object = jit_object_cache->load("styio")) {
+        cached_objects.push_back(std::move(cached_object));
+      }
+    }
+    else {
+      while (auto cached_part = jit_object_cache->load("styio.part" + std::to_string(cached_objects.size()))) {
+        cached_objects.push_back(std::move(cached_part));
+      }
+    }
+    if (!cached_objects.empty()) {
+      if (const auto exit_code = styio_run_cached_object_latest(
+            std::move(cached_objects),
+            jit_target_selection.options,
+            jit_profiler,
+            error_format,
+            fpath)) {
+        return *exit_code;
+      }
+    }
+  }
+  if (jit_object_cache != nullptr) {
+    jit_object_cache->setLookupCallback([&](bool hit, const std::string& object_path) {
+      std::ostringstream payload;
+      payload << "{\"key\":\"" << styio_json_escape(jit_object_cache->getKey())
+              << "\",\"path\":\"" << styio_json_escape(object_path)
+              << "\"}";
+      styio_emit_runtime_event_latest(
+        hit ? "jit.cache.hit" : "jit.cache.miss",
+        "styio.jit",
+        payload.str());
+    });
+  }
+
   // C.1 shell: handle table exists before runtime migration.
   StyioHandleTable handle_table;
   (void)handle_table;
 
   CompilationSession session;
+  if (time_report) {
+    session.enable_phase_timing();
+  }
+  std::vector<StyioPassTiming> time_report_passes;
+  std::optional<std::uint64_t> time_report_jit_us;
+  const auto emit_time_report = [&]() {
+    if (time_report) {
+      styio_emit_time_report_latest(
+        session, time_report_passes, time_report_jit_us, fpath, jit_mode_raw, jit_threads, opt_level);
+    }
+  };
   compile_plan_final_phase = session.phase();
   const auto compile_started_at = std::chrono::steady_clock::now();
   std::vector<std::filesystem::path> compile_plan_artifacts;
@@ -4606,7 +5251,11 @@ main(
     llvm::InitializeNativeTargetAsmPrinter();
     llvm::InitializeNativeTargetAsmParser();
 
-    auto jit_or_err = StyioJIT_ORC::Create();
+    auto jit_or_err = StyioJIT_ORC::Create(
+      jit_target_selection.options,
+      jit_object_cache.get(),
+      jit_mode,
+      jit_threads);
     if (!jit_or_err) {
       std::string emsg;
       llvm::handleAllErrors(
@@ -4615,9 +5264,18 @@ main(
       styio_emit_diagnostic(error_format, StyioErrorCategory::RuntimeError, fpath, emsg);
       return styio_exit_code(StyioErrorCategory::RuntimeError);
     }
+    if (llvm::Error err = (*jit_or_err)->enableProfiler(jit_profiler)) {
+      styio_emit_diagnostic(error_format, StyioErrorCategory::RuntimeError, fpath, llvm::toString(std::move(err)));
+      return styio_exit_code(StyioErrorCategory::RuntimeError);
+    }
 
     StyioToLLVM generator = StyioToLLVM(std::move(*jit_or_err));
+    if (time_report) {
+      generator.enable_pass_timing();
+    }
     session.ir()->toLLVMIR(&generator);
+    generator.optimize_module(opt_level);
+    time_report_passes = generator.pass_timings();
     const CompilationPhase previous_phase = session.phase();
     session.mark_codegen_ready();
     emit_compile_plan_session_transition(previous_phase, "mark_codegen_ready");
@@ -4637,9 +5295,25 @@ main(
     if (show_llvm_ir) {
       generator.print_llvm_ir();
     }
+#if !STYIO_NANO_BUILD
+    if (emit_native) {
+      std::string native_error;
+      if (!styio_emit_native_latest(
+            generator,
+            emit_obj_path,
+            emit_exe_path,
+            styio_find_runtime_lib_latest(runtime_lib_override, argc > 0 ? argv[0] : "styio"),
+            native_error)) {
+        mark_failed_with_runtime_transition("mark_failed");
+        styio_emit_diagnostic(error_format, StyioErrorCategory::RuntimeError, fpath, native_error);
+        return styio_exit_code(StyioErrorCategory::RuntimeError);
+      }
+    }
+#endif
     const bool should_execute =
-      !compile_plan_request.has_value()
-      || (compile_plan_request->intent != "build" && compile_plan_request->intent != "check");
+      !emit_native
+      && (!compile_plan_request.has_value()
+          || (compile_plan_request->intent != "build" && compile_plan_request->intent != "check"));
     if (should_execute) {
       if (compile_plan_request.has_value()) {
         if (compile_plan_request->intent == "test") {
@@ -4672,7 +5346,10 @@ main(
       styio_runtime_clear_error();
       styio_runtime_set_log_sink(styio_runtime_log_sink_latest);
       generator.execute();
+      styio_file_release_writes();
+      styio_runtime_flush_output();
       styio_runtime_set_log_sink(nullptr);
+      time_report_jit_us = generator.jit_materialize_us();
       compile_plan_runtime_executed = true;
       if (compile_plan_request.has_value()) {
         const bool execution_success = !styio_runtime_has_error();
@@ -4718,6 +5395,7 @@ main(
           runtime_err ? runtime_err : "runtime helper reported error",
           runtime_subcode ? runtime_subcode : "");
         mark_failed_with_runtime_transition("mark_failed");
+        emit_time_report();
         return styio_exit_code(StyioErrorCategory::RuntimeError);
       }
       const CompilationPhase previous_phase = session.phase();
@@ -4797,5 +5475,6 @@ main(
     compile_plan_runtime_success = true;
   }
 
+  emit_time_report();
   return static_cast<int>(StyioExitCode::Success);
 }
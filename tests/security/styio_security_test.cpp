@@ -11,7 +11,9 @@
 #include <chrono>
 #include <cstring>
 #include <cstdlib>
+#include <fstream>
 #include <future>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <utility>
@@ -33,8 +35,13 @@
 #include "StyioIR/StyioIR.hpp"
 #include "StyioRuntime/HandleTable.hpp"
 #include "StyioSession/CompilationSession.hpp"
+#include "StyioSession/PreparedProgram.hpp"
 #include "StyioUnicode/Unicode.hpp"
 
+#if defined(STYIO_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
 namespace {
 
 class CountingExprAST : public StyioAST
@@ -985,6 +992,17 @@ TEST(StyioSecurityNightlySemantics, RejectsNonStringDictIndex) {
     StyioTypeError);
 }
 
+TEST(StyioSecurityNightlySemantics, RejectsMixedDictKeyTypes) {
+  EXPECT_THROW(
+    parse_typecheck_and_lower_program_engine_latest(
+      "d = dict{1: 1, \"b\": 2}\n", StyioParserEngine::Nightly),
+    StyioTypeError);
+  EXPECT_THROW(
+    parse_typecheck_and_lower_program_engine_latest(
+      "d = dict{1: 1}\nx = d[\"1\"]\n", StyioParserEngine::Nightly),
+    StyioTypeError);
+}
+
 TEST(StyioSecurityNightlySemantics, AllowsBoundStdinAliasIteration) {
   const std::string src =
     "s <- @stdin\n"
@@ -1066,6 +1084,21 @@ TEST(StyioSecurityNightlyCodegen, EmitsTypedListHelpersForMutationAndOperations)
   EXPECT_NE(llvm_ir.find("styio_list_set_dict"), std::string::npos);
 }
 
+TEST(StyioSecurityNightlyCodegen, IteratesScalarListsOverBorrowedSpans) {
+  const std::string src =
+    "nums = [1,2,3]\n"
+    "nums >> #(x) => { >_(x) }\n"
+    "names = [\"a\",\"b\"]\n"
+    "names >> #(n) => { >_(n) }\n";
+  const std::string llvm_ir =
+    compile_program_to_llvm_ir_engine_latest(src, StyioParserEngine::Nightly);
+  EXPECT_NE(llvm_ir.find("call ptr @styio_list_span_i64"), std::string::npos);
+  EXPECT_NE(llvm_ir.find("call ptr @styio_list_epoch_word()"), std::string::npos);
+  EXPECT_NE(llvm_ir.find("foreach_span_refresh"), std::string::npos);
+  /* String lists keep the per-element getter. */
+  EXPECT_NE(llvm_ir.find("call ptr @styio_list_get_cstr"), std::string::npos);
+}
+
 TEST(StyioSecurityNightlyCodegen, EmitsStringListCollectHelperForStdinCollectBind) {
   const std::string src =
     "lines << @stdin\n"
@@ -1097,6 +1130,62 @@ TEST(StyioSecurityNightlyCodegen, EmitsTypedDictHelpersForStringAndFloatValues)
   EXPECT_NE(llvm_ir.find("styio_dict_values_f64"), std::string::npos);
 }
 
+TEST(StyioSecurityNightlyCodegen, InternsLiteralDictKeysOnceAtEntry) {
+  const std::string src =
+    "prices = dict{\"apple\": 3}\n"
+    "prices[\"apple\"] = 4\n"
+    ">_(prices[\"apple\"])\n";
+  const std::string llvm_ir =
+    compile_program_to_llvm_ir_engine_latest(src, StyioParserEngine::Nightly);
+  EXPECT_NE(llvm_ir.find("define internal void @styio_intern_keys()"), std::string::npos);
+  EXPECT_NE(llvm_ir.find("call void @styio_intern_keys()"), std::string::npos);
+  EXPECT_NE(llvm_ir.find("call void @styio_dict_set_i64_keyid"), std::string::npos);
+  EXPECT_NE(llvm_ir.find("call i64 @styio_dict_get_i64_keyid"), std::string::npos);
+  /* Both accesses share one interned id. */
+  EXPECT_EQ(llvm_ir.find("@styio_key_id.1"), std::string::npos);
+}
+
+TEST(StyioSecurityNightlyCodegen, InfersCsvColumnTypesFromTheirOperands) {
+  /* Column against column stays text on both sides. */
+  const std::string text_src =
+    "@file{\"t.csv\"} >> #(row: csv) => {\n"
+    "    >_(row[\"a\"] == row[\"b\"])\n"
+    "}\n";
+  const std::string text_ir =
+    compile_program_to_llvm_ir_engine_latest(text_src, StyioParserEngine::Nightly);
+  EXPECT_NE(text_ir.find("c\"str:a\\0Astr:b\\00\""), std::string::npos);
+  EXPECT_EQ(text_ir.find("call ptr @styio_csv_column_f64("), std::string::npos);
+
+  /* An integer operand makes the column i64; a float elsewhere widens the compared pair to f64. */
+  const std::string num_src =
+    "@file{\"t.csv\"} >> #(row: csv) => {\n"
+    "    >_(row[\"a\"] > row[\"b\"])\n"
+    "    >_(row[\"b\"] > 1.5)\n"
+    "    >_(row[\"id\"] + 1)\n"
+    "}\n";
+  const std::string num_ir =
+    compile_program_to_llvm_ir_engine_latest(num_src, StyioParserEngine::Nightly);
+  EXPECT_NE(num_ir.find("c\"f64:a\\0Af64:b\\0Ai64:id\\00\""), std::string::npos);
+  EXPECT_NE(num_ir.find("call ptr @styio_csv_column_i64("), std::string::npos);
+}
+
+TEST(StyioSecurityNightlyCodegen, LowersIntegerKeyedDictsToIdictHelpers) {
+  const std::string src =
+    "ids = dict{7: 1.5, 9: 2.5}\n"
+    "ids[7] = 3.0\n"
+    ">_(ids[9])\n"
+    ">_(ids.keys)\n";
+  const std::string llvm_ir =
+    compile_program_to_llvm_ir_engine_latest(src, StyioParserEngine::Nightly);
+  EXPECT_NE(llvm_ir.find("call i64 @styio_idict_new_f64()"), std::string::npos);
+  EXPECT_NE(llvm_ir.find("call void @styio_idict_set_f64(i64"), std::string::npos);
+  EXPECT_NE(llvm_ir.find("call double @styio_idict_get_f64(i64"), std::string::npos);
+  EXPECT_NE(llvm_ir.find("styio_dict_keys"), std::string::npos);
+  /* Integer keys are passed as is: nothing to intern, no string-keyed helpers. */
+  EXPECT_EQ(llvm_ir.find("styio_key_id"), std::string::npos);
+  EXPECT_EQ(llvm_ir.find("@styio_dict_set_f64"), std::string::npos);
+}
+
 TEST(StyioSecurityNightlyCodegen, EmitsHandleDictHelpersForNestedCollections) {
   const std::string src =
     "d = dict{\"nums\": [1,2,3], \"more\": [4,5]}\n"
@@ -1191,6 +1280,89 @@ TEST(StyioSecurityNightlyRuntime, NestedHandleDictsReleaseOwnedChildrenOnOverwri
   EXPECT_EQ(styio_runtime_has_error(), 0);
 }
 
+TEST(StyioSecurityNightlyRuntime, PerfMapProfilerListsJittedFunctions) {
+#ifdef _WIN32
+  GTEST_SKIP() << "perf maps are a Linux profiler convention";
+#else
+  llvm::InitializeNativeTarget();
+  llvm::InitializeNativeTargetAsmPrinter();
+  llvm::InitializeNativeTargetAsmParser();
+  llvm::ExitOnError exit_on_error;
+  std::unique_ptr<StyioJIT_ORC> jit = exit_on_error(StyioJIT_ORC::Create());
+  exit_on_error(jit->enableProfiler(StyioJITProfiler::PerfMap));
+
+  auto context = std::make_unique<llvm::LLVMContext>();
+  auto module = std::make_unique<llvm::Module>("perf-map-probe", *context);
+  module->setDataLayout(jit->getDataLayout());
+  llvm::Function* fn = llvm::Function::Create(
+    llvm::FunctionType::get(llvm::Type::getInt32Ty(*context), false),
+    llvm::GlobalValue::ExternalLinkage,
+    "styio_perf_map_probe",
+    *module);
+  llvm::IRBuilder<> builder(llvm::BasicBlock::Create(*context, "entry", fn));
+  builder.CreateRet(builder.getInt32(42));
+  exit_on_error(jit->addModule(llvm::orc::ThreadSafeModule(std::move(module), std::move(context))));
+  auto symbol = exit_on_error(jit->lookup("styio_perf_map_probe"));
+  EXPECT_EQ(symbol.getAddress().toPtr<int (*)()>()(), 42);
+
+  std::ifstream map("/tmp/perf-" + std::to_string(getpid()) + ".map");
+  ASSERT_TRUE(map.is_open());
+  bool listed = false;
+  std::string line;
+  while (std::getline(map, line)) {
+    std::istringstream fields(line);
+    std::string start;
+    std::string size;
+    std::string name;
+    fields >> start >> size >> name;
+    if (name == "styio:styio_perf_map_probe") {
+      EXPECT_EQ(std::stoull(start, nullptr, 16), symbol.getAddress().getValue());
+      EXPECT_GT(std::stoull(size, nullptr, 16), 0u);
+      listed = true;
+    }
+  }
+  EXPECT_TRUE(listed);
+
+  EXPECT_FALSE(llvm::errorToBool(jit->enableProfiler(StyioJITProfiler::None)));
+#endif
+}
+
+TEST(StyioSecurityNightlyRuntime, PreparedProgramRunsRepeatedlyWithFreshRuntimeState) {
+  std::string error_message;
+  std::unique_ptr<styio::PreparedProgram> program = styio::PreparedProgram::compile(
+    "l = [1,2,3]\n"
+    "d = dict{\"a\": 1}\n",
+    "prepared.styio",
+    styio::PreparedProgramOptions{},
+    error_message);
+  ASSERT_NE(program, nullptr) << error_message;
+
+  /* State left behind by the embedder must not leak into the first run. */
+  (void)styio_list_new_i64();
+  (void)styio_cstr_to_i64("not-a-number");
+  ASSERT_EQ(styio_runtime_has_error(), 1);
+
+  for (int round = 0; round < 3; ++round) {
+    const styio::PreparedRunResult result = program->run();
+    EXPECT_EQ(result.exit_code, 0) << result.error_message;
+    EXPECT_TRUE(result.error_subcode.empty());
+    EXPECT_EQ(styio_runtime_has_error(), 0);
+    EXPECT_LE(styio_list_active_count(), 1);
+    EXPECT_LE(styio_dict_active_count(), 1);
+  }
+
+  program.reset();
+  styio_runtime_reset();
+  EXPECT_EQ(styio_list_active_count(), 0);
+  EXPECT_EQ(styio_dict_active_count(), 0);
+
+  error_message.clear();
+  EXPECT_EQ(
+    styio::PreparedProgram::compile(">_(\"unterminated)\n", "broken.styio", {}, error_message),
+    nullptr);
+  EXPECT_FALSE(error_message.empty());
+}
+
 TEST(StyioSecurityNightlyRuntime, InvalidNumericStringArgumentSetsRuntimeError) {
   const std::string src =
     "# add1 := (x: i64) => x + 1\n"
@@ -1550,6 +1722,42 @@ TEST(StyioSecuritySession, ResetClearsSessionState) {
   EXPECT_EQ(session.ast_arena_bytes(), 0u);
 }
 
+TEST(StyioSecuritySession, PhaseTimingRecordsEachTransitionWithArenaBytes) {
+  CompilationSession session;
+  const std::string src = "x = 1\n";
+  session.adopt_tokens(StyioTokenizer::tokenize(src));
+  EXPECT_TRUE(session.phase_timings().empty());
+
+  session.reset();
+  session.enable_phase_timing();
+  session.adopt_tokens(StyioTokenizer::tokenize(src));
+  session.attach_context(StyioContext::Create(
+    "<security>",
+    src,
+    {{0, src.size() - 1}},
+    session.tokens(),
+    false));
+  session.attach_ast(MainBlockAST::Create({}));
+  session.mark_type_checked();
+
+  const std::vector<CompilationPhaseTiming>& timings = session.phase_timings();
+  ASSERT_EQ(timings.size(), 3u);
+  EXPECT_EQ(timings[0].from, CompilationPhase::Empty);
+  EXPECT_EQ(timings[0].to, CompilationPhase::Tokenized);
+  EXPECT_STREQ(timings[0].operation, "adopt_tokens");
+  EXPECT_GT(timings[0].token_arena_bytes, 0u);
+  EXPECT_EQ(timings[0].ast_arena_bytes, 0u);
+  EXPECT_EQ(timings[1].to, CompilationPhase::Parsed);
+  EXPECT_GT(timings[1].ast_arena_bytes, 0u);
+  EXPECT_STREQ(timings[2].operation, "mark_type_checked");
+
+  /* reset() drops recorded timings but keeps timing enabled for the next compile. */
+  session.reset();
+  EXPECT_TRUE(session.phase_timings().empty());
+  session.adopt_tokens(StyioTokenizer::tokenize(src));
+  EXPECT_EQ(session.phase_timings().size(), 1u);
+}
+
 TEST(StyioSecuritySession, InvalidPhaseTransitionsAreRejected) {
   CompilationSession session;
   EXPECT_THROW(session.mark_type_checked(), std::logic_error);
@@ -2365,6 +2573,686 @@ TEST(StyioSafetyRuntime, MissingFileOpenReturnsZeroHandle) {
   styio_runtime_clear_error();
 }
 
+TEST(StyioSafetyRuntime, ErrorWordTracksRuntimeErrorFlagPerThread) {
+  styio_runtime_clear_error();
+  int32_t* word = styio_runtime_error_word();
+  ASSERT_NE(word, nullptr);
+  EXPECT_EQ(word, styio_runtime_error_word());
+  EXPECT_EQ(*word, 0);
+
+  EXPECT_EQ(styio_file_open(nullptr), 0);
+  EXPECT_NE(*word, 0);
+  EXPECT_EQ(styio_runtime_has_error(), 1);
+
+  /* Generated code caches the address per function, so it must stay per thread. */
+  std::async(std::launch::async, [word]() {
+    EXPECT_NE(styio_runtime_error_word(), word);
+    EXPECT_EQ(*styio_runtime_error_word(), 0);
+  }).get();
+
+  styio_runtime_clear_error();
+  EXPECT_EQ(*word, 0);
+}
+
+TEST(StyioSafetyRuntime, CachedWriteHandleIsSharedPerPathUntilReleased) {
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  const long long uniq = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+  const std::string path = "/tmp/styio_cached_write_" + std::to_string(uniq) + ".txt";
+  const std::string other = "/tmp/styio_cached_write_other_" + std::to_string(uniq) + ".txt";
+
+  styio_runtime_clear_error();
+  const int64_t h = styio_file_acquire_write(path.c_str());
+  ASSERT_NE(h, 0);
+  const int64_t h_other = styio_file_acquire_write(other.c_str());
+  ASSERT_NE(h_other, 0);
+  EXPECT_NE(h_other, h);
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(styio_file_acquire_write(path.c_str()), h);
+    styio_file_write_cstr(h, "row\n");
+  }
+  styio_file_write_cstr(h_other, "other\n");
+
+  /* Reading a path back in the same program sees every buffered write. */
+  const int64_t rh = styio_file_open(path.c_str());
+  ASSERT_NE(rh, 0);
+  int rows = 0;
+  while (const char* line = styio_file_read_line(rh)) {
+    EXPECT_STREQ(line, "row");
+    ++rows;
+  }
+  EXPECT_EQ(rows, 1000);
+  styio_file_close(rh);
+
+  styio_file_release_writes();
+  styio_file_write_cstr(h, "after release\n");
+  EXPECT_EQ(styio_runtime_has_error(), 1);
+  EXPECT_STREQ(styio_runtime_last_error_subcode(), "STYIO_RUNTIME_INVALID_FILE_HANDLE");
+  styio_runtime_clear_error();
+
+  /* Append mode: a reacquired handle continues the file. */
+  const int64_t again = styio_file_acquire_write(path.c_str());
+  ASSERT_NE(again, 0);
+  styio_file_write_cstr(again, "row\n");
+  styio_runtime_reset();
+  std::ifstream in(path);
+  std::stringstream text;
+  text << in.rdbuf();
+  EXPECT_EQ(text.str().size(), 1001u * 4u);
+  std::ifstream other_in(other);
+  std::string other_line;
+  EXPECT_TRUE(static_cast<bool>(std::getline(other_in, other_line)));
+  EXPECT_EQ(other_line, "other");
+
+  EXPECT_EQ(styio_file_acquire_write(nullptr), 0);
+  EXPECT_STREQ(styio_runtime_last_error_subcode(), "STYIO_RUNTIME_FILE_PATH_NULL");
+  styio_runtime_clear_error();
+  std::remove(path.c_str());
+  std::remove(other.c_str());
+}
+
+TEST(StyioSafetyRuntime, FileReadLineHandlesLongLinesAndKeepsPerHandleLines) {
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  const long long uniq = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+  const std::string path = "/tmp/styio_long_lines_" + std::to_string(uniq) + ".txt";
+  /* Longer than the former 64 KiB fgets buffer, and than one reader block. */
+  const std::string long_line(3u << 20, 'x');
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << "first\r\n" << long_line << "\n\nlast";
+  }
+
+  styio_runtime_clear_error();
+  const int64_t a = styio_file_open(path.c_str());
+  const int64_t b = styio_file_open(path.c_str());
+  ASSERT_NE(a, 0);
+  ASSERT_NE(b, 0);
+  const char* a_first = styio_file_read_line(a);
+  const char* b_first = styio_file_read_line(b);
+  ASSERT_NE(a_first, nullptr);
+  ASSERT_NE(b_first, nullptr);
+  /* A zip reads both handles before using either line. */
+  EXPECT_STREQ(a_first, "first");
+  EXPECT_STREQ(b_first, "first");
+
+  const char* big = styio_file_read_line(a);
+  ASSERT_NE(big, nullptr);
+  EXPECT_EQ(std::strlen(big), long_line.size());
+  EXPECT_STREQ(styio_file_read_line(a), "");
+  EXPECT_STREQ(styio_file_read_line(a), "last");
+  EXPECT_EQ(styio_file_read_line(a), nullptr);
+
+  styio_file_rewind(a);
+  EXPECT_STREQ(styio_file_read_line(a), "first");
+  EXPECT_EQ(styio_runtime_has_error(), 0);
+  styio_file_close(a);
+  styio_file_close(b);
+  std::remove(path.c_str());
+}
+
+TEST(StyioSafetyRuntime, MappedFileSourceReadsRewindsAndClosesLikeStream) {
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  const long long uniq = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+  const std::string path = "/tmp/styio_mapped_source_" + std::to_string(uniq) + ".txt";
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << "10\r\n20\n\n30";
+  }
+
+  const std::vector<std::string> expected = {"10", "20", "", "30"};
+  for (const char* mode : {"mmap", "stream"}) {
+    ASSERT_EQ(styio_runtime_set_file_source(mode), 1) << mode;
+    styio_runtime_clear_error();
+    const int64_t h = styio_file_open(path.c_str());
+    ASSERT_NE(h, 0) << mode;
+    for (int pass = 0; pass < 2; ++pass) {
+      std::vector<std::string> lines;
+      while (const char* line = styio_file_read_line(h)) {
+        lines.emplace_back(line);
+      }
+      EXPECT_EQ(lines, expected) << mode;
+      styio_file_rewind(h);
+    }
+    styio_file_close(h);
+    EXPECT_EQ(styio_file_read_line(h), nullptr) << mode;
+    EXPECT_STREQ(styio_runtime_last_error_subcode(), "STYIO_RUNTIME_INVALID_FILE_HANDLE") << mode;
+    styio_runtime_clear_error();
+  }
+
+  EXPECT_EQ(styio_runtime_set_file_source("sometimes"), 0);
+  EXPECT_EQ(styio_runtime_set_file_source("auto"), 1);
+  std::remove(path.c_str());
+}
+
+TEST(StyioSafetyRuntime, ReadAheadZipOfLargeFilesMatchesAcrossRewindAndEarlyClose) {
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  const long long uniq = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+  const std::string path = "/tmp/styio_read_ahead_" + std::to_string(uniq) + ".txt";
+  constexpr int kRows = 400000; /* ~2.6 MiB: streamed with a read-ahead worker */
+  {
+    std::ofstream out(path, std::ios::binary);
+    for (int i = 0; i < kRows; ++i) {
+      out << i << '\n';
+    }
+  }
+
+  ASSERT_EQ(styio_runtime_set_file_source("stream"), 1);
+  styio_runtime_clear_error();
+  const int64_t a = styio_file_open(path.c_str());
+  const int64_t b = styio_file_open(path.c_str());
+  ASSERT_NE(a, 0);
+  ASSERT_NE(b, 0);
+  int rows = 0;
+  bool rewound = false;
+  while (true) {
+    const char* x = styio_file_read_line(a);
+    const char* y = styio_file_read_line(b);
+    if (x == nullptr || y == nullptr) {
+      EXPECT_EQ(x, y);
+      break;
+    }
+    ASSERT_STREQ(x, y);
+    ASSERT_EQ(std::atoi(x), rewound ? rows - 1000 : rows);
+    ++rows;
+    if (rows == 1000 && !rewound) {
+      styio_file_rewind(a);
+      styio_file_rewind(b);
+      rewound = true;
+    }
+  }
+  EXPECT_EQ(rows, kRows + 1000);
+
+  /* Closing with a block in flight joins the worker. */
+  const int64_t c = styio_file_open(path.c_str());
+  ASSERT_NE(c, 0);
+  EXPECT_STREQ(styio_file_read_line(c), "0");
+  styio_file_close(c);
+  styio_file_close(a);
+  styio_file_close(b);
+  EXPECT_EQ(styio_runtime_has_error(), 0);
+  EXPECT_EQ(styio_runtime_set_file_source("auto"), 1);
+  std::remove(path.c_str());
+}
+
+TEST(StyioSafetyRuntime, FusedNumericLineReadMatchesReadLinePlusConversion) {
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  const long long uniq = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+  const std::string path = "/tmp/styio_fused_numeric_" + std::to_string(uniq) + ".txt";
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << "12\r\n-7\n +3\nabc\n2.5\n9223372036854775808\n1e-310";
+  }
+
+  for (const char* mode : {"mmap", "stream"}) {
+    ASSERT_EQ(styio_runtime_set_file_source(mode), 1) << mode;
+    styio_runtime_clear_error();
+    const int64_t h = styio_file_open(path.c_str());
+    ASSERT_NE(h, 0) << mode;
+
+    /* Plain decimals parse in place; everything else is left to the caller's fallback. */
+    const std::vector<std::pair<std::string, int64_t>> expected = {
+      {"12", 1}, {"-7", 1}, {" +3", 0}, {"abc", 0}, {"2.5", 0}, {"9223372036854775808", 0},
+      {"1e-310", 0}};
+    for (const auto& [text, parsed] : expected) {
+      int64_t value = -1;
+      int64_t ok = -1;
+      const char* line = styio_file_read_i64(h, &value, &ok);
+      ASSERT_NE(line, nullptr) << mode;
+      EXPECT_EQ(std::string(line), text) << mode;
+      EXPECT_EQ(ok, parsed) << mode << " " << text;
+      if (parsed == 1) {
+        EXPECT_EQ(value, styio_cstr_to_i64(line)) << mode;
+      }
+    }
+    int64_t value = 0;
+    int64_t ok = 0;
+    EXPECT_EQ(styio_file_read_i64(h, &value, &ok), nullptr) << mode;
+    EXPECT_EQ(styio_runtime_has_error(), 0) << mode;
+
+    styio_file_rewind(h);
+    double dv = 0.0;
+    styio_file_read_f64(h, &dv, &ok);
+    EXPECT_EQ(ok, 1) << mode;
+    EXPECT_DOUBLE_EQ(dv, 12.0) << mode;
+
+    /* Batches stop at the first bad line with the usual diagnostic. */
+    int64_t batch[4] = {};
+    EXPECT_EQ(styio_file_read_i64_batch(h, batch, 4), 2) << mode;
+    EXPECT_EQ(batch[0], -7) << mode;
+    EXPECT_EQ(batch[1], 3) << mode;
+    EXPECT_STREQ(styio_runtime_last_error_subcode(), "STYIO_RUNTIME_NUMERIC_PARSE") << mode;
+    styio_runtime_clear_error();
+    double fbatch[4] = {};
+    EXPECT_EQ(styio_file_read_f64_batch(h, fbatch, 4), 2) << mode;
+    EXPECT_DOUBLE_EQ(fbatch[0], 2.5) << mode;
+    EXPECT_DOUBLE_EQ(fbatch[1], 9223372036854775808.0) << mode;
+    /* Subnormal: from_chars may take it, but strtod underflows, so the fast path must not. */
+    EXPECT_STREQ(styio_runtime_last_error_subcode(), "STYIO_RUNTIME_NUMERIC_PARSE") << mode;
+    styio_runtime_clear_error();
+    EXPECT_EQ(styio_file_read_f64_batch(h, fbatch, 4), 0) << mode;
+    EXPECT_EQ(styio_runtime_has_error(), 0) << mode;
+    styio_file_close(h);
+  }
+
+  EXPECT_EQ(styio_runtime_set_file_source("auto"), 1);
+  std::remove(path.c_str());
+}
+
+TEST(StyioSafetyRuntime, CsvReaderProjectsTypedColumnsAcrossBatches) {
+  styio_runtime_clear_error();
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  const long long uniq = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+  const std::string path = "/tmp/styio_csv_reader_" + std::to_string(uniq) + ".csv";
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << "id,name,price,note\r\n";
+    for (int i = 0; i < 5000; ++i) {
+      out << i << ",\"item, " << i << "\"," << i << ".5,\"say \"\"hi\"\"\nthere\"\n";
+    }
+    out << "\n";
+  }
+
+  const int64_t h = styio_csv_open(path.c_str(), "f64:price\nstr:name\ni64:id\nstr:note");
+  ASSERT_NE(h, 0);
+  int64_t total = 0;
+  int64_t id_sum = 0;
+  double price_sum = 0.0;
+  while (const int64_t n = styio_csv_next_batch(h)) {
+    const double* price = styio_csv_column_f64(h, 0);
+    const char* const* name = styio_csv_column_cstr(h, 1);
+    const int64_t* id = styio_csv_column_i64(h, 2);
+    const char* const* note = styio_csv_column_cstr(h, 3);
+    for (int64_t i = 0; i < n; ++i) {
+      EXPECT_EQ(std::string(name[i]), "item, " + std::to_string(id[i]));
+      EXPECT_STREQ(note[i], "say \"hi\"\nthere");
+      id_sum += id[i];
+      price_sum += price[i];
+    }
+    total += n;
+  }
+  EXPECT_FALSE(styio_runtime_has_error());
+  EXPECT_EQ(total, 5000);
+  EXPECT_EQ(id_sum, 4999 * 5000 / 2);
+  EXPECT_DOUBLE_EQ(price_sum, 4999.0 * 5000.0 / 2.0 + 2500.0);
+  styio_csv_close(h);
+
+  EXPECT_EQ(styio_csv_open(path.c_str(), "f64:missing"), 0);
+  EXPECT_TRUE(styio_runtime_has_error());
+  EXPECT_STREQ(styio_runtime_last_error_subcode(), "STYIO_RUNTIME_CSV_COLUMN");
+  styio_runtime_clear_error();
+
+  const int64_t bad = styio_csv_open(path.c_str(), "i64:name");
+  ASSERT_NE(bad, 0);
+  EXPECT_EQ(styio_csv_next_batch(bad), 0);
+  EXPECT_STREQ(styio_runtime_last_error_subcode(), "STYIO_RUNTIME_NUMERIC_PARSE");
+  styio_csv_close(bad);
+  styio_runtime_clear_error();
+
+  /* A bad record cuts the batch short: earlier rows come back whole, then the error. */
+  for (const char* tail : {"c,x\nd,4\n", "c\nd,4\n"}) {
+    {
+      std::ofstream out(path, std::ios::binary | std::ios::trunc);
+      out << "name,id\na,1\nb,2\n" << tail;
+    }
+    const int64_t partial = styio_csv_open(path.c_str(), "str:name\ni64:id");
+    ASSERT_NE(partial, 0);
+    EXPECT_EQ(styio_csv_next_batch(partial), 2) << tail;
+    EXPECT_FALSE(styio_runtime_has_error()) << tail;
+    EXPECT_STREQ(styio_csv_column_cstr(partial, 0)[1], "b") << tail;
+    EXPECT_EQ(styio_csv_column_i64(partial, 1)[1], 2) << tail;
+    EXPECT_EQ(styio_csv_next_batch(partial), 0) << tail;
+    EXPECT_TRUE(styio_runtime_has_error()) << tail;
+    styio_csv_close(partial);
+    styio_runtime_clear_error();
+  }
+  std::remove(path.c_str());
+}
+
+TEST(StyioSafetyRuntime, ColumnarFileRoundTripsTypedColumnsAndAppends) {
+  styio_runtime_clear_error();
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  const long long uniq = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+  const std::string path = "/tmp/styio_columnar_" + std::to_string(uniq) + ".col";
+  const char* spec = "i64:id\nf64:price\nbool:ok\nstr:name";
+
+  for (int pass = 0; pass < 2; ++pass) {
+    const int64_t w = styio_col_acquire_write(path.c_str(), spec);
+    ASSERT_NE(w, 0);
+    EXPECT_EQ(styio_col_acquire_write(path.c_str(), spec), w);
+    for (int i = 0; i < 1000; ++i) {
+      const int row = pass * 1000 + i;
+      styio_col_write_i64(w, 0, row);
+      styio_col_write_f64(w, 1, row + 0.5);
+      styio_col_write_bool(w, 2, row % 2);
+      styio_col_write_cstr(w, 3, row % 7 == 0 ? "" : ("item " + std::to_string(row)).c_str());
+    }
+    /* The second pass reopens the file and appends to the rows already in it. */
+    styio_file_release_writes();
+    EXPECT_FALSE(styio_runtime_has_error());
+  }
+
+  const int64_t h = styio_col_open(path.c_str(), "str:name\ni64:id\nbool:ok\nf64:price");
+  ASSERT_NE(h, 0);
+  ASSERT_EQ(styio_col_rows(h), 2000);
+  const auto* offsets = static_cast<const uint64_t*>(styio_col_data(h, 0));
+  const char* blob = styio_col_strings(h, 0);
+  const auto* id = static_cast<const int64_t*>(styio_col_data(h, 1));
+  const auto* ok = static_cast<const uint8_t*>(styio_col_data(h, 2));
+  const auto* price = static_cast<const double*>(styio_col_data(h, 3));
+  for (int64_t r = 0; r < 2000; ++r) {
+    ASSERT_EQ(id[r], r);
+    EXPECT_DOUBLE_EQ(price[r], r + 0.5);
+    EXPECT_EQ(ok[r], r % 2);
+    EXPECT_EQ(std::string(blob + offsets[r]), r % 7 == 0 ? "" : "item " + std::to_string(r));
+  }
+  styio_col_close(h);
+
+  /* A lone parameter binds the only column of a single-column file. */
+  const std::string single = path + ".single";
+  const int64_t sw = styio_col_acquire_write(single.c_str(), "f64:value");
+  styio_col_write_f64(sw, 0, 2.5);
+  const int64_t sh = styio_col_open(single.c_str(), "f64:x");
+  ASSERT_NE(sh, 0);
+  EXPECT_EQ(styio_col_rows(sh), 1);
+  EXPECT_DOUBLE_EQ(*static_cast<const double*>(styio_col_data(sh, 0)), 2.5);
+  styio_col_close(sh);
+  EXPECT_FALSE(styio_runtime_has_error());
+
+  EXPECT_EQ(styio_col_open(path.c_str(), "f64:id"), 0);
+  EXPECT_STREQ(styio_runtime_last_error_subcode(), "STYIO_RUNTIME_COLUMNAR_SCHEMA");
+  styio_runtime_clear_error();
+  EXPECT_EQ(styio_col_acquire_write(path.c_str(), "i64:id"), 0);
+  EXPECT_STREQ(styio_runtime_last_error_subcode(), "STYIO_RUNTIME_COLUMNAR_SCHEMA");
+  styio_runtime_clear_error();
+
+  {
+    std::ofstream out(single, std::ios::binary | std::ios::trunc);
+    out << "1\n2\n3\n";
+  }
+  EXPECT_EQ(styio_col_open(single.c_str(), "i64:x"), 0);
+  EXPECT_STREQ(styio_runtime_last_error_subcode(), "STYIO_RUNTIME_COLUMNAR_FORMAT");
+  styio_runtime_clear_error();
+  std::remove(path.c_str());
+  std::remove(single.c_str());
+}
+
+#if defined(STYIO_HAVE_ZLIB)
+TEST(StyioSafetyRuntime, AutoOpenDecompressesGzipMembersInBlocks) {
+  styio_runtime_clear_error();
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  const long long uniq = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+  const std::string path = "/tmp/styio_gzip_" + std::to_string(uniq) + ".txt.gz";
+
+  /* Two members; the first is large enough (compressed) for the read-ahead worker. */
+  constexpr int kLines = 200000;
+  uint64_t x = 0x9E3779B97F4A7C15ull;
+  {
+    gzFile gz = gzopen(path.c_str(), "wb");
+    ASSERT_NE(gz, nullptr);
+    for (int i = 0; i < kLines; ++i) {
+      x ^= x << 13;
+      x ^= x >> 7;
+      x ^= x << 17;
+      const std::string line = std::to_string(i) + " " + std::to_string(x) + "\n";
+      gzwrite(gz, line.data(), static_cast<unsigned>(line.size()));
+    }
+    gzclose(gz);
+    gz = gzopen(path.c_str(), "ab");
+    ASSERT_NE(gz, nullptr);
+    gzputs(gz, "tail\n");
+    gzclose(gz);
+  }
+
+  const int64_t h = styio_file_open_auto(path.c_str());
+  ASSERT_NE(h, 0);
+  for (int pass = 0; pass < 2; ++pass) {
+    int lines = 0;
+    std::string last;
+    bool in_order = true;
+    while (const char* line = styio_file_read_line(h)) {
+      if (lines < kLines && std::strtoll(line, nullptr, 10) != lines) {
+        in_order = false;
+      }
+      last = line;
+      lines += 1;
+    }
+    EXPECT_TRUE(in_order);
+    EXPECT_EQ(lines, kLines + 1);
+    EXPECT_EQ(last, "tail");
+    styio_file_rewind(h);
+  }
+  EXPECT_FALSE(styio_runtime_has_error());
+  styio_file_close(h);
+
+  /* styio_file_open keeps handing out the raw bytes. */
+  const int64_t raw = styio_file_open(path.c_str());
+  ASSERT_NE(raw, 0);
+  const char* first = styio_file_read_line(raw);
+  ASSERT_NE(first, nullptr);
+  EXPECT_EQ(static_cast<unsigned char>(first[0]), 0x1f);
+  styio_file_close(raw);
+
+  /* A stream cut off mid-member is an error, not a short read. */
+  {
+    std::ifstream in(path, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), 4096);
+  }
+  const int64_t cut = styio_file_open_auto(path.c_str());
+  ASSERT_NE(cut, 0);
+  while (styio_file_read_line(cut) != nullptr) {
+  }
+  EXPECT_TRUE(styio_runtime_has_error());
+  EXPECT_STREQ(styio_runtime_last_error_subcode(), "STYIO_RUNTIME_FILE_CODEC");
+  styio_file_close(cut);
+  styio_runtime_clear_error();
+  std::remove(path.c_str());
+}
+#endif
+
+#if !defined(STYIO_HAVE_ZSTD)
+TEST(StyioSafetyRuntime, AutoOpenRejectsCodecMissingFromBuild) {
+  styio_runtime_clear_error();
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  const long long uniq = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+  const std::string path = "/tmp/styio_zstd_" + std::to_string(uniq) + ".txt.zst";
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << "\x28\xb5\x2f\xfd" << "not really a frame";
+  }
+  EXPECT_EQ(styio_file_open_auto(path.c_str()), 0);
+  EXPECT_STREQ(styio_runtime_last_error_subcode(), "STYIO_RUNTIME_FILE_CODEC");
+  styio_runtime_clear_error();
+  std::remove(path.c_str());
+}
+#endif
+
+TEST(StyioSafetyRuntime, ListSpansBorrowScalarStorageUntilEpochMoves) {
+  styio_runtime_clear_error();
+  const uint64_t* epoch = styio_list_epoch_word();
+  ASSERT_NE(epoch, nullptr);
+
+  const int64_t nums = styio_list_new_i64();
+  int64_t len = -1;
+  EXPECT_NE(styio_list_span_i64(nums, &len), nullptr);
+  EXPECT_EQ(len, 0);
+
+  uint64_t seen = *epoch;
+  styio_list_push_i64(nums, 4);
+  styio_list_push_i64(nums, 9);
+  EXPECT_NE(*epoch, seen);
+  const int64_t* data = styio_list_span_i64(nums, &len);
+  ASSERT_NE(data, nullptr);
+  ASSERT_EQ(len, 2);
+  EXPECT_EQ(data[0], 4);
+  EXPECT_EQ(data[1], 9);
+
+  /* In-place writes keep the span. */
+  seen = *epoch;
+  styio_list_set(nums, 1, 7);
+  EXPECT_EQ(*epoch, seen);
+  EXPECT_EQ(data[1], 7);
+
+  styio_list_insert_i64(nums, 0, 1);
+  EXPECT_NE(*epoch, seen);
+  seen = *epoch;
+  styio_list_pop(nums);
+  EXPECT_NE(*epoch, seen);
+
+  const int64_t flags = styio_list_new_bool();
+  styio_list_push_bool(flags, 1);
+  styio_list_push_bool(flags, 0);
+  const int64_t* bits = styio_list_span_bool(flags, &len);
+  ASSERT_NE(bits, nullptr);
+  ASSERT_EQ(len, 2);
+  EXPECT_EQ(bits[0], 1);
+  EXPECT_EQ(bits[1], 0);
+
+  const int64_t reals = styio_list_new_f64();
+  styio_list_push_f64(reals, 2.5);
+  const double* fp = styio_list_span_f64(reals, &len);
+  ASSERT_NE(fp, nullptr);
+  ASSERT_EQ(len, 1);
+  EXPECT_DOUBLE_EQ(fp[0], 2.5);
+
+  /* Wrong kind and dead handles yield no span and leave the error state alone. */
+  EXPECT_EQ(styio_list_span_f64(nums, &len), nullptr);
+  EXPECT_EQ(len, 0);
+  EXPECT_EQ(styio_list_span_i64(reals, &len), nullptr);
+  seen = *epoch;
+  styio_list_release(reals);
+  EXPECT_NE(*epoch, seen);
+  EXPECT_EQ(styio_list_span_f64(reals, &len), nullptr);
+  EXPECT_EQ(styio_runtime_has_error(), 0);
+
+  styio_list_release(flags);
+  styio_list_release(nums);
+  EXPECT_EQ(styio_list_active_count(), 0);
+}
+
+TEST(StyioSafetyRuntime, FlatHashDictBackendKeepsInsertionOrderAcrossGrowth) {
+  const std::string previous = styio_dict_runtime_get_impl_name();
+  ASSERT_STREQ(styio_dict_runtime_canonical_impl_name("swiss"), "flat-hash");
+  ASSERT_EQ(styio_dict_runtime_set_impl_by_name("flat-hash"), 1);
+  styio_runtime_clear_error();
+
+  const int64_t counts = styio_dict_new_i64();
+  for (int i = 0; i < 1000; ++i) {
+    const std::string key = "k" + std::to_string(i);
+    styio_dict_set_i64(counts, key.c_str(), i);
+  }
+  styio_dict_set_i64(counts, "k7", 70);
+  EXPECT_EQ(styio_dict_len(counts), 1000);
+  EXPECT_EQ(styio_dict_get_i64(counts, "k7"), 70);
+  EXPECT_EQ(styio_dict_get_i64(counts, "k999"), 999);
+
+  const int64_t keys = styio_dict_keys(counts);
+  ASSERT_EQ(styio_list_len(keys), 1000);
+  for (int64_t i : {0, 7, 999}) {
+    const char* key = styio_list_get_cstr(keys, i);
+    EXPECT_EQ(std::string(key), "k" + std::to_string(i));
+    styio_free_cstr(key);
+  }
+  styio_list_release(keys);
+
+  const int64_t copy = styio_dict_clone(counts);
+  styio_dict_set_i64(copy, "extra", 1);
+  EXPECT_EQ(styio_dict_get_i64(copy, "k500"), 500);
+  EXPECT_EQ(styio_dict_len(copy), 1001);
+  EXPECT_EQ(styio_dict_len(counts), 1000);
+  EXPECT_EQ(styio_runtime_has_error(), 0);
+
+  styio_dict_release(copy);
+  styio_dict_release(counts);
+  EXPECT_EQ(styio_dict_active_count(), 0);
+  ASSERT_EQ(styio_dict_runtime_set_impl_by_name(previous.c_str()), 1);
+}
+
+TEST(StyioSafetyRuntime, InternedKeyIdsMatchStringKeysOnEveryDictBackend) {
+  const std::string previous = styio_dict_runtime_get_impl_name();
+  const int64_t price = styio_key_intern("price");
+  EXPECT_GT(price, 0);
+  EXPECT_EQ(styio_key_intern("price"), price);
+  EXPECT_NE(styio_key_intern("qty"), price);
+
+  for (int i = 0; i < styio_dict_runtime_supported_impl_count(); ++i) {
+    ASSERT_EQ(styio_dict_runtime_set_impl_by_name(styio_dict_runtime_supported_impl_name(i)), 1);
+    styio_runtime_clear_error();
+    const int64_t d = styio_dict_new_f64();
+    styio_dict_set_f64_keyid(d, price, 2.5);
+    EXPECT_DOUBLE_EQ(styio_dict_get_f64(d, "price"), 2.5);
+    styio_dict_set_f64(d, "price", 4.0);
+    EXPECT_DOUBLE_EQ(styio_dict_get_f64_keyid(d, price), 4.0);
+    EXPECT_EQ(styio_dict_len(d), 1);
+
+    const int64_t names = styio_dict_new_cstr();
+    styio_dict_set_cstr_keyid(names, price, "cheap");
+    const char* text = styio_dict_get_cstr_keyid(names, price);
+    EXPECT_STREQ(text, "cheap");
+    styio_free_cstr(text);
+    EXPECT_EQ(styio_runtime_has_error(), 0);
+
+    EXPECT_DOUBLE_EQ(styio_dict_get_f64_keyid(d, styio_key_intern("qty")), 0.0);
+    EXPECT_STREQ(styio_runtime_last_error_subcode(), "STYIO_RUNTIME_DICT_KEY");
+    styio_runtime_clear_error();
+    styio_dict_set_f64_keyid(d, 1 << 30, 1.0);
+    EXPECT_STREQ(styio_runtime_last_error_subcode(), "STYIO_RUNTIME_DICT_KEY");
+    EXPECT_EQ(styio_dict_len(d), 1);
+    styio_runtime_clear_error();
+
+    styio_dict_release(names);
+    styio_dict_release(d);
+  }
+  EXPECT_EQ(styio_dict_active_count(), 0);
+  ASSERT_EQ(styio_dict_runtime_set_impl_by_name(previous.c_str()), 1);
+}
+
+TEST(StyioSafetyRuntime, IntKeyedDictsKeepIntegerKeysOnEveryDictBackend) {
+  const std::string previous = styio_dict_runtime_get_impl_name();
+  for (int i = 0; i < styio_dict_runtime_supported_impl_count(); ++i) {
+    ASSERT_EQ(styio_dict_runtime_set_impl_by_name(styio_dict_runtime_supported_impl_name(i)), 1);
+    styio_runtime_clear_error();
+    const int64_t d = styio_idict_new_i64();
+    for (int64_t k = 0; k < 1000; ++k) {
+      styio_idict_set_i64(d, k * 7 - 500, k);
+    }
+    styio_idict_set_i64(d, -500, 42);
+    EXPECT_EQ(styio_dict_len(d), 1000);
+    EXPECT_EQ(styio_idict_get_i64(d, -500), 42);
+    EXPECT_EQ(styio_idict_get_i64(d, 999 * 7 - 500), 999);
+
+    const int64_t keys = styio_dict_keys(d);
+    ASSERT_EQ(styio_list_len(keys), 1000);
+    EXPECT_EQ(styio_list_get(keys, 0), -500);
+    EXPECT_EQ(styio_list_get(keys, 999), 999 * 7 - 500);
+    styio_list_release(keys);
+
+    const int64_t copy = styio_dict_clone(d);
+    EXPECT_EQ(styio_idict_get_i64(copy, 4), 72);
+    EXPECT_EQ(styio_runtime_has_error(), 0);
+
+    const int64_t names = styio_idict_new_cstr();
+    styio_idict_set_cstr(names, 2, "b");
+    styio_idict_set_cstr(names, 1, "a");
+    const char* text = styio_dict_to_cstr(names);
+    EXPECT_STREQ(text, "{2:\"b\",1:\"a\"}");
+    styio_free_cstr(text);
+
+    EXPECT_EQ(styio_idict_get_i64(d, 3), 0);
+    EXPECT_STREQ(styio_runtime_last_error_subcode(), "STYIO_RUNTIME_DICT_KEY");
+    styio_runtime_clear_error();
+    EXPECT_EQ(styio_dict_get_i64(d, "3"), 0);
+    EXPECT_STREQ(styio_runtime_last_error_subcode(), "STYIO_RUNTIME_INVALID_DICT_HANDLE");
+    styio_runtime_clear_error();
+
+    styio_dict_release(names);
+    styio_dict_release(copy);
+    styio_dict_release(d);
+  }
+  EXPECT_EQ(styio_dict_active_count(), 0);
+  ASSERT_EQ(styio_dict_runtime_set_impl_by_name(previous.c_str()), 1);
+}
+
 TEST(StyioSafetyRuntime, NullReadPathSetsStableSubcode) {
   styio_runtime_clear_error();
   const int64_t h = styio_file_open(nullptr);
@@ -2549,3 +3437,41 @@ TEST(StyioSafetyHandleTable, ReleaseAllSkipsKindMismatchesAndDropsStubs) {
   table.invalidate(resource_id);
   EXPECT_EQ(table.size(), 0U);
 }
+
+TEST(StyioSafetyHandleTable, ReusedSlotRejectsStaleHandle) {
+  StyioHandleTable table;
+  int first = 1;
+  int second = 2;
+
+  const auto old_id = table.acquire(StyioHandleTable::HandleKind::List, &first);
+  ASSERT_EQ(old_id, 1);
+  ASSERT_TRUE(table.release(old_id, StyioHandleTable::HandleKind::List));
+
+  /* The freed slot is reused under a new generation; the old id must not reach it. */
+  const auto new_id = table.acquire(StyioHandleTable::HandleKind::List, &second);
+  ASSERT_NE(new_id, 0);
+  EXPECT_NE(new_id, old_id);
+  EXPECT_EQ(new_id & 0xffffffff, old_id & 0xffffffff);
+  EXPECT_EQ(table.lookup(old_id), nullptr);
+  EXPECT_EQ(table.lookup_entry(old_id), nullptr);
+  EXPECT_FALSE(table.contains(old_id));
+  EXPECT_FALSE(table.release(old_id));
+  EXPECT_EQ(table.lookup_as<int>(new_id, StyioHandleTable::HandleKind::List), &second);
+
+  /* Ids that never came from this table: 0, negatives, and slots past the end. */
+  EXPECT_EQ(table.lookup(0), nullptr);
+  EXPECT_EQ(table.lookup(-1), nullptr);
+  EXPECT_EQ(table.lookup(new_id + 1), nullptr);
+  EXPECT_EQ(table.size(), 1U);
+
+  /* Closers may release other handles while release_all is walking the slab. */
+  int third = 3;
+  const auto other_id = table.acquire(StyioHandleTable::HandleKind::List, &third);
+  size_t closed = 0;
+  table.release_all(StyioHandleTable::HandleKind::List, [&](void*) {
+    closed += 1;
+    table.release(other_id);
+  });
+  EXPECT_EQ(closed, 1U);
+  EXPECT_EQ(table.size(), 0U);
+}
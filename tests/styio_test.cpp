@@ -459,9 +459,27 @@ TEST(StyioDiagnostics, MachineInfoJsonReportsStableHandshakeFields) {
   EXPECT_NE(result.stdout_text.find("\"jsonl_diagnostics\""), std::string::npos);
   EXPECT_NE(result.stdout_text.find("\"nano_package_registry_publish_v1\""), std::string::npos);
   EXPECT_NE(result.stdout_text.find("\"dict_impl\":{\"selected\":\"ordered-hash\""), std::string::npos);
+  EXPECT_NE(result.stdout_text.find("\"jit_target\":{\"triple\":\""), std::string::npos);
+  EXPECT_NE(result.stdout_text.find("\"source\":\"host\"}"), std::string::npos);
   EXPECT_NE(result.stdout_text.find("\"edition_max\":\"2026\""), std::string::npos);
 }
 
+TEST(StyioDiagnostics, MachineInfoJsonReflectsCliTargetCpuAndFeatures) {
+  const char* runner = std::getenv("STYIO_COMPILER_EXE");
+  if (runner == nullptr || runner[0] == '\0') {
+    runner = STYIO_COMPILER_EXE;
+  }
+  ASSERT_TRUE(runner != nullptr && runner[0] != '\0');
+
+  const std::string cmd =
+    std::string("\"") + runner + "\" --machine-info=json --target-cpu=generic --target-features=-avx512f";
+  const CommandResult result = run_stdout_command(cmd);
+  ASSERT_EQ(result.exit_code, 0) << result.stdout_text;
+  EXPECT_NE(result.stdout_text.find("\"cpu\":\"generic\""), std::string::npos) << result.stdout_text;
+  EXPECT_NE(result.stdout_text.find("\"features\":\"-avx512f\""), std::string::npos) << result.stdout_text;
+  EXPECT_NE(result.stdout_text.find("\"source\":\"cli\"}"), std::string::npos) << result.stdout_text;
+}
+
 TEST(StyioDiagnostics, MachineInfoJsonReflectsCliDictImplSelection) {
   const char* runner = std::getenv("STYIO_COMPILER_EXE");
   if (runner == nullptr || runner[0] == '\0') {
@@ -477,6 +495,21 @@ TEST(StyioDiagnostics, MachineInfoJsonReflectsCliDictImplSelection) {
   EXPECT_NE(result.stdout_text.find("\"source\":\"cli\""), std::string::npos);
 }
 
+TEST(StyioDiagnostics, MachineInfoJsonListsFlatHashDictImpl) {
+  const char* runner = std::getenv("STYIO_COMPILER_EXE");
+  if (runner == nullptr || runner[0] == '\0') {
+    runner = STYIO_COMPILER_EXE;
+  }
+  ASSERT_TRUE(runner != nullptr && runner[0] != '\0');
+
+  const std::string cmd =
+    std::string("\"") + runner + "\" --machine-info=json --dict-impl=v3";
+  const CommandResult result = run_stdout_command(cmd);
+  ASSERT_EQ(result.exit_code, 0) << result.stdout_text;
+  EXPECT_NE(result.stdout_text.find("\"dict_impl\":{\"selected\":\"flat-hash\""), std::string::npos);
+  EXPECT_NE(result.stdout_text.find("\"flat-hash\""), std::string::npos);
+}
+
 TEST(StyioDiagnostics, MachineInfoJsonReflectsCliDictImplAliasSelection) {
   const char* runner = std::getenv("STYIO_COMPILER_EXE");
   if (runner == nullptr || runner[0] == '\0') {
@@ -499,6 +532,395 @@ TEST(StyioTypes, F32BuiltinMappingUsesF32InternalName) {
   EXPECT_EQ(f32.num_of_bit, static_cast<size_t>(32));
 }
 
+TEST(StyioDiagnostics, OptLevelOptimizesBeforeExecutionAndRejectsUnknownLevels) {
+  const char* runner = std::getenv("STYIO_COMPILER_EXE");
+  if (runner == nullptr || runner[0] == '\0') {
+    runner = STYIO_COMPILER_EXE;
+  }
+  ASSERT_TRUE(runner != nullptr && runner[0] != '\0');
+
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  const long long uniq = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+  const fs::path input =
+    fs::temp_directory_path() / ("styio-opt-level-" + std::to_string(uniq) + ".styio");
+  {
+    std::ofstream out(input);
+    ASSERT_TRUE(out.is_open());
+    out << ">_(3+7)\n";
+  }
+
+  for (const char* level : {"0", "1", "2", "3", "O2"}) {
+    const CommandResult result = run_stdout_command(
+      std::string("\"") + runner + "\" --opt-level=" + level + " --file \"" + input.string() + "\" 2>&1");
+    EXPECT_EQ(result.exit_code, 0) << level << ": " << result.stdout_text;
+    EXPECT_EQ(trim_copy_latest(result.stdout_text), "10") << level;
+  }
+
+  const CommandResult optimized_ir = run_stdout_command(
+    std::string("\"") + runner + "\" --opt-level=2 --llvm-ir --file \"" + input.string() + "\" 2>&1");
+  EXPECT_EQ(optimized_ir.exit_code, 0) << optimized_ir.stdout_text;
+  EXPECT_NE(optimized_ir.stdout_text.find("define"), std::string::npos) << optimized_ir.stdout_text;
+  EXPECT_NE(optimized_ir.stdout_text.find("10"), std::string::npos) << optimized_ir.stdout_text;
+
+  const CommandResult rejected = run_stdout_command(
+    std::string("\"") + runner + "\" --opt-level=7 --file \"" + input.string() + "\" 2>&1");
+  EXPECT_EQ(rejected.exit_code, 6);
+  EXPECT_NE(rejected.stdout_text.find("unsupported --opt-level: 7"), std::string::npos);
+
+  fs::remove(input);
+}
+
+TEST(StyioDiagnostics, LazyJitModeRunsCalledFunctionsAndRejectsUnknownModes) {
+  const char* runner = std::getenv("STYIO_COMPILER_EXE");
+  if (runner == nullptr || runner[0] == '\0') {
+    runner = STYIO_COMPILER_EXE;
+  }
+  ASSERT_TRUE(runner != nullptr && runner[0] != '\0');
+
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  const long long uniq = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+  const fs::path input =
+    fs::temp_directory_path() / ("styio-jit-lazy-" + std::to_string(uniq) + ".styio");
+  {
+    std::ofstream out(input);
+    ASSERT_TRUE(out.is_open());
+    out << "# add1 := (x: i64) => x + 1\n";
+    out << "# twice := (x: i64) => x * 2\n";
+    out << ">_(add1(9))\n";
+  }
+
+  for (const char* level : {"0", "2"}) {
+    const CommandResult result = run_stdout_command(
+      std::string("\"") + runner + "\" --jit-mode=lazy --opt-level=" + level
+      + " --file \"" + input.string() + "\" 2>&1");
+    EXPECT_EQ(result.exit_code, 0) << level << ": " << result.stdout_text;
+    EXPECT_EQ(trim_copy_latest(result.stdout_text), "10") << level;
+  }
+
+  const CommandResult rejected = run_stdout_command(
+    std::string("\"") + runner + "\" --jit-mode=fast --file \"" + input.string() + "\" 2>&1");
+  EXPECT_EQ(rejected.exit_code, 6);
+  EXPECT_NE(rejected.stdout_text.find("unsupported --jit-mode: fast"), std::string::npos);
+
+  fs::remove(input);
+}
+
+TEST(StyioDiagnostics, JitObjectCacheWarmRunReusesCachedObject) {
+  const char* runner = std::getenv("STYIO_COMPILER_EXE");
+  if (runner == nullptr || runner[0] == '\0') {
+    runner = STYIO_COMPILER_EXE;
+  }
+  ASSERT_TRUE(runner != nullptr && runner[0] != '\0');
+
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  const long long uniq = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+  const fs::path root = fs::temp_directory_path() / ("styio-jit-cache-" + std::to_string(uniq));
+  const fs::path cache_dir = root / "cache";
+  const fs::path input = root / "main.styio";
+  ASSERT_TRUE(fs::create_directories(root));
+  {
+    std::ofstream out(input);
+    ASSERT_TRUE(out.is_open());
+    out << ">_(3+7)\n";
+  }
+
+  const std::string cmd = std::string("\"") + runner + "\" --jit-cache-dir \"" + cache_dir.string()
+                          + "\" --file \"" + input.string() + "\" 2>&1";
+  const CommandResult cold = run_stdout_command(cmd);
+  ASSERT_EQ(cold.exit_code, 0) << cold.stdout_text;
+  EXPECT_EQ(trim_copy_latest(cold.stdout_text), "10");
+
+  size_t cached_objects = 0;
+  for (const auto& entry : fs::directory_iterator(cache_dir)) {
+    if (entry.path().extension() == ".o") {
+      ++cached_objects;
+    }
+  }
+  EXPECT_EQ(cached_objects, static_cast<size_t>(1));
+
+  const CommandResult warm = run_stdout_command(cmd);
+  ASSERT_EQ(warm.exit_code, 0) << warm.stdout_text;
+  EXPECT_EQ(trim_copy_latest(warm.stdout_text), "10");
+
+  const CommandResult other_level = run_stdout_command(
+    std::string("\"") + runner + "\" --opt-level=2 --jit-cache-dir \"" + cache_dir.string()
+    + "\" --file \"" + input.string() + "\" 2>&1");
+  ASSERT_EQ(other_level.exit_code, 0) << other_level.stdout_text;
+  cached_objects = 0;
+  for (const auto& entry : fs::directory_iterator(cache_dir)) {
+    if (entry.path().extension() == ".o") {
+      ++cached_objects;
+    }
+  }
+  EXPECT_EQ(cached_objects, static_cast<size_t>(2));
+
+  fs::remove_all(root);
+}
+
+TEST(StyioDiagnostics, JitThreadsSplitsProgramIntoCachedPartsWithSameOutput) {
+  const char* runner = std::getenv("STYIO_COMPILER_EXE");
+  if (runner == nullptr || runner[0] == '\0') {
+    runner = STYIO_COMPILER_EXE;
+  }
+  ASSERT_TRUE(runner != nullptr && runner[0] != '\0');
+
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  const long long uniq = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+  const fs::path root = fs::temp_directory_path() / ("styio-jit-threads-" + std::to_string(uniq));
+  const fs::path cache_dir = root / "cache";
+  const fs::path input = root / "main.styio";
+  ASSERT_TRUE(fs::create_directories(root));
+  {
+    std::ofstream out(input);
+    ASSERT_TRUE(out.is_open());
+    out << "# add1 := (x: i64) => x + 1\n";
+    out << "# twice := (x: i64) => x * 2\n";
+    out << "# square := (x: i64) => x * x\n";
+    out << ">_(add1(9))\n";
+    out << ">_(twice(add1(4)))\n";
+    out << ">_(square(twice(2)))\n";
+  }
+
+  const std::string cmd = std::string("\"") + runner + "\" --jit-threads=4 --jit-cache-dir \""
+                          + cache_dir.string() + "\" --file \"" + input.string() + "\" 2>&1";
+  const CommandResult cold = run_stdout_command(cmd);
+  ASSERT_EQ(cold.exit_code, 0) << cold.stdout_text;
+  EXPECT_EQ(trim_copy_latest(cold.stdout_text), "10\n10\n16");
+
+  size_t cached_parts = 0;
+  for (const auto& entry : fs::directory_iterator(cache_dir)) {
+    if (entry.path().extension() == ".o") {
+      EXPECT_NE(entry.path().filename().string().find(".styio_part"), std::string::npos) << entry.path();
+      ++cached_parts;
+    }
+  }
+  EXPECT_GE(cached_parts, static_cast<size_t>(1));
+
+  const CommandResult warm = run_stdout_command(cmd);
+  ASSERT_EQ(warm.exit_code, 0) << warm.stdout_text;
+  EXPECT_EQ(trim_copy_latest(warm.stdout_text), "10\n10\n16");
+
+  const CommandResult all_cores = run_stdout_command(
+    std::string("\"") + runner + "\" --jit-threads=0 --opt-level=2 --no-jit-cache --file \""
+    + input.string() + "\" 2>&1");
+  ASSERT_EQ(all_cores.exit_code, 0) << all_cores.stdout_text;
+  EXPECT_EQ(trim_copy_latest(all_cores.stdout_text), "10\n10\n16");
+
+  const CommandResult rejected = run_stdout_command(
+    std::string("\"") + runner + "\" --jit-threads=-2 --file \"" + input.string() + "\" 2>&1");
+  EXPECT_EQ(rejected.exit_code, 6);
+  EXPECT_NE(rejected.stdout_text.find("unsupported --jit-threads: -2"), std::string::npos);
+
+  fs::remove_all(root);
+}
+
+TEST(StyioDiagnostics, TimeReportWritesPhasePassAndJitRecordsAsJsonl) {
+  const char* runner = std::getenv("STYIO_COMPILER_EXE");
+  if (runner == nullptr || runner[0] == '\0') {
+    runner = STYIO_COMPILER_EXE;
+  }
+  ASSERT_TRUE(runner != nullptr && runner[0] != '\0');
+
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  const long long uniq = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+  const fs::path root = fs::temp_directory_path() / ("styio-time-report-" + std::to_string(uniq));
+  const fs::path input = root / "main.styio";
+  ASSERT_TRUE(fs::create_directories(root));
+  {
+    std::ofstream out(input);
+    ASSERT_TRUE(out.is_open());
+    out << "# add := (a: i64, b: i64) => a + b\n";
+    out << ">_(add(3, 4))\n";
+  }
+
+  const CommandResult result = run_stdout_command(
+    std::string("\"") + runner + "\" --time-report --opt-level=2 --no-jit-cache --file \""
+    + input.string() + "\" 2>&1");
+  ASSERT_EQ(result.exit_code, 0) << result.stdout_text;
+
+  std::istringstream lines(result.stdout_text);
+  std::string line;
+  std::vector<std::string> phase_operations;
+  bool saw_pass = false;
+  bool saw_jit = false;
+  bool saw_program_output = false;
+  while (std::getline(lines, line)) {
+    if (line == "7") {
+      saw_program_output = true;
+      continue;
+    }
+    ASSERT_EQ(line.rfind("{\"severity\":\"info\",\"category\":\"TimeReport\"", 0), 0u) << line;
+    EXPECT_NE(line.find("\"wall_us\":"), std::string::npos) << line;
+    if (line.find("\"kind\":\"phase\"") != std::string::npos) {
+      EXPECT_NE(line.find("\"cpu_us\":"), std::string::npos) << line;
+      EXPECT_NE(line.find("\"ast_arena_bytes\":"), std::string::npos) << line;
+      const std::string key = "\"operation\":\"";
+      const size_t start = line.find(key) + key.size();
+      phase_operations.push_back(line.substr(start, line.find('"', start) - start));
+    }
+    saw_pass = saw_pass || line.find("\"kind\":\"llvm_pass\"") != std::string::npos;
+    saw_jit = saw_jit || line.find("\"kind\":\"jit_materialize\"") != std::string::npos;
+  }
+  EXPECT_TRUE(saw_program_output) << result.stdout_text;
+  EXPECT_EQ(
+    phase_operations,
+    (std::vector<std::string>{
+      "adopt_tokens", "attach_ast", "mark_type_checked", "attach_ir", "mark_codegen_ready", "mark_executed"}));
+  EXPECT_TRUE(saw_pass) << result.stdout_text;
+  EXPECT_TRUE(saw_jit) << result.stdout_text;
+
+  fs::remove_all(root);
+}
+
+TEST(StyioDiagnostics, OutputFlushPolicyKeepsOutputAndOrderingBeforeRuntimeError) {
+  const char* runner = std::getenv("STYIO_COMPILER_EXE");
+  if (runner == nullptr || runner[0] == '\0') {
+    runner = STYIO_COMPILER_EXE;
+  }
+  ASSERT_TRUE(runner != nullptr && runner[0] != '\0');
+
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  const long long uniq = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+  const fs::path project_dir = fs::temp_directory_path() / ("styio-output-flush-" + std::to_string(uniq));
+  const fs::path input = project_dir / "main.styio";
+  const fs::path failing = project_dir / "fail.styio";
+  const fs::path config = project_dir / "styio.toml";
+  ASSERT_TRUE(fs::create_directories(project_dir));
+  {
+    std::ofstream out(input);
+    ASSERT_TRUE(out.is_open());
+    out << ">_(1)\n>_(2)\n>_(3)\n";
+  }
+  {
+    std::ofstream out(failing);
+    ASSERT_TRUE(out.is_open());
+    out << ">_(\"before\")\n";
+    out << "f <- @file{\"" << (project_dir / "missing.txt").string() << "\"}\n";
+  }
+
+  const std::string base_cmd =
+    std::string("cd \"") + project_dir.string() + "\" && \"" + runner + "\"";
+  for (const char* policy : {"line", "block:16", "interval:1000", "exit"}) {
+    const CommandResult result = run_stdout_command(
+      base_cmd + " --output-flush=" + policy + " --file \"" + input.filename().string() + "\"");
+    ASSERT_EQ(result.exit_code, 0) << policy << ": " << result.stdout_text;
+    EXPECT_EQ(trim_copy_latest(result.stdout_text), "1\n2\n3") << policy;
+  }
+
+  /* Buffered output is flushed before the driver reports the runtime error. */
+  const CommandResult failed = run_stdout_command(
+    base_cmd + " --output-flush=exit --error-format=jsonl --file \"" + failing.filename().string() + "\" 2>&1");
+  EXPECT_EQ(failed.exit_code, 5) << failed.stdout_text;
+  const size_t before_pos = failed.stdout_text.find("before");
+  const size_t error_pos = failed.stdout_text.find("\"category\":\"RuntimeError\"");
+  ASSERT_NE(before_pos, std::string::npos) << failed.stdout_text;
+  ASSERT_NE(error_pos, std::string::npos) << failed.stdout_text;
+  EXPECT_LT(before_pos, error_pos);
+
+  const CommandResult bad_cli = run_stdout_command(
+    base_cmd + " --output-flush=block:0 --file \"" + input.filename().string() + "\" 2>&1");
+  EXPECT_EQ(bad_cli.exit_code, 6) << bad_cli.stdout_text;
+  EXPECT_NE(bad_cli.stdout_text.find("unsupported --output-flush: block:0"), std::string::npos);
+
+  {
+    std::ofstream out(config);
+    ASSERT_TRUE(out.is_open());
+    out << "[runtime]\n";
+    out << "output_flush = \"block:4096\"\n";
+  }
+  const CommandResult from_config =
+    run_stdout_command(base_cmd + " --file \"" + input.filename().string() + "\"");
+  ASSERT_EQ(from_config.exit_code, 0) << from_config.stdout_text;
+  EXPECT_EQ(trim_copy_latest(from_config.stdout_text), "1\n2\n3");
+
+  {
+    std::ofstream out(config);
+    ASSERT_TRUE(out.is_open());
+    out << "[runtime]\n";
+    out << "output_flush = \"sometimes\"\n";
+  }
+  const CommandResult bad_config = run_stdout_command(
+    base_cmd + " --file \"" + input.filename().string() + "\" 2>&1");
+  EXPECT_EQ(bad_config.exit_code, 6) << bad_config.stdout_text;
+  EXPECT_NE(bad_config.stdout_text.find("unsupported output_flush in config file"), std::string::npos);
+  const CommandResult cli_wins = run_stdout_command(
+    base_cmd + " --output-flush=line --file \"" + input.filename().string() + "\"");
+  EXPECT_EQ(cli_wins.exit_code, 0) << cli_wins.stdout_text;
+
+  fs::remove_all(project_dir);
+}
+
+TEST(StyioDiagnostics, IntervalOutputFlushesBeforeBlockingStdinRead) {
+#ifdef _WIN32
+  GTEST_SKIP() << "needs a fifo for stdin";
+#else
+  const char* runner = std::getenv("STYIO_COMPILER_EXE");
+  if (runner == nullptr || runner[0] == '\0') {
+    runner = STYIO_COMPILER_EXE;
+  }
+  ASSERT_TRUE(runner != nullptr && runner[0] != '\0');
+
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  const long long uniq = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+  const fs::path project_dir = fs::temp_directory_path() / ("styio-flush-stdin-" + std::to_string(uniq));
+  ASSERT_TRUE(fs::create_directories(project_dir));
+  {
+    std::ofstream out(project_dir / "main.styio");
+    ASSERT_TRUE(out.is_open());
+    out << ">_(\"first\")\n";
+    out << "@stdin >> #(line) => {\n  line -> @stdout\n}\n";
+  }
+
+  /* stdin stays open (fd 3 holds the fifo) while the script polls out.txt; the line has
+     to reach the reader before input closes, well inside the 60s interval. */
+  const CommandResult result = run_stdout_command(
+    std::string("cd \"") + project_dir.string() + "\" && mkfifo in.fifo"
+    + " && { \"" + runner + "\" --output-flush=interval:60000 --file main.styio < in.fifo > out.txt & }"
+    + " && exec 3> in.fifo"
+    + " && i=0; while [ $i -lt 100 ] && ! grep -q first out.txt 2>/dev/null; do sleep 0.1; i=$((i+1)); done;"
+    + " cat out.txt; echo '--- stdin closed'; exec 3>&-; wait");
+  EXPECT_EQ(result.exit_code, 0) << result.stdout_text;
+  EXPECT_EQ(result.stdout_text.rfind("first\n--- stdin closed", 0), 0u) << result.stdout_text;
+
+  fs::remove_all(project_dir);
+#endif
+}
+
+TEST(StyioDiagnostics, EmitExeBuildsStandaloneExecutableWithoutRunning) {
+  const char* runner = std::getenv("STYIO_COMPILER_EXE");
+  if (runner == nullptr || runner[0] == '\0') {
+    runner = STYIO_COMPILER_EXE;
+  }
+  ASSERT_TRUE(runner != nullptr && runner[0] != '\0');
+
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  const long long uniq = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+  const fs::path root = fs::temp_directory_path() / ("styio-emit-exe-" + std::to_string(uniq));
+  const fs::path input = root / "main.styio";
+  const fs::path object = root / "main.o";
+  const fs::path exe = root / "main";
+  ASSERT_TRUE(fs::create_directories(root));
+  {
+    std::ofstream out(input);
+    ASSERT_TRUE(out.is_open());
+    out << ">_(3+7)\n";
+  }
+
+  const CommandResult compile = run_stdout_command(
+    std::string("\"") + runner + "\" --opt-level=2 --emit-obj \"" + object.string() + "\" --emit-exe \""
+    + exe.string() + "\" --file \"" + input.string() + "\" 2>&1");
+  ASSERT_EQ(compile.exit_code, 0) << compile.stdout_text;
+  EXPECT_EQ(compile.stdout_text.find("10"), std::string::npos) << "AOT compile must not run the program";
+  ASSERT_TRUE(fs::exists(object));
+  ASSERT_TRUE(fs::exists(exe));
+
+  const CommandResult run = run_stdout_command(std::string("\"") + exe.string() + "\" 2>&1");
+  EXPECT_EQ(run.exit_code, 0) << run.stdout_text;
+  EXPECT_EQ(trim_copy_latest(run.stdout_text), "10");
+
+  fs::remove_all(root);
+}
+
 TEST(StyioDiagnostics, CompilePlanBuildWritesArtifactsWithoutExecutingEntry) {
   const auto now = std::chrono::system_clock::now().time_since_epoch();
   const long long uniq = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
@@ -3846,6 +4268,43 @@ TEST(StyioDiagnostics, InvalidNumericStdinArgumentEmitsJsonlRuntimeDiagnostic) {
   fs::remove(input);
 }
 
+TEST(StyioDiagnostics, OptimizedNumericParsingMatchesRuntimeAcrossFastAndSlowPaths) {
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  const long long uniq = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+  const fs::path input =
+    fs::temp_directory_path() / ("styio-inline-numeric-parse-" + std::to_string(uniq) + ".styio");
+
+  {
+    std::ofstream out(input);
+    ASSERT_TRUE(out.is_open());
+    out << "# add1 := (x: i64) => x + 1\n";
+    out << "@stdin >> #(line) => {\n";
+    out << "  >_(add1(line))\n";
+    out << "}\n";
+  }
+
+  const char* runner = std::getenv("STYIO_COMPILER_EXE");
+  if (runner == nullptr || runner[0] == '\0') {
+    runner = STYIO_COMPILER_EXE;
+  }
+  ASSERT_TRUE(runner != nullptr && runner[0] != '\0');
+
+  /* Short decimals take the inlined fast path; signs, wide values and junk take strtoll. */
+  const CommandResult parsed = run_stdout_command(
+    std::string("printf '41\\n-8\\n007\\n+5\\n9000000000000000000\\n' | \"") + runner
+    + "\" --opt-level=2 --file \"" + input.string() + "\" 2>&1");
+  EXPECT_EQ(parsed.exit_code, 0) << parsed.stdout_text;
+  EXPECT_EQ(trim_copy_latest(parsed.stdout_text), "42\n-7\n8\n6\n9000000000000000001");
+
+  const CommandResult overflow = run_stdout_command(
+    std::string("printf '99999999999999999999\\n' | \"") + runner
+    + "\" --opt-level=2 --error-format=jsonl --file \"" + input.string() + "\" 2>&1");
+  EXPECT_EQ(overflow.exit_code, 5) << overflow.stdout_text;
+  EXPECT_NE(overflow.stdout_text.find("\"subcode\":\"STYIO_RUNTIME_NUMERIC_PARSE\""), std::string::npos);
+
+  fs::remove(input);
+}
+
 TEST(StyioDiagnostics, CompoundAssignOnImmutableBindingReportsTypeError) {
   const auto now = std::chrono::system_clock::now().time_since_epoch();
   const long long uniq = std::chrono::duration_cast<std::chrono::microseconds>(now).count();